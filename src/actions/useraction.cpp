@@ -152,6 +152,8 @@ UserActionManager::setSubtitle(Subtitle *subtitle)
 	if(m_subtitle) {
 		disconnect(m_subtitle, SIGNAL(linesRemoved(int, int)), this, SLOT(onSubtitleLinesChanged()));
 		disconnect(m_subtitle, SIGNAL(linesInserted(int, int)), this, SLOT(onSubtitleLinesChanged()));
+		disconnect(m_subtitle, SIGNAL(lineRangesRemoved(const RangeList &)), this, SLOT(onSubtitleLinesChanged()));
+		disconnect(m_subtitle, SIGNAL(lineRangesInserted(const RangeList &)), this, SLOT(onSubtitleLinesChanged()));
 
 		disconnect(m_subtitle, SIGNAL(primaryDirtyStateChanged(bool)), this, SLOT(onPrimaryDirtyStateChanged(bool)));
 		disconnect(m_subtitle, SIGNAL(secondaryDirtyStateChanged(bool)), this, SLOT(onSecondaryDirtyStateChanged(bool)));
@@ -166,6 +168,8 @@ UserActionManager::setSubtitle(Subtitle *subtitle)
 	if(m_subtitle) {
 		connect(m_subtitle, SIGNAL(linesRemoved(int, int)), this, SLOT(onSubtitleLinesChanged()));
 		connect(m_subtitle, SIGNAL(linesInserted(int, int)), this, SLOT(onSubtitleLinesChanged()));
+		connect(m_subtitle, SIGNAL(lineRangesRemoved(const RangeList &)), this, SLOT(onSubtitleLinesChanged()));
+		connect(m_subtitle, SIGNAL(lineRangesInserted(const RangeList &)), this, SLOT(onSubtitleLinesChanged()));
 
 		connect(m_subtitle, SIGNAL(primaryDirtyStateChanged(bool)), this, SLOT(onPrimaryDirtyStateChanged(bool)));
 		connect(m_subtitle, SIGNAL(secondaryDirtyStateChanged(bool)), this, SLOT(onSecondaryDirtyStateChanged(bool)));
@@ -111,6 +111,7 @@
 #define ACT_ANCHOR_TOGGLE "anchor_toggle"
 #define ACT_ANCHOR_REMOVE_ALL "anchor_remove_all"
 #define ACT_SCRIPTS_MANAGER "scripts_manager"
+#define ACT_MEMORY_USAGE "memory_usage"
 #define ACT_WAVEFORM_ZOOM_IN "waveform_zoom_in"
 #define ACT_WAVEFORM_ZOOM_OUT "waveform_zoom_out"
 #define ACT_WAVEFORM_AUTOSCROLL "waveform_autoscroll"
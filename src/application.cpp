@@ -24,7 +24,7 @@
 #include "actions/kcodecactionext.h"
 #include "actions/krecentfilesactionext.h"
 #include "configs/configdialog.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 #include "currentlinewidget.h"
 #include "dialogs/joinsubtitlesdialog.h"
 #include "dialogs/splitsubtitledialog.h"
@@ -55,7 +55,8 @@
 #include "lineswidget.h"
 #include "mainwindow.h"
 #include "playerwidget.h"
-#include "profiler.h"
+#include "helpers/memoryusage.h"
+#include "helpers/profiler.h"
 #include "scripting/scriptsmanager.h"
 #include "speechprocessor/speechprocessor.h"
 #include "utils/finder.h"
@@ -236,6 +237,11 @@ Application::init()
 
 	m_scriptsManager->reloadScripts();
 
+	MemoryUsage::addReporter(this, [this](MemoryUsage::Report &report){
+		if(m_subtitle)
+			m_subtitle->reportMemoryUsage(report);
+	});
+
 	loadConfig();
 }
 
@@ -247,6 +253,8 @@ Application::~Application()
 
 	// delete m_mainWindow; the window is destroyed when it's closed
 
+	MemoryUsage::removeReporters(this);
+
 	delete m_subtitle;
 }
 
@@ -1175,6 +1183,12 @@ Application::setupActions()
 	actionCollection->addAction(ACT_SCRIPTS_MANAGER, scriptsManagerAction);
 	actionManager->addAction(scriptsManagerAction, UserAction::FullScreenOff);
 
+	QAction *memoryUsageAction = new QAction(actionCollection);
+	memoryUsageAction->setText(i18nc("@action:inmenu", "Memory Usage..."));
+	memoryUsageAction->setStatusTip(i18n("Show memory used by subtitles, undo history and media caches"));
+	connect(memoryUsageAction, SIGNAL(triggered()), this, SLOT(showMemoryUsage()));
+	actionCollection->addAction(ACT_MEMORY_USAGE, memoryUsageAction);
+
 	QAction *waveformZoomInAction = new QAction(actionCollection);
 	waveformZoomInAction->setIcon(QIcon::fromTheme("zoom-in"));
 	waveformZoomInAction->setText(i18n("Waveform Zoom In"));
@@ -1458,6 +1472,8 @@ Application::checqCriticals()
 {
 	static ChecqCriticalsDialog *dlg = new ChecqCriticalsDialog(m_mainWindow);
 
+	dlg->setErrorCounts(m_subtitle);
+
 	if(dlg->exec() == QDialog::Accepted) {
 		SubtitleCompositeActionExecutor executor(*m_subtitle, i18n("Check Lines Errors"));
 
@@ -1585,11 +1601,11 @@ void
 Application::changeSelectedLinesColor()
 {
 	const RangeList range = m_linesWidget->selectionRanges();
-	SubtitleIterator it(*m_subtitle, range);
-	if(!it.current())
+	const SubtitleLinesView lines(*m_subtitle, range);
+	if(lines.isEmpty())
 		return;
 
-	QColor color = SubtitleColorDialog::getColor(QColor(it.current()->primaryText().styleColorAt(0)), m_mainWindow);
+	QColor color = SubtitleColorDialog::getColor(QColor(lines.first()->primaryText().styleColorAt(0)), m_mainWindow);
 	if(color.isValid())
 		m_subtitle->changeTextColor(range, color.rgba());
 }
@@ -1823,8 +1839,8 @@ Application::applyTranslation(RangeList ranges, bool primary, int inputLanguage,
 
 	QString inputText;
 	QRegExp dialogCueRegExp2("-([^-])");
-	for(SubtitleIterator it(*m_subtitle, ranges); it.current(); ++it) {
-		QString lineText = it.current()->primaryText().richString();
+	for(const SubtitleLine *line : SubtitleLinesView(*m_subtitle, ranges)) {
+		QString lineText = line->primaryText().richString();
 		lineText.replace('\n', ' ').replace("--", "---").replace(dialogCueRegExp2, "- \\1");
 		inputText += lineText + "\n()() ";
 	}
@@ -1855,14 +1871,14 @@ Application::applyTranslation(RangeList ranges, bool primary, int inputLanguage,
 		int index = -1;
 		QRegExp ellipsisRegExp("\\s+\\.\\.\\.");
 		QRegExp dialogCueRegExp("(^| )- ");
-		for(SubtitleIterator it(*m_subtitle, ranges); it.current(); ++it) {
+		for(SubtitleLine *subtitleLine : SubtitleLinesView(*m_subtitle, ranges)) {
 			QString line = outputLines.at(++index);
 			line.replace(" ---", "--");
 			line.replace(ellipsisRegExp, "...");
 			line.replace(dialogCueRegExp, "\n-");
 			SString text;
 			text.setRichString(line);
-			it.current()->setPrimaryText(text.trimmed());
+			subtitleLine->setPrimaryText(text.trimmed());
 		}
 	} else {
 		KMessageBox::sorry(m_mainWindow, i18n("There was an error performing the translation:\n\n%1", errorMessage));
@@ -1900,6 +1916,13 @@ Application::openVideo(const QUrl &url)
 	m_player->openFile(url.toLocalFile());
 }
 
+void
+Application::showMemoryUsage()
+{
+	const QString report = MemoryUsage::reportText(MemoryUsage::report());
+	KMessageBox::information(m_mainWindow, QStringLiteral("<pre>") + report.toHtmlEscaped() + QStringLiteral("</pre>"), i18n("Memory Usage"));
+}
+
 void
 Application::openVideo()
 {
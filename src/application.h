@@ -189,6 +189,8 @@ public slots:
 	void fixPunctuation();
 	void translate();
 
+	void showMemoryUsage();
+
 	void openVideo();
 	void openVideo(const QUrl &url);
 
@@ -146,6 +146,7 @@ Application::newSubtitle()
 		return;
 
 	m_subtitle = new Subtitle();
+	m_subtitle->setUndoStack(m_undoStack);
 	m_subtitleUrl.clear();
 
 	processSubtitleOpened(nullptr, QString());
@@ -177,6 +178,7 @@ Application::openSubtitle(const QUrl &url, bool warnClashingUrls)
 	QTextCodec *codec = codecForEncoding(KRecentFilesActionExt::encodingForUrl(url));
 
 	m_subtitle = new Subtitle();
+	m_subtitle->setUndoStack(m_undoStack);
 	FormatManager::Status res = FormatManager::instance().readSubtitle(*m_subtitle, true, url, &codec, &m_subtitleFormat);
 	if(res == FormatManager::SUCCESS) {
 		m_subtitleUrl = url;
@@ -226,7 +228,7 @@ Application::reopenSubtitleWithCodec(QTextCodec *codec)
 	Subtitle *subtitle = new Subtitle();
 	QString subtitleFormat;
 
-	FormatManager::Status res = FormatManager::instance().readSubtitle(*subtitle, true, m_subtitleUrl, &codec, &subtitleFormat);
+	FormatManager::Status res = FormatManager::instance().readSubtitle(*subtitle, true, m_subtitleUrl, &codec, &subtitleFormat, m_subtitleFormat);
 	if(res != FormatManager::SUCCESS) {
 		if(res == FormatManager::ERROR) {
 			KMessageBox::sorry(
@@ -245,6 +247,7 @@ Application::reopenSubtitleWithCodec(QTextCodec *codec)
 
 	delete m_subtitle;
 	m_subtitle = subtitle;
+	m_subtitle->setUndoStack(m_undoStack);
 
 	processSubtitleOpened(codec, subtitleFormat);
 }
@@ -474,7 +477,7 @@ Application::openSubtitleTr(const QUrl &url, bool warnClashingUrls)
 	}
 
 	m_subtitleTrUrl = url;
-	m_subtitle->setSecondaryData(subtitleTr, false);
+	m_subtitle->takeSecondaryData(subtitleTr, false);
 	processTranslationOpened(codec, m_subtitleTrFormat);
 }
 
@@ -487,7 +490,7 @@ Application::reopenSubtitleTrWithCodec(QTextCodec *codec)
 	Subtitle subtitleTr;
 	QString subtitleTrFormat;
 
-	FormatManager::Status res = FormatManager::instance().readSubtitle(subtitleTr, false, m_subtitleTrUrl, &codec, &subtitleTrFormat);
+	FormatManager::Status res = FormatManager::instance().readSubtitle(subtitleTr, false, m_subtitleTrUrl, &codec, &subtitleTrFormat, m_subtitleTrFormat);
 	if(res != FormatManager::SUCCESS) {
 		if(res == FormatManager::ERROR) {
 			KMessageBox::sorry(
@@ -498,7 +501,7 @@ Application::reopenSubtitleTrWithCodec(QTextCodec *codec)
 		return;
 	}
 
-	m_subtitle->setSecondaryData(subtitleTr, false);
+	m_subtitle->takeSecondaryData(subtitleTr, false);
 	processTranslationOpened(codec, m_subtitleTrFormat);
 }
 
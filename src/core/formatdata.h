@@ -66,6 +66,15 @@ public:
 		m_data.clear();
 	}
 
+	/// approximate bytes held, with the map nodes
+	inline qint64 memoryUsage() const
+	{
+		qint64 bytes = sizeof(*this) + m_formatName.capacity() * sizeof(QChar);
+		for(QMap<QString, QString>::ConstIterator it = m_data.begin(), end = m_data.end(); it != end; ++it)
+			bytes += 3 * sizeof(void *) + 2 * sizeof(QString) + (it.key().capacity() + it.value().capacity()) * sizeof(QChar);
+		return bytes;
+	}
+
 private:
 	FormatData(const QString &formatName) : m_formatName(formatName) {}
 
@@ -23,17 +23,17 @@
 
 #include "core/range.h"
 
-#include <QList>
+#include <QVector>
 #include <QStringList>
 
-#include <QDebug>
+#include <algorithm>
 
 namespace SubtitleComposer {
 class RangeList
 {
 public:
-	typedef QList<Range>::Iterator Iterator;
-	typedef QList<Range>::ConstIterator ConstIterator;
+	typedef QVector<Range>::Iterator Iterator;
+	typedef QVector<Range>::ConstIterator ConstIterator;
 
 	RangeList() {}
 
@@ -71,39 +71,77 @@ public:
 
 	RangeList complement() const
 	{
-		qDebug() << this->inspect();
-
 		if(m_ranges.empty())
 			return Range(0, Range::MaxIndex);
 
 		RangeList ret;
+		ret.m_ranges.reserve(m_ranges.count() + 1);
 
-		QList<Range>::ConstIterator it = m_ranges.begin();
+		ConstIterator it = m_ranges.constBegin();
 
 		if((*it).m_start > 0)
-			ret << Range(0, (*it).m_start - 1);
+			ret.m_ranges.append(Range(0, (*it).m_start - 1));
 
 		int lastEnd = (*it).m_end;
 		++it;
-		for(QList<Range>::ConstIterator end = m_ranges.end(); it != end; ++it) {
-			ret << Range(lastEnd + 1, (*it).m_start - 1);
+		for(ConstIterator end = m_ranges.constEnd(); it != end; ++it) {
+			ret.m_ranges.append(Range(lastEnd + 1, (*it).m_start - 1));
 			lastEnd = (*it).m_end;
 		}
 		if(lastEnd < Range::MaxIndex)
-			ret << Range(lastEnd + 1, Range::MaxIndex);
+			ret.m_ranges.append(Range(lastEnd + 1, Range::MaxIndex));
+
+		return ret;
+	}
 
-		qDebug() << ret.inspect();
+	RangeList united(const RangeList &ranges) const
+	{
+		RangeList ret;
+		ret.m_ranges.reserve(m_ranges.count() + ranges.m_ranges.count());
+
+		// merge both sorted lists, joining overlapping and adjacent ranges
+		ConstIterator it = m_ranges.constBegin(), end = m_ranges.constEnd();
+		ConstIterator it2 = ranges.m_ranges.constBegin(), end2 = ranges.m_ranges.constEnd();
+		while(it != end || it2 != end2) {
+			const Range &range = it2 == end2 || (it != end && (*it).m_start < (*it2).m_start) ? *it++ : *it2++;
+			if(!ret.m_ranges.empty() && ret.m_ranges.last().m_end >= range.m_start - 1) {
+				Range &lastRange = ret.m_ranges.last();
+				if(lastRange.m_end < range.m_end)
+					lastRange.m_end = range.m_end;
+			} else {
+				ret.m_ranges.append(range);
+			}
+		}
 
 		return ret;
 	}
 
-	bool contains(int index) const
+	RangeList intersected(const RangeList &ranges) const
 	{
-		for(QList<Range>::ConstIterator it = m_ranges.begin(), end2 = m_ranges.end(); it != end2; ++it)
-			if((*it).contains(index))
-				return true;
+		RangeList ret;
 
-		return false;
+		ConstIterator it = m_ranges.constBegin(), end = m_ranges.constEnd();
+		ConstIterator it2 = ranges.m_ranges.constBegin(), end2 = ranges.m_ranges.constEnd();
+		while(it != end && it2 != end2) {
+			const int start = qMax((*it).m_start, (*it2).m_start);
+			const int stop = qMin((*it).m_end, (*it2).m_end);
+			if(start <= stop)
+				ret.m_ranges.append(Range(start, stop));
+			if((*it).m_end < (*it2).m_end)
+				++it;
+			else
+				++it2;
+		}
+
+		return ret;
+	}
+
+	bool contains(int index) const
+	{
+		// last range starting at or before index
+		ConstIterator it = std::upper_bound(m_ranges.constBegin(), m_ranges.constEnd(), index,
+			[](int i, const Range &range){ return i < range.m_start; });
+		return it != m_ranges.constBegin() && (*--it).m_end >= index;
 	}
 
 	Range range(int rangeIndex) const
@@ -128,7 +166,7 @@ public:
 	{
 		int count = m_ranges.count();
 
-		for(QList<Range>::ConstIterator it = m_ranges.begin(), end2 = m_ranges.end(); it != end2; ++it)
+		for(ConstIterator it = m_ranges.constBegin(), end2 = m_ranges.constEnd(); it != end2; ++it)
 			count += (*it).m_end - (*it).m_start;
 
 		return count;
@@ -174,162 +212,54 @@ public:
 
 	void trimToRange(const Range &range)
 	{
-		if(m_ranges.empty())
-			return;
+		// ranges in [lower, upper) intersect the range
+		const int lower = std::lower_bound(m_ranges.constBegin(), m_ranges.constEnd(), range.m_start,
+			[](const Range &r, int index){ return r.m_end < index; }) - m_ranges.constBegin();
+		const int upper = std::upper_bound(m_ranges.constBegin() + lower, m_ranges.constEnd(), range.m_end,
+			[](int index, const Range &r){ return index < r.m_start; }) - m_ranges.constBegin();
 
-		// GENERAL ALGORITHM FOLLOWS
-		// - we search the lower and the upper items affected.
-		//   - update lower item start and end values
-		//   - remove all items below lower up and above upper (lower and upper excluded)
-
-		//       0         1         2
-		//     XXXXX     XXXXX     XXXXX           [L, U]
-		//  [    ]                                 [0, 0]
-		//  []                                     [0, 4]
-		//  [         ]                            [0, 0]
-		//  [            ]                         [0, 1]
-		//      [               ]                  [0, 1]
-		//           []                            [1, 3]
-		//           [     ]                       [1, 1]
-		//                [     ]                  [1, 1]
-		//  [                              ]       [0, 2]
-		//                            [    ]       [2, 2]
-		//                                 [  ]    [3, 2]
-		//  [                         ]            [0, 2]
-
-		const int SIZE = m_ranges.count();
-		const int LAST_INDEX = SIZE - 1;
-
-		int lowerIndex = SIZE;
-		int upperIndex = LAST_INDEX;
-
-		for(int index = 0; index <= LAST_INDEX; ++index) {
-			Range &currentRange = m_ranges[index];
-
-			if(lowerIndex == SIZE) {
-				if(range.m_start <= currentRange.m_end) {
-					lowerIndex = index;
-					if(range.m_end < currentRange.m_start) {
-						// special case, we must remove all items
-						upperIndex = LAST_INDEX + 1;
-						break;
-					}
-				}
-			} else {
-				if(range.m_end < currentRange.m_start) {
-					upperIndex = index - 1;
-					break;
-				}
-			}
-		}
-
-		if(lowerIndex > LAST_INDEX || upperIndex > LAST_INDEX) {
+		if(lower == upper) {
 			m_ranges.clear();
-		} else {
-			Range &lowerRange = m_ranges[lowerIndex];
-			Range &upperRange = m_ranges[upperIndex];
-
-			if(range.m_start > lowerRange.m_start)
-				lowerRange.m_start = range.m_start;
-			if(range.m_end < upperRange.m_end)
-				upperRange.m_end = range.m_end;
-
-			// remove all items after upperRange
-			for(int index = upperIndex + 1; index < SIZE; ++index)
-				m_ranges.removeAt(upperIndex + 1);
-
-			// remove all items before lowerRange
-			for(int index = 0; index < lowerIndex; ++index)
-				m_ranges.removeAt(0);
+			return;
 		}
+
+		m_ranges.remove(upper, m_ranges.count() - upper);
+		m_ranges.remove(0, lower);
+
+		Range &lowerRange = m_ranges.first();
+		if(range.m_start > lowerRange.m_start)
+			lowerRange.m_start = range.m_start;
+		Range &upperRange = m_ranges.last();
+		if(range.m_end < upperRange.m_end)
+			upperRange.m_end = range.m_end;
 	}
 
 	void operator<<(const Range &range)
 	{
-		// first resolve the most common (and easy) cases
-		if(m_ranges.empty()) {
+		// first resolve the most common case of ranges added in order
+		if(m_ranges.empty() || m_ranges.last().m_end < range.m_start - 1) {
 			m_ranges.append(range);
 			return;
-		} else {
-			Range &lastRange = m_ranges.last();
-			if(lastRange.m_end < range.m_start) {           // range is higher than lastRange
-				if(lastRange.m_end + 1 == range.m_start) // range is absorbed by lastRange
-					lastRange.m_end = range.m_end;
-				else
-					m_ranges.append(range);
-				return;
-			} else {
-				Range &firstRange = m_ranges.first();
-				if(firstRange.m_start > range.m_end) {          // range is lower than firstRange
-					if(range.m_end + 1 == firstRange.m_start) // range is absorbed by firstRange
-						firstRange.m_start = range.m_start;
-					else
-						m_ranges.append(range);
-					return;
-				}
-			}
 		}
 
-		// GENERAL ALGORITHM FOLLOWS
-		// - we search the lower and the upper items affected.
-		//   - update lower item start and end values
-		//   - remove all items following lower up to upper (lower excluded)
-
-		//       0         1         2
-		//     XXXXX     XXXXX     XXXXX           [L, U]
-		//  [    ]                                 [0, 0]
-		//  [         ]                            [0, 0]
-		//  [            ]                         [0, 1]
-		//  [                   ]                  [0, 1]
-		//          [ ]                            [0, 0]
-		//          [      ]                       [0, 1]
-		//  [                              ]       [0, 2]
-		//                            [    ]       [2, 2]
-		//                                  [ ]    [2, 2] this case isn't correctly handled below but was caught before
-		//           []                            [1, 3]
-
-		const int LAST_INDEX = m_ranges.count() - 1;
-
-		int lowerIndex = LAST_INDEX;
-		int upperIndex = LAST_INDEX;
-
-		for(int index = 0; index < LAST_INDEX; ++index) {
-			Range &currentRange = m_ranges[index];
-
-			if(lowerIndex == LAST_INDEX) {
-				if(range.m_start <= currentRange.m_end + 1) {
-					lowerIndex = index;
-					if(range.m_end < currentRange.m_start - 1) {
-						// special case, we must insert a new Range at lowerIndex
-						upperIndex = LAST_INDEX + 1;
-						break;
-					}
-				}
-			} else {
-				if(range.m_end < currentRange.m_start - 1) {
-					upperIndex = index - 1;
-					break;
-				}
-			}
+		// ranges in [lower, upper) overlap or touch the new range and are merged with it
+		const int lower = std::lower_bound(m_ranges.constBegin(), m_ranges.constEnd(), range.m_start,
+			[](const Range &r, int index){ return r.m_end < index - 1; }) - m_ranges.constBegin();
+		const int upper = std::upper_bound(m_ranges.constBegin() + lower, m_ranges.constEnd(), range.m_end,
+			[](int index, const Range &r){ return index < r.m_start - 1; }) - m_ranges.constBegin();
+
+		if(lower == upper) {
+			m_ranges.insert(lower, range);
+			return;
 		}
 
-		if(upperIndex > LAST_INDEX) {
-			// insert new range at lowerIndex
-			m_ranges.insert(m_ranges.begin() + lowerIndex, range);
-		} else {
-			Range &lowerRange = m_ranges[lowerIndex];
-			Range &upperRange = m_ranges[upperIndex];
-
-			if(range.m_start < lowerRange.m_start)
-				lowerRange.m_start = range.m_start;
-			if(range.m_end > upperRange.m_end)
-				lowerRange.m_end = range.m_end;
-			else
-				lowerRange.m_end = upperRange.m_end;
+		const int upperEnd = m_ranges.at(upper - 1).m_end;
+		Range &lowerRange = m_ranges[lower];
+		if(range.m_start < lowerRange.m_start)
+			lowerRange.m_start = range.m_start;
+		lowerRange.m_end = qMax(range.m_end, upperEnd);
 
-			for(int index = lowerIndex + 1; index <= upperIndex; ++index)
-				m_ranges.removeAt(lowerIndex + 1);
-		}
+		m_ranges.remove(lower + 1, upper - lower - 1);
 	}
 
 	void shiftIndexesForwards(int fromIndex, int delta, bool fillSplitGap)
@@ -350,6 +280,9 @@ public:
 					range.m_start = fromIndex;
 					shiftRangeForwards(range, fromIndex, delta);
 					m_ranges.insert(m_ranges.begin() + index, range0);
+					// skip the already shifted second half
+					index++;
+					count++;
 				}
 			} else
 				shiftRangeForwards(range, fromIndex, delta);
@@ -364,13 +297,14 @@ public:
 		if(!delta || m_ranges.isEmpty())
 			return;
 
+		// drop ranges invalidated by the shift while compacting in place
+		int newCount = 0;
 		for(int index = 0, count = m_ranges.count(); index < count; ++index) {
-			if(!shiftRangeBackwards(m_ranges[index], fromIndex, delta)) {           // range invalidated by shift
-				m_ranges.removeAt(index);
-				index--;
-				count--;
-			}
+			Range range = m_ranges.at(index);
+			if(shiftRangeBackwards(range, fromIndex, delta))
+				m_ranges[newCount++] = range;
 		}
+		m_ranges.remove(newCount, m_ranges.count() - newCount);
 	}
 
 	QString inspect() const
@@ -435,7 +369,7 @@ private:
 		return true;
 	}
 
-	QList<Range> m_ranges;
+	QVector<Range> m_ranges;
 };
 }
 
@@ -27,6 +27,10 @@
 #include <QDebug>
 
 #include <QColor>
+#include <QAtomicInt>
+
+#include <algorithm>
+#include <new>
 
 #if (QT_VERSION < QT_VERSION_CHECK(5, 7, 0))
 	#define qAsConst
@@ -34,42 +38,147 @@
 
 using namespace SubtitleComposer;
 
-void *
-memset_n(void *ptr, int value, size_t length, size_t size)
+// style of the characters from start up to the start of the next run
+struct SString::StyleRun {
+	int start;
+	QRgb color;
+	char flags;
+
+	inline bool sameStyle(int styleFlags, QRgb styleColor) const { return flags == char(styleFlags) && color == styleColor; }
+};
+
+// reference counted run storage shared between SString copies, laid out as
+// StyleData header followed by capacity runs sorted by start
+struct SString::StyleData {
+	QAtomicInt ref;
+	int size;
+	int capacity;
+
+	inline StyleRun * runs() { return reinterpret_cast<StyleRun *>(this + 1); }
+	inline const StyleRun * runs() const { return reinterpret_cast<const StyleRun *>(this + 1); }
+
+	// index of the run containing character at index
+	inline int runAt(int index) const {
+		return std::upper_bound(runs(), runs() + size, index, [](int i, const StyleRun &run){ return i < run.start; }) - runs() - 1;
+	}
+};
+
+// appends runs to a new StyleData, merging neighbours with the same style
+class SString::StyleBuilder
+{
+public:
+	explicit StyleBuilder(int capacity) : m_style(allocStyle(qMax(capacity, 1))), m_length(0) {}
+	~StyleBuilder() { releaseStyle(m_style); }
+
+	void fill(int len, int styleFlags, QRgb styleColor);
+	void fillFrom(const StyleData *src, int index, int len);
+	void append(const StyleData *src, int index, int len);
+	void truncate(int len);
+	StyleData * take();
+
+private:
+	StyleData *m_style;
+	int m_length;
+};
+
+void
+SString::StyleBuilder::fill(int len, int styleFlags, QRgb styleColor)
 {
-	unsigned char *data = (unsigned char *)ptr;
-	while(length > 0) {
-		memcpy(data, &value, size);
-		data += size;
-		length--;
+	if(len <= 0)
+		return;
+
+	if(m_style->size && m_style->runs()[m_style->size - 1].sameStyle(styleFlags, styleColor)) {
+		m_length += len;
+		return;
+	}
+
+	if(m_style->size == m_style->capacity) {
+		StyleData *style = allocStyle(m_style->capacity * 2);
+		memcpy(style->runs(), m_style->runs(), m_style->size * sizeof(StyleRun));
+		style->size = m_style->size;
+		releaseStyle(m_style);
+		m_style = style;
 	}
-	return ptr;
+
+	StyleRun &run = m_style->runs()[m_style->size++];
+	run.start = m_length;
+	run.flags = styleFlags;
+	run.color = styleColor;
+	m_length += len;
+}
+
+void
+SString::StyleBuilder::fillFrom(const StyleData *src, int index, int len)
+{
+	if(!src) {
+		fill(len, 0, 0);
+		return;
+	}
+	const StyleRun &run = src->runs()[src->runAt(index)];
+	fill(len, run.flags, run.color);
+}
+
+void
+SString::StyleBuilder::append(const StyleData *src, int index, int len)
+{
+	if(len <= 0)
+		return;
+	if(!src) {
+		fill(len, 0, 0);
+		return;
+	}
+
+	const StyleRun *runs = src->runs();
+	const int end = index + len;
+	for(int i = src->runAt(index); index < end; i++) {
+		const int runEnd = i + 1 < src->size ? qMin(runs[i + 1].start, end) : end;
+		fill(runEnd - index, runs[i].flags, runs[i].color);
+		index = runEnd;
+	}
+}
+
+void
+SString::StyleBuilder::truncate(int len)
+{
+	while(m_style->size && m_style->runs()[m_style->size - 1].start >= len)
+		m_style->size--;
+	m_length = len;
+}
+
+SString::StyleData *
+SString::StyleBuilder::take()
+{
+	if(!m_length)
+		return nullptr;
+	StyleData *style = m_style;
+	m_style = nullptr;
+	return style;
 }
 
 SString::SString(const QString &string, int styleFlags /* = 0*/, QRgb styleColor /* = 0*/) :
 	QString(string),
-	m_styleFlags(NULL),
-	m_styleColors(NULL),
-	m_capacity(0)
+	m_style(nullptr)
 {
 	if(QString::length()) {
-		setMinFlagsCapacity(length());
-		memset(m_styleFlags, styleFlags & AllStyles, length() * sizeof(*m_styleFlags));
-		memset_n(m_styleColors, styleColor, length(), sizeof(*m_styleColors));
+		StyleBuilder builder(1);
+		builder.fill(length(), styleFlags & AllStyles, styleColor);
+		m_style = builder.take();
 	}
 }
 
 SString::SString(const SString &sstring) :
 	QString(sstring),
-	m_styleFlags(NULL),
-	m_styleColors(NULL),
-	m_capacity(0)
+	m_style(sstring.m_style)
 {
-	if(length()) {
-		setMinFlagsCapacity(length());
-		memcpy(m_styleFlags, sstring.m_styleFlags, length() * sizeof(*m_styleFlags));
-		memcpy(m_styleColors, sstring.m_styleColors, length() * sizeof(*m_styleColors));
-	}
+	if(m_style)
+		m_style->ref.ref();
+}
+
+SString::SString(SString &&sstring) noexcept :
+	QString(std::move(sstring)),
+	m_style(sstring.m_style)
+{
+	sstring.m_style = nullptr;
 }
 
 SString &
@@ -79,31 +188,36 @@ SString::operator=(const SString &sstring)
 		return *this;
 
 	QString::operator=(sstring);
-	setMinFlagsCapacity(length());
 
-	if(length()) {
-		memcpy(m_styleFlags, sstring.m_styleFlags, length() * sizeof(*m_styleFlags));
-		memcpy(m_styleColors, sstring.m_styleColors, length() * sizeof(*m_styleColors));
-	}
+	if(sstring.m_style)
+		sstring.m_style->ref.ref();
+	setStyle(sstring.m_style);
+
+	return *this;
+}
+
+SString &
+SString::operator=(SString &&sstring) noexcept
+{
+	// QString move assignment swaps, so swap the styles to keep both objects consistent
+	QString::operator=(std::move(sstring));
+	qSwap(m_style, sstring.m_style);
 
 	return *this;
 }
 
 SString::~SString()
 {
-	delete[] m_styleFlags;
-	delete[] m_styleColors;
+	releaseStyle(m_style);
 }
 
 void
 SString::setString(const QString &string, int styleFlags /* = 0*/, QRgb styleColor /* = 0*/)
 {
 	QString::operator=(string);
-	setMinFlagsCapacity(length());
-	if(length()) {
-		memset(m_styleFlags, styleFlags & AllStyles, length() * sizeof(*m_styleFlags));
-		memset_n(m_styleColors, styleColor, length(), sizeof(*m_styleColors));
-	}
+	StyleBuilder builder(1);
+	builder.fill(length(), styleFlags & AllStyles, styleColor);
+	setStyle(builder.take());
 }
 
 QString
@@ -114,9 +228,14 @@ SString::richString(RichOutputMode mode) const
 
 	QString ret;
 
+	const StyleRun noStyle = { 0, 0, 0 };
+	const StyleRun *runs = m_style ? m_style->runs() : &noStyle;
+	const int runCount = m_style ? m_style->size : 1;
+	const int size = length();
+
 	if(mode == Compact) {
-		char prevStyleFlags = m_styleFlags[0];
-		QRgb prevStyleColor = m_styleColors[0];
+		char prevStyleFlags = runs[0].flags;
+		QRgb prevStyleColor = runs[0].color;
 		int prevIndex = 0;
 
 		if(prevStyleFlags & Italic)
@@ -130,50 +249,64 @@ SString::richString(RichOutputMode mode) const
 		if(prevStyleFlags & Color)
 			ret += "<font color=" + QColor(prevStyleColor).name() + ">";
 
-		const int size = length();
 		QChar ch;
-		for(int index = 1; index < size; ++index) {
-			if(m_styleFlags[index] != prevStyleFlags || ((prevStyleFlags & m_styleFlags[index] & Color) && m_styleColors[index] != prevStyleColor)) {
-				QString token(QString::mid(prevIndex, index - prevIndex));
-				ret += token.replace('<', "&lt;").replace('>', "&gt;");
-
-				if((prevStyleFlags & StrikeThrough) && !(m_styleFlags[index] & StrikeThrough))
-					ret += "</s>";
-				if((prevStyleFlags & Underline) && !(m_styleFlags[index] & Underline))
-					ret += "</u>";
-				if((prevStyleFlags & Bold) && !(m_styleFlags[index] & Bold))
-					ret += "</b>";
-				if((prevStyleFlags & Italic) && !(m_styleFlags[index] & Italic))
-					ret += "</i>";
-				if((prevStyleFlags & Color) && (!(m_styleFlags[index] & Color) || prevStyleColor != m_styleColors[index]))
-					ret += "</font>";
+		for(int run = 1; run < runCount && runs[run].start < size; run++) {
+			int index = runs[run].start;
+			char styleFlags = runs[run].flags;
+			QRgb styleColor = runs[run].color;
+			if(styleFlags == prevStyleFlags && (!(prevStyleFlags & styleFlags & Color) || styleColor == prevStyleColor))
+				continue;
+
+			QString token(QString::mid(prevIndex, index - prevIndex));
+			ret += token.replace('<', "&lt;").replace('>', "&gt;");
 
-				while(index < size) {
-					// place opening html tags after spaces/newlines
-					ch = at(index);
-					if(ch != '\n' && ch != '\r' && ch != ' ' && ch != '\t')
-						break;
-					ret += ch;
-					index++;
-				}
+			if((prevStyleFlags & StrikeThrough) && !(styleFlags & StrikeThrough))
+				ret += "</s>";
+			if((prevStyleFlags & Underline) && !(styleFlags & Underline))
+				ret += "</u>";
+			if((prevStyleFlags & Bold) && !(styleFlags & Bold))
+				ret += "</b>";
+			if((prevStyleFlags & Italic) && !(styleFlags & Italic))
+				ret += "</i>";
+			if((prevStyleFlags & Color) && (!(styleFlags & Color) || prevStyleColor != styleColor))
+				ret += "</font>";
 
-				if(!(prevStyleFlags & Italic) && (m_styleFlags[index] & Italic))
-					ret += "<i>";
-				if(!(prevStyleFlags & Bold) && (m_styleFlags[index] & Bold))
-					ret += "<b>";
-				if(!(prevStyleFlags & Underline) && (m_styleFlags[index] & Underline))
-					ret += "<u>";
-				if(!(prevStyleFlags & StrikeThrough) && (m_styleFlags[index] & StrikeThrough))
-					ret += "<s>";
-				if((m_styleFlags[index] & Color) && (!(prevStyleFlags & Color) || prevStyleColor != m_styleColors[index]))
-					ret += "<font color=" + QColor(m_styleColors[index]).name() + ">";
+			while(index < size) {
+				// place opening html tags after spaces/newlines
+				ch = at(index);
+				if(ch != '\n' && ch != '\r' && ch != ' ' && ch != '\t')
+					break;
+				ret += ch;
+				index++;
+			}
 
-				prevIndex = index;
-				prevStyleFlags = m_styleFlags[index];
-				prevStyleColor = m_styleColors[index];
+			// skipped spaces may have moved us into following runs
+			while(run + 1 < runCount && runs[run + 1].start <= index)
+				run++;
+			if(index < size) {
+				styleFlags = runs[run].flags;
+				styleColor = runs[run].color;
+			} else {
+				styleFlags = 0;
+				styleColor = 0;
 			}
+
+			if(!(prevStyleFlags & Italic) && (styleFlags & Italic))
+				ret += "<i>";
+			if(!(prevStyleFlags & Bold) && (styleFlags & Bold))
+				ret += "<b>";
+			if(!(prevStyleFlags & Underline) && (styleFlags & Underline))
+				ret += "<u>";
+			if(!(prevStyleFlags & StrikeThrough) && (styleFlags & StrikeThrough))
+				ret += "<s>";
+			if((styleFlags & Color) && (!(prevStyleFlags & Color) || prevStyleColor != styleColor))
+				ret += "<font color=" + QColor(styleColor).name() + ">";
+
+			prevIndex = index;
+			prevStyleFlags = styleFlags;
+			prevStyleColor = styleColor;
 		}
-		QString token(QString::mid(prevIndex, length() - prevIndex));
+		QString token(QString::mid(prevIndex, size - prevIndex));
 		if(token.length()) {
 			ret += token.replace('<', "&lt;").replace('>', "&gt;");
 
@@ -189,11 +322,12 @@ SString::richString(RichOutputMode mode) const
 				ret += "</font>";
 		}
 	} else { // outputMode == Verbose
-		int currentStyleFlags = m_styleFlags[0];
-		QRgb currentColor = m_styleColors[0];
+		int currentStyleFlags = runs[0].flags;
+		QRgb currentColor = runs[0].color;
 		int prevIndex = 0;
-		for(uint index = 1, size = length(); index < size; ++index) {
-			if(currentStyleFlags != m_styleFlags[index] || ((currentStyleFlags & m_styleFlags[index] & Color) && currentColor != m_styleColors[index])) {
+		for(int run = 1; run < runCount && runs[run].start < size; run++) {
+			const int index = runs[run].start;
+			if(currentStyleFlags != runs[run].flags || ((currentStyleFlags & runs[run].flags & Color) && currentColor != runs[run].color)) {
 				if(currentStyleFlags & StrikeThrough)
 					ret += "<s>";
 				if(currentStyleFlags & Bold)
@@ -220,8 +354,8 @@ SString::richString(RichOutputMode mode) const
 
 				prevIndex = index;
 
-				currentStyleFlags = m_styleFlags[index];
-				currentColor = m_styleColors[index];
+				currentStyleFlags = runs[run].flags;
+				currentColor = runs[run].color;
 			}
 		}
 
@@ -255,69 +389,208 @@ SString::richString(RichOutputMode mode) const
 	return ret;
 }
 
-SString &
-SString::setRichString(const QString &string)
+static inline bool
+equalsLatin1(const QChar *str, const char *latin1, int len)
 {
-	QRegExp tagRegExp("<(/?([bBiIuUsS]|font))[^>]*(\\s+color=\"?([\\w#]+)\"?)?[^>]*>");
+	for(int i = 0; i < len; i++) {
+		if(str[i].toLower().unicode() != ushort(latin1[i]))
+			return false;
+	}
+	return true;
+}
 
-	clear();
+static inline int
+hexValue(QChar ch)
+{
+	const ushort c = ch.unicode();
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+static QRgb
+parseColor(const QChar *str, int len)
+{
+	// fast path for #rgb and #rrggbb, anything else goes through QColor
+	if(str[0] == QLatin1Char('#') && (len == 4 || len == 7)) {
+		int rgb = 0;
+		for(int i = 1; i < len; i++) {
+			const int v = hexValue(str[i]);
+			if(v == -1) {
+				rgb = -1;
+				break;
+			}
+			rgb = len == 4 ? (rgb << 8) | (v << 4) | v : (rgb << 4) | v;
+		}
+		if(rgb != -1)
+			return 0xFF000000 | rgb;
+	}
+
+	const QColor color(QString::fromRawData(str, len).toLower());
+	return color.isValid() ? color.rgb() : 0;
+}
+
+// parses contents of a tag (without the angle brackets) and applies it to style,
+// returns false if it isn't one of the supported tags
+static bool
+parseRichTag(const QChar *tag, int len, int *style, QRgb *color)
+{
+	int i = 0;
+	const bool closing = len && tag[0] == QLatin1Char('/');
+	if(closing)
+		i++;
+
+	const int nameStart = i;
+	while(i < len && !tag[i].isSpace() && tag[i] != QLatin1Char('/'))
+		i++;
+	const int nameLength = i - nameStart;
+
+	if(nameLength == 1) {
+		int flag;
+		switch(tag[nameStart].toLower().unicode()) {
+		case 'b': flag = SString::Bold; break;
+		case 'i': flag = SString::Italic; break;
+		case 'u': flag = SString::Underline; break;
+		case 's': flag = SString::StrikeThrough; break;
+		default: return false;
+		}
+		if(closing)
+			*style &= ~flag;
+		else
+			*style |= flag;
+		return true;
+	}
+
+	if(nameLength != 4 || !equalsLatin1(tag + nameStart, "font", 4))
+		return false;
+
+	if(closing) {
+		*style &= ~SString::Color;
+		*color = 0;
+		return true;
+	}
+
+	// look for whitespace followed by color="value"
+	for(; i + 6 < len; i++) {
+		if(!tag[i].isSpace() || !equalsLatin1(tag + i + 1, "color=", 6))
+			continue;
+		i += 7;
+		if(i < len && (tag[i] == QLatin1Char('"') || tag[i] == QLatin1Char('\'')))
+			i++;
+		const int valueStart = i;
+		while(i < len && (tag[i].isLetterOrNumber() || tag[i] == QLatin1Char('_') || tag[i] == QLatin1Char('#')))
+			i++;
+		if(i > valueStart) {
+			*style |= SString::Color;
+			*color = parseColor(tag + valueStart, i - valueStart);
+		}
+		break;
+	}
+
+	return true;
+}
+
+SString &
+SString::setRichString(const QChar *data, int size)
+{
+	QString text;
+	text.reserve(size);
+	StyleBuilder builder(4);
 
 	int currentStyle = 0;
-	QColor currentColor;
-	int offsetPos = 0, matchedPos;
-	while((matchedPos = tagRegExp.indexIn(string, offsetPos)) != -1) {
-		QString matched(tagRegExp.cap(1).toLower());
+	QRgb currentColor = 0;
+	int tokenStart = 0;
+	for(int pos = 0; pos < size; pos++) {
+		if(data[pos] != QLatin1Char('<'))
+			continue;
+
+		int tagEnd = pos + 1;
+		while(tagEnd < size && data[tagEnd] != QLatin1Char('>'))
+			tagEnd++;
+		if(tagEnd == size) // no more complete tags
+			break;
 
 		int newStyle = currentStyle;
-		QColor newColor(currentColor);
-
-		if(matched == QLatin1String("b")) {
-			newStyle |= SString::Bold;
-		} else if(matched == QLatin1String("i")) {
-			newStyle |= SString::Italic;
-		} else if(matched == QLatin1String("u")) {
-			newStyle |= SString::Underline;
-		} else if(matched == QLatin1String("s")) {
-			newStyle |= SString::StrikeThrough;
-		} else if(matched == QLatin1String("font")) {
-			const QString &color = tagRegExp.cap(4);
-			if(!color.isEmpty()) {
-				newStyle |= SString::Color;
-				newColor.setNamedColor(color.toLower());
-			}
-		} else if(matched == QLatin1String("/b")) {
-			newStyle &= ~SString::Bold;
-		} else if(matched == QLatin1String("/i")) {
-			newStyle &= ~SString::Italic;
-		} else if(matched == QLatin1String("/u")) {
-			newStyle &= ~SString::Underline;
-		} else if(matched == QLatin1String("/s")) {
-			newStyle &= ~SString::StrikeThrough;
-		} else if(matched == QLatin1String("/font")) {
-			newStyle &= ~SString::Color;
-			newColor.setNamedColor("-invalid-");
-		}
+		QRgb newColor = currentColor;
+		if(!parseRichTag(data + pos + 1, tagEnd - pos - 1, &newStyle, &newColor))
+			continue;
 
-		QString token(string.mid(offsetPos, matchedPos - offsetPos));
-		append(SString(token, currentStyle, currentColor.isValid() ? currentColor.rgb() : 0));
+		text.append(data + tokenStart, pos - tokenStart);
+		builder.fill(pos - tokenStart, currentStyle, currentColor);
 		currentStyle = newStyle;
 		currentColor = newColor;
 
-		offsetPos = matchedPos + tagRegExp.cap(0).length();
+		pos = tagEnd;
+		tokenStart = tagEnd + 1;
 	}
 
-	QString token(string.mid(offsetPos, matchedPos - offsetPos));
-	append(SString(token /*.replace("&lt;", "<").replace("&gt;", ">")*/, currentStyle, currentColor.isValid() ? currentColor.rgb() : 0));
+	text.append(data + tokenStart, size - tokenStart);
+	builder.fill(size - tokenStart, currentStyle, currentColor);
+
+	QString::operator=(text);
+	setStyle(builder.take());
 
 	return *this;
 }
 
+int
+SString::styleFlagsAt(int index) const
+{
+	if(index < 0 || index >= length() || !m_style)
+		return 0;
+	return m_style->runs()[m_style->runAt(index)].flags;
+}
+
+void
+SString::setStyleFlagsAt(int index, int styleFlags) const
+{
+	if(index < 0 || index >= length())
+		return;
+	modifyStyle(index, 1, AllStyles, styleFlags, false, 0);
+}
+
+QRgb
+SString::styleColorAt(int index) const
+{
+	if(index < 0 || index >= length() || !m_style)
+		return 0;
+	const StyleRun &run = m_style->runs()[m_style->runAt(index)];
+	return (run.flags & Color) == 0 ? 0 : run.color;
+}
+
+void
+SString::setStyleColorAt(int index, QRgb rgbColor) const
+{
+	if(index < 0 || index >= length())
+		return;
+	modifyStyle(index, 1, rgbColor == 0 ? Color : 0, rgbColor == 0 ? 0 : Color, true, rgbColor);
+}
+
+qint64
+SString::memoryUsage() const
+{
+	return capacity() * sizeof(QChar) + styleMemoryUsage();
+}
+
+qint64
+SString::styleMemoryUsage() const
+{
+	return m_style ? qint64(sizeof(StyleData) + m_style->capacity * sizeof(StyleRun)) : 0;
+}
+
 int
 SString::cummulativeStyleFlags() const
 {
 	int cummulativeStyleFlags = 0;
-	for(int index = 0, size = length(); index < size; ++index) {
-		cummulativeStyleFlags |= m_styleFlags[index];
+	if(!m_style)
+		return cummulativeStyleFlags;
+	const StyleRun *runs = m_style->runs();
+	for(int index = 0, size = m_style->size; index < size && runs[index].start < length(); ++index) {
+		cummulativeStyleFlags |= runs[index].flags;
 		if(cummulativeStyleFlags == AllStyles)
 			break;
 	}
@@ -327,13 +600,7 @@ SString::cummulativeStyleFlags() const
 bool
 SString::hasStyleFlags(int styleFlags) const
 {
-	int cummulativeStyleFlags = 0;
-	for(int index = 0, size = length(); index < size; ++index) {
-		cummulativeStyleFlags |= m_styleFlags[index];
-		if((cummulativeStyleFlags & styleFlags) == styleFlags)
-			return true;
-	}
-	return false;
+	return (cummulativeStyleFlags() & styleFlags) == styleFlags;
 }
 
 SString &
@@ -342,8 +609,7 @@ SString::setStyleFlags(int index, int len, int styleFlags)
 	if(index < 0 || index >= (int)length())
 		return *this;
 
-	for(int index2 = index + length(index, len); index < index2; ++index)
-		m_styleFlags[index] = styleFlags;
+	modifyStyle(index, length(index, len), AllStyles, styleFlags, false, 0);
 
 	return *this;
 }
@@ -354,14 +620,10 @@ SString::setStyleFlags(int index, int len, int styleFlags, bool on)
 	if(index < 0 || index >= (int)length())
 		return *this;
 
-	if(on) {
-		for(int index2 = index + length(index, len); index < index2; ++index)
-			m_styleFlags[index] = m_styleFlags[index] | styleFlags;
-	} else {
-		styleFlags = ~styleFlags;
-		for(int index2 = index + length(index, len); index < index2; ++index)
-			m_styleFlags[index] = m_styleFlags[index] & styleFlags;
-	}
+	if(on)
+		modifyStyle(index, length(index, len), 0, styleFlags, false, 0);
+	else
+		modifyStyle(index, length(index, len), styleFlags, 0, false, 0);
 
 	return *this;
 }
@@ -372,13 +634,7 @@ SString::setStyleColor(int index, int len, QRgb color)
 	if(index < 0 || index >= (int)length())
 		return *this;
 
-	for(int sz = index + length(index, len); index < sz; index++) {
-		m_styleColors[index] = color;
-		if(color == 0)
-			m_styleFlags[index] &= ~Color;
-		else
-			m_styleFlags[index] |= Color;
-	}
+	modifyStyle(index, length(index, len), color == 0 ? Color : 0, color == 0 ? 0 : Color, true, color);
 
 	return *this;
 }
@@ -387,46 +643,13 @@ void
 SString::clear()
 {
 	QString::clear();
-	setMinFlagsCapacity(0);
+	setStyle(nullptr);
 }
 
 SString &
 SString::insert(int index, QChar ch)
 {
-	int oldLength = length();
-
-	if(index <= oldLength && index >= 0) {
-		QString::insert(index, ch);
-
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
-
-		char fillFlags = 0;
-		int fillColor = 0;
-		if(oldLength) {
-			if(index == 0) {
-				fillFlags = oldStyleFlags[0];
-				fillColor = oldStyleColors[0];
-			} else {
-				fillFlags = oldStyleFlags[index - 1];
-				fillColor = oldStyleColors[index - 1];
-			}
-		}
-
-		memcpy(m_styleFlags, oldStyleFlags, index * sizeof(*m_styleFlags));
-		m_styleFlags[index] = fillFlags;
-		memcpy(m_styleFlags + index + 1, oldStyleFlags + index, (length() - index - 1) * sizeof(*m_styleFlags));
-
-		memcpy(m_styleColors, oldStyleColors, index * sizeof(*m_styleColors));
-		m_styleColors[index] = fillColor;
-		memcpy(m_styleColors + index + 1, oldStyleColors + index, (length() - index - 1) * sizeof(*m_styleColors));
-
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
-	}
-
-	return *this;
+	return insert(index, QString(ch));
 }
 
 SString &
@@ -437,34 +660,14 @@ SString::insert(int index, const QString &str)
 	if(str.length() && index <= oldLength && index >= 0) {
 		QString::insert(index, str);
 
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
-
-		char fillFlags = 0;
-		int fillColor = 0;
-		if(oldLength) {
-			if(index == 0) {
-				fillFlags = oldStyleFlags[0];
-				fillColor = oldStyleColors[0];
-			} else {
-				fillFlags = oldStyleFlags[index - 1];
-				fillColor = oldStyleColors[index - 1];
-			}
-		}
-
-		int addedLength = str.length();
-
-		memcpy(m_styleFlags, oldStyleFlags, index * sizeof(*m_styleFlags));
-		memset(m_styleFlags + index, fillFlags, addedLength * sizeof(*m_styleFlags));
-		memcpy(m_styleFlags + index + addedLength, oldStyleFlags + index, (length() - index - addedLength) * sizeof(*m_styleFlags));
-
-		memcpy(m_styleColors, oldStyleColors, index * sizeof(*m_styleColors));
-		memset_n(m_styleColors + index, fillColor, addedLength, sizeof(*m_styleColors));
-		memcpy(m_styleColors + index + addedLength, oldStyleColors + index, (length() - index - addedLength) * sizeof(*m_styleColors));
-
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
+		StyleBuilder builder(m_style ? m_style->size + 2 : 1);
+		builder.append(m_style, 0, index);
+		if(oldLength)
+			builder.fillFrom(m_style, index == 0 ? 0 : index - 1, str.length());
+		else
+			builder.fill(str.length(), 0, 0);
+		builder.append(m_style, index, oldLength - index);
+		setStyle(builder.take());
 	}
 
 	return *this;
@@ -476,26 +679,62 @@ SString::insert(int index, const SString &str)
 	int oldLength = length();
 
 	if(str.length() && index <= oldLength && index >= 0) {
+		const int addedLength = str.length();
+		const SString added(str);
+
 		QString::insert(index, str);
 
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
+		StyleBuilder builder((m_style ? m_style->size : 1) + (added.m_style ? added.m_style->size : 1) + 1);
+		builder.append(m_style, 0, index);
+		builder.append(added.m_style, 0, addedLength);
+		builder.append(m_style, index, oldLength - index);
+		setStyle(builder.take());
+	}
 
-		int addedLength = str.length();
+	return *this;
+}
+
+SString &
+SString::append(const QChar *data, int len, int styleFlags, QRgb styleColor)
+{
+	if(len <= 0)
+		return *this;
 
-		memcpy(m_styleFlags, oldStyleFlags, index * sizeof(*m_styleFlags));
-		memcpy(m_styleFlags + index, str.m_styleFlags, addedLength * sizeof(*m_styleFlags));
-		memcpy(m_styleFlags + index + addedLength, oldStyleFlags + index, (length() - index - addedLength) * sizeof(*m_styleFlags));
+	const int oldLength = length();
+	QString::append(data, len);
 
-		memcpy(m_styleColors, oldStyleColors, index * sizeof(*m_styleColors));
-		memcpy(m_styleColors + index, str.m_styleColors, addedLength * sizeof(*m_styleColors));
-		memcpy(m_styleColors + index + addedLength, oldStyleColors + index, (length() - index - addedLength) * sizeof(*m_styleColors));
+	styleFlags &= AllStyles;
 
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
+	if(!oldLength) {
+		StyleBuilder builder(4);
+		builder.fill(len, styleFlags, styleColor);
+		setStyle(builder.take());
+		return *this;
 	}
 
+	// runs end where the next one starts, so a run with the same style just grows
+	if(m_style ? m_style->runs()[m_style->size - 1].sameStyle(styleFlags, styleColor) : styleFlags == 0 && styleColor == 0)
+		return *this;
+
+	if(!m_style || m_style->ref.load() != 1 || m_style->size == m_style->capacity) {
+		StyleData *style = allocStyle(m_style ? m_style->size * 2 : 4);
+		if(m_style) {
+			memcpy(style->runs(), m_style->runs(), m_style->size * sizeof(StyleRun));
+			style->size = m_style->size;
+		} else {
+			StyleRun &run = style->runs()[style->size++];
+			run.start = 0;
+			run.flags = 0;
+			run.color = 0;
+		}
+		setStyle(style);
+	}
+
+	StyleRun &run = m_style->runs()[m_style->size++];
+	run.start = oldLength;
+	run.flags = styleFlags;
+	run.color = styleColor;
+
 	return *this;
 }
 
@@ -518,34 +757,12 @@ SString::replace(int index, int len, const QString &replacement)
 	if(len == 1 && replacement.length() == 1)
 		return *this;
 
-	if(len == replacement.length()) {
-		// the length of the string wasn't changed
-		if(index >= oldLength) {
-			// index can't really be greater than oldLength
-			memset(m_styleFlags + index, oldLength ? m_styleFlags[oldLength - 1] : 0, len * sizeof(*m_styleFlags));
-			memset_n(m_styleColors + index, oldLength ? m_styleColors[oldLength - 1] : 0, len, sizeof(*m_styleColors));
-		} else {
-			// index < oldLength (NOTE: index is always >= 0)
-			memset(m_styleFlags + index, m_styleFlags[index], len * sizeof(*m_styleFlags));
-			memset_n(m_styleColors + index, m_styleColors[oldLength - 1], len, sizeof(*m_styleColors));
-		}
-	} else {
-		// the length of the string was changed
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
-
-		memcpy(m_styleFlags, oldStyleFlags, index * sizeof(*m_styleFlags));
-		memset(m_styleFlags + index, oldStyleFlags[index], replacement.length() * sizeof(*m_styleFlags));
-		memcpy(m_styleFlags + index + replacement.length(), oldStyleFlags + index + len, (length() - index - replacement.length()) * sizeof(*m_styleFlags));
-
-		memcpy(m_styleColors, oldStyleColors, index * sizeof(*m_styleColors));
-		memset_n(m_styleColors + index, oldStyleColors[index], replacement.length(), sizeof(*m_styleColors));
-		memcpy(m_styleColors + index + replacement.length(), oldStyleColors + index + len, (length() - index - replacement.length()) * sizeof(*m_styleColors));
-
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
-	}
+	// replaced text takes the style of the first replaced character
+	StyleBuilder builder(m_style ? m_style->size + 2 : 1);
+	builder.append(m_style, 0, index);
+	builder.fillFrom(m_style, index, replacement.length());
+	builder.append(m_style, index + len, oldLength - index - len);
+	setStyle(builder.take());
 
 	return *this;
 }
@@ -563,26 +780,15 @@ SString::replace(int index, int len, const SString &replacement)
 	if(len == 0 && replacement.length() == 0) // nothing to do (replace nothing with nothing)
 		return *this;
 
-	QString::replace(index, len, replacement);
-
-	// simple path for when there's no need to change the styles (char substitution)
-	// if ( len == 1 && replacement.length() == 1 )
-	//  return *this;
-
-	char *oldStyleFlags = detachFlags();
-	QRgb *oldStyleColors = detachColors();
-	setMinFlagsCapacity(length());
-
-	memcpy(m_styleFlags, oldStyleFlags, index * sizeof(*m_styleFlags));
-	memcpy(m_styleFlags + index, replacement.m_styleFlags, replacement.length() * sizeof(*m_styleFlags));
-	memcpy(m_styleFlags + index + replacement.length(), oldStyleFlags + index + len, (length() - index - replacement.length()) * sizeof(*m_styleFlags));
+	const SString added(replacement);
 
-	memcpy(m_styleColors, oldStyleColors, index * sizeof(*m_styleColors));
-	memcpy(m_styleColors + index, replacement.m_styleColors, replacement.length() * sizeof(*m_styleColors));
-	memcpy(m_styleColors + index + replacement.length(), oldStyleColors + index + len, (length() - index - replacement.length()) * sizeof(*m_styleColors));
+	QString::replace(index, len, added);
 
-	delete[] oldStyleFlags;
-	delete[] oldStyleColors;
+	StyleBuilder builder((m_style ? m_style->size : 1) + (added.m_style ? added.m_style->size : 1) + 1);
+	builder.append(m_style, 0, index);
+	builder.append(added.m_style, 0, added.length());
+	builder.append(m_style, index + len, oldLength - index - len);
+	setStyle(builder.take());
 
 	return *this;
 }
@@ -622,31 +828,27 @@ SString::replace(const QString &before, const QString &after, Qt::CaseSensitivit
 		int oldOffset = 0;
 		int unchangedLength;
 
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
+		StyleBuilder builder((m_style ? m_style->size : 1) + 2 * changedData.size());
 
 		for(int index = 0; index < changedData.size(); ++index) {
 			unchangedLength = changedData[index] - newOffset;
 
-			memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, unchangedLength * sizeof(*m_styleFlags));
-			memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, unchangedLength * sizeof(*m_styleColors));
+			builder.append(m_style, oldOffset, unchangedLength);
 			newOffset += unchangedLength;
 			oldOffset += unchangedLength;
 
-			memset(m_styleFlags + newOffset, oldOffset < oldLength ? oldStyleFlags[oldOffset] : 0, afterLength * sizeof(*m_styleFlags));
-			memset_n(m_styleColors + newOffset, oldOffset < oldLength ? oldStyleColors[oldOffset] : 0, afterLength, sizeof(*m_styleColors));
+			if(oldOffset < oldLength)
+				builder.fillFrom(m_style, oldOffset, afterLength);
+			else
+				builder.fill(afterLength, 0, 0);
 			newOffset += afterLength;
 			oldOffset += beforeLength;
 		}
 
-		memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, (oldLength - oldOffset) * sizeof(*m_styleFlags));
-		memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, (oldLength - oldOffset) * sizeof(*m_styleColors));
-
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
+		builder.append(m_style, oldOffset, oldLength - oldOffset);
+		setStyle(builder.take());
 	} else {
-		setMinFlagsCapacity(length());
+		setStyle(nullptr);
 	}
 
 	return *this;
@@ -681,31 +883,24 @@ SString::replace(const QString &before, const SString &after, Qt::CaseSensitivit
 		int oldOffset = 0;
 		int unchangedLength;
 
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
+		StyleBuilder builder((m_style ? m_style->size : 1) + 2 * changedData.size());
 
 		for(int index = 0; index < changedData.size(); ++index) {
 			unchangedLength = changedData[index] - newOffset;
 
-			memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, unchangedLength * sizeof(*m_styleFlags));
-			memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, unchangedLength * sizeof(*m_styleColors));
+			builder.append(m_style, oldOffset, unchangedLength);
 			newOffset += unchangedLength;
 			oldOffset += unchangedLength;
 
-			memcpy(m_styleFlags + newOffset, after.m_styleFlags, afterLength * sizeof(*m_styleFlags));
-			memcpy(m_styleColors + newOffset, after.m_styleColors, afterLength * sizeof(*m_styleColors));
+			builder.append(after.m_style, 0, afterLength);
 			newOffset += afterLength;
 			oldOffset += beforeLength;
 		}
 
-		memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, oldLength - oldOffset * sizeof(*m_styleFlags));
-		memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, (oldLength - oldOffset) * sizeof(*m_styleColors));
-
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
+		builder.append(m_style, oldOffset, oldLength - oldOffset);
+		setStyle(builder.take());
 	} else {
-		setMinFlagsCapacity(length());
+		setStyle(nullptr);
 	}
 
 	return *this;
@@ -746,31 +941,27 @@ SString::replace(QChar ch, const QString &after, Qt::CaseSensitivity cs)
 		int oldOffset = 0;
 		int unchangedLength;
 
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
+		StyleBuilder builder((m_style ? m_style->size : 1) + 2 * changedData.size());
 
 		for(int index = 0; index < changedData.size(); ++index) {
 			unchangedLength = changedData[index] - newOffset;
 
-			memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, unchangedLength * sizeof(*m_styleFlags));
-			memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, unchangedLength * sizeof(*m_styleColors));
+			builder.append(m_style, oldOffset, unchangedLength);
 			newOffset += unchangedLength;
 			oldOffset += unchangedLength;
 
-			memset(m_styleFlags + newOffset, oldOffset < oldLength ? oldStyleFlags[oldOffset] : 0, afterLength * sizeof(*m_styleFlags));
-			memset_n(m_styleColors + newOffset, oldOffset < oldLength ? oldStyleColors[oldOffset] : 0, afterLength, sizeof(*m_styleColors));
+			if(oldOffset < oldLength)
+				builder.fillFrom(m_style, oldOffset, afterLength);
+			else
+				builder.fill(afterLength, 0, 0);
 			newOffset += afterLength;
 			oldOffset += 1;
 		}
 
-		memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, oldLength - oldOffset * sizeof(*m_styleFlags));
-		memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, (oldLength - oldOffset) * sizeof(*m_styleColors));
-
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
+		builder.append(m_style, oldOffset, oldLength - oldOffset);
+		setStyle(builder.take());
 	} else {
-		setMinFlagsCapacity(length());
+		setStyle(nullptr);
 	}
 
 	return *this;
@@ -798,31 +989,24 @@ SString::replace(QChar ch, const SString &after, Qt::CaseSensitivity cs)
 		int oldOffset = 0;
 		int unchangedLength;
 
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
+		StyleBuilder builder((m_style ? m_style->size : 1) + 2 * changedData.size());
 
 		for(int index = 0; index < changedData.size(); ++index) {
 			unchangedLength = changedData[index] - newOffset;
 
-			memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, unchangedLength * sizeof(*m_styleFlags));
-			memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, unchangedLength * sizeof(*m_styleColors));
+			builder.append(m_style, oldOffset, unchangedLength);
 			newOffset += unchangedLength;
 			oldOffset += unchangedLength;
 
-			memcpy(m_styleFlags + newOffset, after.m_styleFlags, afterLength * sizeof(*m_styleFlags));
-			memcpy(m_styleColors + newOffset, after.m_styleColors, afterLength * sizeof(*m_styleColors));
+			builder.append(after.m_style, 0, afterLength);
 			newOffset += afterLength;
 			oldOffset += 1;
 		}
 
-		memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, oldLength - oldOffset * sizeof(*m_styleFlags));
-		memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, (oldLength - oldOffset) * sizeof(*m_styleColors));
-
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
+		builder.append(m_style, oldOffset, oldLength - oldOffset);
+		setStyle(builder.take());
 	} else {
-		setMinFlagsCapacity(length());
+		setStyle(nullptr);
 	}
 
 	return *this;
@@ -887,33 +1071,29 @@ SString::replace(const QRegExp &rx, const QString &a)
 		int beforeLength;
 		int afterLength;
 
-		char *oldStyleFlags = detachFlags();
-		QRgb *oldStyleColors = detachColors();
-		setMinFlagsCapacity(length());
+		StyleBuilder builder((m_style ? m_style->size : 1) + 2 * changedData.size());
 
 		for(int index = 0; index < changedData.size(); index += 3) {
 			unchangedLength = changedData[index] - newOffset;
 			beforeLength = changedData[index + 1];
 			afterLength = changedData[index + 2];
 
-			memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, unchangedLength * sizeof(*m_styleFlags));
-			memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, unchangedLength * sizeof(*m_styleColors));
+			builder.append(m_style, oldOffset, unchangedLength);
 			newOffset += unchangedLength;
 			oldOffset += unchangedLength;
 
-			memset(m_styleFlags + newOffset, oldOffset < oldLength ? oldStyleFlags[oldOffset] : 0, afterLength * sizeof(*m_styleFlags));
-			memset_n(m_styleColors + newOffset, oldOffset < oldLength ? oldStyleColors[oldOffset] : 0, afterLength, sizeof(*m_styleColors));
+			if(oldOffset < oldLength)
+				builder.fillFrom(m_style, oldOffset, afterLength);
+			else
+				builder.fill(afterLength, 0, 0);
 			newOffset += afterLength;
 			oldOffset += beforeLength;
 		}
 
-		memcpy(m_styleFlags + newOffset, oldStyleFlags + oldOffset, oldLength - oldOffset * sizeof(*m_styleFlags));
-		memcpy(m_styleColors + newOffset, oldStyleColors + oldOffset, (oldLength - oldOffset) * sizeof(*m_styleColors));
-
-		delete[] oldStyleFlags;
-		delete[] oldStyleColors;
+		builder.append(m_style, oldOffset, oldLength - oldOffset);
+		setStyle(builder.take());
 	} else {
-		setMinFlagsCapacity(length());
+		setStyle(nullptr);
 	}
 
 	return *this;
@@ -1065,9 +1245,7 @@ SString::replace(const QRegularExpression &regExp, const SString &replacement, b
 
 	// finally copy the data
 	resize(newLength);
-	char *oldStyleFlags = detachFlags();
-	QRgb *oldStyleColors = detachColors();
-	setMinFlagsCapacity(newLength);
+	StyleBuilder builder((m_style ? m_style->size : 1) + chunks.size());
 
 	int newOff = 0;
 	QChar *newData = data();
@@ -1077,8 +1255,7 @@ SString::replace(const QRegularExpression &regExp, const SString &replacement, b
 		int len = chunks[i + 1];
 		if(len > 0) {
 			memcpy(newData + newOff, copy.midRef(off, len).unicode(), len * sizeof(QChar));
-			memcpy(m_styleFlags + newOff, oldStyleFlags + off, len * sizeof(*m_styleFlags));
-			memcpy(m_styleColors + newOff, oldStyleColors + off, len * sizeof(*m_styleColors));
+			builder.append(m_style, off, len);
 			newOff += len;
 		}
 
@@ -1089,20 +1266,16 @@ SString::replace(const QRegularExpression &regExp, const SString &replacement, b
 			int repLen = chunks[i + 1];
 			if(repLen > 0) {
 				memcpy(newData + newOff, replacement.midRef(repOff, repLen).unicode(), repLen * sizeof(QChar));
-				if(styleFromReplacement) {
-					memcpy(m_styleFlags + newOff, replacement.m_styleFlags + repOff, repLen * sizeof(*m_styleFlags));
-					memcpy(m_styleColors + newOff, replacement.m_styleColors + repOff, repLen * sizeof(*m_styleColors));
-				} else {
-					memset(m_styleFlags + newOff, oldStyleFlags[off + len], repLen * sizeof(*m_styleFlags));
-					memset_n(m_styleColors + newOff, oldStyleColors[off + len], repLen, sizeof(*m_styleColors));
-				}
+				if(styleFromReplacement)
+					builder.append(replacement.m_style, repOff, repLen);
+				else
+					builder.fillFrom(m_style, off + len, repLen);
 				newOff += repLen;
 			}
 		}
 	}
 
-	delete[] oldStyleFlags;
-	delete[] oldStyleColors;
+	setStyle(builder.take());
 
 	return *this;
 }
@@ -1173,25 +1346,14 @@ SString::split(const QRegExp &sep, QString::SplitBehavior behavior) const
 SString
 SString::left(int len) const
 {
-	len = length(0, len);
-	SString ret;
-	ret.operator=(QString::left(len));
-	ret.setMinFlagsCapacity(len);
-	memcpy(ret.m_styleFlags, m_styleFlags, len * sizeof(*m_styleFlags));
-	memcpy(ret.m_styleColors, m_styleColors, len * sizeof(*m_styleColors));
-	return ret;
+	return mid(0, len);
 }
 
 SString
 SString::right(int len) const
 {
 	len = length(0, len);
-	SString ret;
-	ret.operator=(QString::right(len));
-	ret.setMinFlagsCapacity(len);
-	memcpy(ret.m_styleFlags, m_styleFlags + length() - len, len * sizeof(*m_styleFlags));
-	memcpy(ret.m_styleColors, m_styleColors + length() - len, len * sizeof(*m_styleColors));
-	return ret;
+	return mid(length() - len, len);
 }
 
 SString
@@ -1208,10 +1370,10 @@ SString::mid(int index, int len) const
 
 	len = length(index, len);
 	SString ret;
-	ret.operator=(QString::mid(index, len));
-	ret.setMinFlagsCapacity(len);
-	memcpy(ret.m_styleFlags, m_styleFlags + index, len * sizeof(*m_styleFlags));
-	memcpy(ret.m_styleColors, m_styleColors + index, len * sizeof(*m_styleColors));
+	ret.QString::operator=(QString::mid(index, len));
+	StyleBuilder builder(m_style ? m_style->size : 1);
+	builder.append(m_style, index, len);
+	ret.setStyle(builder.take());
 	return ret;
 }
 
@@ -1353,6 +1515,12 @@ SString::simplifyWhiteSpace(QString &text)
 void
 SString::simplifyWhiteSpace()
 {
+	StyleBuilder builder(m_style ? m_style->size : 1);
+	const StyleRun noStyle = { 0, 0, 0 };
+	const StyleRun *runs = m_style ? m_style->runs() : &noStyle;
+	const int runCount = m_style ? m_style->size : 1;
+	int run = 0;
+
 	int di = 0;
 	bool lastWasSpace = true;
 	bool lastWasLineFeed = true;
@@ -1372,10 +1540,10 @@ SString::simplifyWhiteSpace()
 		else if(di != i) // copy other chars
 			operator[](di) = ch;
 
-		if(di != i) {
-			m_styleFlags[di] = m_styleFlags[i];
-			m_styleColors[di] = m_styleColors[i];
-		}
+		while(run + 1 < runCount && runs[run + 1].start <= i)
+			run++;
+		builder.truncate(di);
+		builder.fill(1, runs[run].flags, runs[run].color);
 
 		lastWasLineFeed = at(di) == QChar::LineFeed;
 		lastWasSpace = lastWasLineFeed || at(di) == QChar::Space;
@@ -1385,6 +1553,8 @@ SString::simplifyWhiteSpace()
 	if(lastWasLineFeed)
 		di--;
 	truncate(di);
+	builder.truncate(di);
+	setStyle(builder.take());
 }
 
 bool
@@ -1393,56 +1563,158 @@ SString::operator!=(const SString &sstring) const
 	if(!(static_cast<const QString &>(*this) == static_cast<const QString &>(sstring)))
 		return true;
 
-	for(int i = 0, sz = length(); i < sz; i++) {
-		if(m_styleFlags[i] != sstring.m_styleFlags[i])
+	if(m_style == sstring.m_style)
+		return false;
+
+	const StyleRun noStyle = { 0, 0, 0 };
+	const StyleRun *runs = m_style ? m_style->runs() : &noStyle;
+	const int runCount = m_style ? m_style->size : 1;
+	const StyleRun *otherRuns = sstring.m_style ? sstring.m_style->runs() : &noStyle;
+	const int otherRunCount = sstring.m_style ? sstring.m_style->size : 1;
+
+	// walk both run lists comparing the overlapping segments
+	for(int i = 0, j = 0, pos = 0, sz = length(); pos < sz;) {
+		if(runs[i].flags != otherRuns[j].flags)
 			return true;
-		if((m_styleFlags[i] & Color) != 0 && m_styleColors[i] != sstring.m_styleColors[i])
+		if((runs[i].flags & Color) != 0 && runs[i].color != otherRuns[j].color)
 			return true;
+
+		const int end = i + 1 < runCount ? runs[i + 1].start : sz;
+		const int otherEnd = j + 1 < otherRunCount ? otherRuns[j + 1].start : sz;
+		pos = qMin(end, otherEnd);
+		if(end == pos)
+			i++;
+		if(otherEnd == pos)
+			j++;
 	}
 
 	return false;
 }
 
-char *
-SString::detachFlags()
+SString::StyleData *
+SString::allocStyle(int capacity)
 {
-	char *ret = m_styleFlags;
-	m_styleFlags = nullptr;
-	m_capacity = 0;
-	return ret;
+	StyleData *style = new(::operator new(sizeof(StyleData) + capacity * sizeof(StyleRun))) StyleData;
+	style->ref.store(1);
+	style->size = 0;
+	style->capacity = capacity;
+	return style;
 }
 
-QRgb *
-SString::detachColors()
+void
+SString::releaseStyle(StyleData *style)
 {
-	QRgb *ret = m_styleColors;
-	m_styleColors = nullptr;
-	m_capacity = 0;
-	return ret;
+	if(style && !style->ref.deref()) {
+		style->~StyleData();
+		::operator delete(style);
+	}
 }
 
 void
-SString::setMinFlagsCapacity(int capacity)
-{
-	if(capacity > m_capacity) {
-		m_capacity = capacity * 2;
-		delete[] m_styleFlags;
-		m_styleFlags = new char[m_capacity];
-		delete[] m_styleColors;
-		m_styleColors = new QRgb[m_capacity];
-	} else if(capacity == 0) {
-		m_capacity = 0;
-		delete[] m_styleFlags;
-		m_styleFlags = nullptr;
-		delete[] m_styleColors;
-		m_styleColors = nullptr;
-	} else if(m_capacity > 100 && capacity < m_capacity / 2) {
-		m_capacity = m_capacity / 2;
-		delete[] m_styleFlags;
-		m_styleFlags = new char[m_capacity];
-		delete[] m_styleColors;
-		m_styleColors = new QRgb[m_capacity];
+SString::setStyle(StyleData *style) const
+{
+	releaseStyle(m_style);
+	m_style = style;
+}
+
+int
+SString::splitRun(int index) const
+{
+	StyleRun *runs = m_style->runs();
+	const int run = m_style->runAt(index);
+	if(runs[run].start == index)
+		return run;
+
+	Q_ASSERT(m_style->size < m_style->capacity);
+	memmove(runs + run + 2, runs + run + 1, (m_style->size - run - 1) * sizeof(StyleRun));
+	runs[run + 1] = runs[run];
+	runs[run + 1].start = index;
+	m_style->size++;
+	return run + 1;
+}
+
+void
+SString::modifyStyle(int index, int len, int clearFlags, int setFlags, bool setColor, QRgb color) const
+{
+	if(len <= 0)
+		return;
+
+	if(!m_style) {
+		StyleBuilder builder(1);
+		builder.fill(length(), 0, 0);
+		m_style = builder.take();
+	}
+
+	const int end = index + len;
+
+	// nothing to do if the styles wouldn't change
+	bool changed = false;
+	for(int i = m_style->runAt(index); i < m_style->size && m_style->runs()[i].start < end; i++) {
+		const StyleRun &run = m_style->runs()[i];
+		if(!run.sameStyle((run.flags & ~clearFlags) | setFlags, setColor ? color : run.color)) {
+			changed = true;
+			break;
+		}
+	}
+	if(!changed)
+		return;
+
+	// splitting the runs at index and end adds at most two runs
+	if(m_style->ref.load() != 1 || m_style->size + 2 > m_style->capacity) {
+		StyleData *style = allocStyle(m_style->size + m_style->size / 2 + 2);
+		memcpy(style->runs(), m_style->runs(), m_style->size * sizeof(StyleRun));
+		style->size = m_style->size;
+		setStyle(style);
 	}
+
+	const int first = splitRun(index);
+	const int last = end < length() ? splitRun(end) : m_style->size;
+
+	StyleRun *runs = m_style->runs();
+	for(int i = first; i < last; i++) {
+		runs[i].flags = (runs[i].flags & ~clearFlags) | setFlags;
+		if(setColor)
+			runs[i].color = color;
+	}
+
+	// merge neighbouring runs that ended up with the same style
+	int di = first > 0 ? first - 1 : 0;
+	for(int i = di + 1; i < m_style->size; i++) {
+		if(!runs[di].sameStyle(runs[i].flags, runs[i].color))
+			runs[++di] = runs[i];
+	}
+	m_style->size = di + 1;
+}
+
+void
+SString::writeStyles(QDataStream &stream) const
+{
+	QByteArray styleFlags(length(), 0);
+	QVector<QRgb> styleColors(length(), 0);
+	if(m_style) {
+		const StyleRun *runs = m_style->runs();
+		for(int i = 0, n = m_style->size; i < n && runs[i].start < length(); i++) {
+			const int end = i + 1 < n ? qMin(runs[i + 1].start, length()) : length();
+			memset(styleFlags.data() + runs[i].start, runs[i].flags, end - runs[i].start);
+			std::fill(styleColors.begin() + runs[i].start, styleColors.begin() + end, runs[i].color);
+		}
+	}
+	stream.writeRawData(styleFlags.constData(), styleFlags.size());
+	stream.writeRawData(reinterpret_cast<const char *>(styleColors.constData()), styleColors.size() * sizeof(QRgb));
+}
+
+void
+SString::readStyles(QDataStream &stream)
+{
+	QByteArray styleFlags(length(), 0);
+	QVector<QRgb> styleColors(length(), 0);
+	stream.readRawData(styleFlags.data(), styleFlags.size());
+	stream.readRawData(reinterpret_cast<char *>(styleColors.data()), styleColors.size() * sizeof(QRgb));
+
+	StyleBuilder builder(1);
+	for(int i = 0, n = length(); i < n; i++)
+		builder.fill(1, styleFlags.at(i), styleColors.at(i));
+	setStyle(builder.take());
 }
 
 SStringList::SStringList()
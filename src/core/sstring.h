@@ -31,8 +31,6 @@
 
 #include <QDebug>
 
-void * memset_n(void *ptr, int value, size_t length, size_t size);
-
 namespace SubtitleComposer {
 class SString;
 
@@ -70,7 +68,9 @@ public:
 
 	SString(const QString &string = QString(), int styleFlags = 0, QRgb styleColor = 0);            // krazy:exclude=c++/explicit
 	SString(const SString &sstring);
+	SString(SString &&sstring) noexcept;
 	SString & operator=(const SString &sstring);
+	SString & operator=(SString &&sstring) noexcept;
 
 	~SString();
 
@@ -78,7 +78,8 @@ public:
 	void setString(const QString &string, int styleFlags = 0, QRgb styleColor = 0);         // always clears all the style flags
 
 	QString richString(RichOutputMode mode = Compact) const;
-	SString & setRichString(const QString &string);
+	inline SString & setRichString(const QString &string) { return setRichString(string.constData(), string.length()); }
+	SString & setRichString(const QChar *data, int size);           // parses size characters of data, e.g. part of a document
 
 	int styleFlagsAt(int index) const;
 	void setStyleFlagsAt(int index, int styleFlags) const;
@@ -91,6 +92,10 @@ public:
 	SString & setStyleFlags(int index, int len, int styleFlags, bool on);
 	SString & setStyleColor(int index, int len, QRgb color);
 
+	/// bytes allocated for characters and style runs, data shared by copies is counted by each of them
+	qint64 memoryUsage() const;
+	qint64 styleMemoryUsage() const;
+
 	void clear();
 
 	SString & insert(int index, QChar ch);
@@ -99,6 +104,7 @@ public:
 	SString & append(QChar ch);
 	SString & append(const QString &str);
 	SString & append(const SString &str);
+	SString & append(const QChar *data, int len, int styleFlags, QRgb styleColor);  // amortized, for building text piece by piece
 	SString & prepend(QChar ch);
 	SString & prepend(const QString &str);
 	SString & prepend(const SString &str);
@@ -151,50 +157,26 @@ public:
 	inline int length() const { return QString::length(); }
 
 private:
-	char * detachFlags();
-	QRgb * detachColors();
-	void setMinFlagsCapacity(int capacity);
+	struct StyleRun;
+	struct StyleData;
+	class StyleBuilder;
+
+	static StyleData * allocStyle(int capacity);
+	static void releaseStyle(StyleData *style);
+	void setStyle(StyleData *style) const;
+	int splitRun(int index) const;
+	void modifyStyle(int index, int len, int clearFlags, int setFlags, bool setColor, QRgb color) const;
+	void writeStyles(QDataStream &stream) const;
+	void readStyles(QDataStream &stream);
 
 	int length(int index, int len) const;
 
 private:
-	char *m_styleFlags;
-	QRgb *m_styleColors;
-	int m_capacity;
+	// styles are stored as runs of equally styled characters, implicitly
+	// shared between copies and copied on write
+	mutable StyleData *m_style;
 };
 
-inline int
-SString::styleFlagsAt(int index) const
-{
-	return index < 0 || index >= length() ? 0 : m_styleFlags[index];
-}
-
-inline void
-SString::setStyleFlagsAt(int index, int styleFlags) const
-{
-	if(index < 0 || index >= length())
-		return;
-	m_styleFlags[index] = styleFlags;
-}
-
-inline QRgb
-SString::styleColorAt(int index) const
-{
-	return index < 0 || index >= length() || (m_styleFlags[index] & SString::Color) == 0 ? 0 : m_styleColors[index];
-}
-
-inline void
-SString::setStyleColorAt(int index, QRgb rgbColor) const
-{
-	if(index < 0 || index >= length())
-		return;
-	if(rgbColor == 0)
-		m_styleFlags[index] &= ~SString::Color;
-	else
-		m_styleFlags[index] |= SString::Color;
-	m_styleColors[index] = rgbColor;
-}
-
 inline SString &
 SString::append(QChar ch)
 {
@@ -288,8 +270,7 @@ SString::length(int index, int len) const
 inline QDataStream &
 operator<<(QDataStream &stream, const SubtitleComposer::SString &string) {
 	stream << static_cast<const QString &>(string);
-	stream.writeRawData(string.m_styleFlags, string.length() * sizeof(*string.m_styleFlags));
-	stream.writeRawData(reinterpret_cast<const char *>(string.m_styleColors), string.length() * sizeof(*string.m_styleColors));
+	string.writeStyles(stream);
 
 	return stream;
 }
@@ -297,12 +278,12 @@ operator<<(QDataStream &stream, const SubtitleComposer::SString &string) {
 inline QDataStream &
 operator>>(QDataStream &stream, SubtitleComposer::SString &string) {
 	stream >> static_cast<QString &>(string);
-	string.setMinFlagsCapacity(string.size());
-	stream.readRawData(string.m_styleFlags, string.length() * sizeof(*string.m_styleFlags));
-	stream.readRawData(reinterpret_cast<char *>(string.m_styleColors), string.length() * sizeof(*string.m_styleColors));
+	string.readStyles(stream);
 
 	return stream;
 }
 }
 
+Q_DECLARE_TYPEINFO(SubtitleComposer::SString, Q_MOVABLE_TYPE);
+
 #endif
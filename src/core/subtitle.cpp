@@ -21,15 +21,20 @@
 #include "core/subtitle.h"
 #include "core/subtitleline.h"
 #include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 #include "core/subtitleactions.h"
 #include "core/subtitlelineactions.h"
 #include "helpers/objectref.h"
+#include "helpers/parallel.h"
+#include "helpers/profiler.h"
 #include "scconfig.h"
-#include "application.h"
 
 #include <KLocalizedString>
 #include <QUndoStack>
 
+#include <algorithm>
+#include <iterator>
+
 using namespace SubtitleComposer;
 
 double Subtitle::s_defaultFramesPerSecond(23.976);
@@ -52,8 +57,25 @@ Subtitle::Subtitle(double framesPerSecond)
 	  m_secondaryState(0),
 	  m_secondaryCleanState(0),
 	  m_framesPerSecond(framesPerSecond),
+	  m_undoStack(nullptr),
+	  m_timeIndex(this),
+	  m_compositeActionDepth(0),
+	  m_undoStackActionOpen(false),
+	  m_showTimeSortPending(false),
 	  m_formatData(nullptr)
-{}
+{
+	connect(this, &Subtitle::linesInserted, this, &Subtitle::invalidateTimeIndex);
+	connect(this, &Subtitle::linesRemoved, this, &Subtitle::invalidateTimeIndex);
+	connect(this, &Subtitle::lineRangesInserted, this, &Subtitle::invalidateTimeIndex);
+	connect(this, &Subtitle::lineRangesRemoved, this, &Subtitle::invalidateTimeIndex);
+	connect(this, &Subtitle::linesReordered, this, &Subtitle::invalidateTimeIndex);
+
+	connect(this, &Subtitle::linesInserted, this, &Subtitle::onLinesInserted);
+	connect(this, &Subtitle::linesRemoved, this, &Subtitle::onLinesRemoved);
+	connect(this, &Subtitle::lineRangesInserted, this, &Subtitle::onLineRangesInserted);
+	connect(this, &Subtitle::lineRangesRemoved, this, &Subtitle::onLineRangesRemoved);
+	connect(this, &Subtitle::linesReordered, this, &Subtitle::onLinesReordered);
+}
 
 Subtitle::~Subtitle()
 {
@@ -62,51 +84,124 @@ Subtitle::~Subtitle()
 	delete m_formatData;
 }
 
+void
+Subtitle::setUndoStack(QUndoStack *undoStack)
+{
+	if(m_undoStack)
+		disconnect(m_undoStack, &QUndoStack::indexChanged, this, &Subtitle::onUndoStackIndexChanged);
+
+	m_undoStack = undoStack;
+
+	if(m_undoStack)
+		connect(m_undoStack, &QUndoStack::indexChanged, this, &Subtitle::onUndoStackIndexChanged);
+}
+
+static qint64
+commandMemoryUsage(const QUndoCommand *command)
+{
+	// composite actions are plain QUndoCommands holding the actions as children
+	const UndoAction *action = dynamic_cast<const UndoAction *>(command);
+	qint64 bytes = action ? action->memoryUsage() : qint64(sizeof(QUndoCommand));
+	for(int i = 0, n = command->childCount(); i < n; i++)
+		bytes += commandMemoryUsage(command->child(i));
+	return bytes;
+}
+
+void
+Subtitle::reportMemoryUsage(MemoryUsage::Report &report) const
+{
+	qint64 lineBytes = m_lines.capacity() * sizeof(ObjectRef<SubtitleLine>);
+	qint64 textBytes = 0;
+	qint64 styleBytes = 0;
+	for(const SubtitleLine *line : SubtitleLinesView(*this)) {
+		lineBytes += sizeof(SubtitleLine);
+		if(line->m_formatData)
+			lineBytes += line->m_formatData->memoryUsage();
+		textBytes += (line->m_primaryText.capacity() + line->m_secondaryText.capacity()) * sizeof(QChar);
+		styleBytes += line->m_primaryText.styleMemoryUsage() + line->m_secondaryText.styleMemoryUsage();
+	}
+	report[QStringLiteral("subtitle lines")] += lineBytes;
+	report[QStringLiteral("subtitle texts")] += textBytes;
+	report[QStringLiteral("subtitle styles")] += styleBytes;
+
+	qint64 indexBytes = m_timeIndex.memoryUsage() + m_anchoredLines.capacity() * sizeof(void *);
+	for(int i = 0; i < SubtitleLine::ErrorSIZE; i++)
+		indexBytes += m_errorLines[i].capacity() * sizeof(int);
+	report[QStringLiteral("subtitle indexes")] += indexBytes;
+
+	if(m_undoStack) {
+		qint64 undoBytes = 0;
+		for(int i = 0, n = m_undoStack->count(); i < n; i++)
+			undoBytes += commandMemoryUsage(m_undoStack->command(i));
+		report[QStringLiteral("undo history")] += undoBytes;
+	}
+}
+
 void
 Subtitle::setPrimaryData(const Subtitle &from, bool usePrimaryData)
 {
+	QList<SubtitleLine *> lines;
+	lines.reserve(from.m_lines.size());
+	for(int i = 0, n = from.m_lines.size(); i < n; i++) {
+		const SubtitleLine *fromLine = from.m_lines.at(i).obj();
+		SubtitleLine *line = new SubtitleLine(*fromLine);
+		line->setFormatData(fromLine->formatData());
+		lines.append(line);
+	}
+
 	beginCompositeAction(i18n("Set Primary Data"));
 
 	setFormatData(from.m_formatData);
+	setFramesPerSecond(from.framesPerSecond());
+	replacePrimaryData(lines, usePrimaryData);
+
+	endCompositeAction();
+}
 
+void
+Subtitle::takePrimaryData(Subtitle &from, bool usePrimaryData)
+{
+	beginCompositeAction(i18n("Set Primary Data"));
+
+	setFormatData(from.m_formatData);
 	setFramesPerSecond(from.framesPerSecond());
+	replacePrimaryData(from.takeLines(), usePrimaryData);
 
-	SubtitleIterator fromIt(from, Range::full());
-	SubtitleIterator thisIt(*this, Range::full());
+	endCompositeAction();
+}
 
-	// the errors that we are going to take from 'from':
+void
+Subtitle::replacePrimaryData(const QList<SubtitleLine *> &lines, bool usePrimaryData)
+{
+	// the errors that we are going to take from the new lines
 	const int fromErrors = (usePrimaryData ? SubtitleLine::PrimaryOnlyErrors : SubtitleLine::SecondaryOnlyErrors) | SubtitleLine::SharedErrors;
-	// the errors that we are going to keep:
-	const int thisErrors = SubtitleLine::SecondaryOnlyErrors;
-
-	for(SubtitleLine *fromLine = fromIt.current(), *thisLine = thisIt.current(); fromLine && thisLine; ++fromIt, ++thisIt, fromLine = fromIt.current(), thisLine = thisIt.current()) {
-		thisLine->setPrimaryText(usePrimaryData ? fromLine->primaryText() : fromLine->secondaryText());
-		thisLine->setTimes(fromLine->showTime(), fromLine->hideTime());
-		thisLine->setErrorFlags((fromLine->errorFlags() & fromErrors) | (thisLine->errorFlags() & thisErrors));
-		thisLine->setFormatData(fromLine->formatData());
-	}
-
-	if(fromIt.current()) {          // 'from' had more lines than '*this'
-		QList<SubtitleLine *> lines;
-		for(; fromIt.current(); ++fromIt) {
-			SubtitleLine *thisLine = new SubtitleLine(*fromIt.current());
-			if(!usePrimaryData)
-				thisLine->setPrimaryText(thisLine->secondaryText());
-			thisLine->setSecondaryText(SString());
-			thisLine->setErrorFlags(SubtitleLine::SecondaryOnlyErrors, false);
-			thisLine->setFormatData(fromIt.current()->formatData());
-			lines.append(thisLine);
-		}
-		processAction(new InsertLinesAction(*this, lines));
-	} else if(thisIt.current()) {   // '*this'  had more lines than 'from'
-		for(SubtitleLine *thisLine = thisIt.current(); thisLine; ++thisIt, thisLine = thisIt.current()) {
-			thisLine->setPrimaryText(SString());
-			thisLine->setErrorFlags(SubtitleLine::PrimaryOnlyErrors, false);
-			thisLine->setFormatData(0);
-		}
+
+	foreach(SubtitleLine *line, lines) {
+		if(!usePrimaryData)
+			qSwap(line->m_primaryText, line->m_secondaryText);
+		line->m_secondaryText = SString();
+		line->m_errorFlags &= fromErrors & ~SubtitleLine::SecondaryOnlyErrors;
 	}
 
-	endCompositeAction();
+	// the existing lines swap their primary data with the new ones in one undoable pass,
+	// lines that '*this' has in excess get their primary text and errors cleared
+	const int commonCount = qMin(m_lines.size(), lines.size());
+	QList<SubtitleLine *> dataLines = lines.mid(0, commonCount);
+	for(int i = commonCount, n = m_lines.size(); i < n; i++) {
+		const SubtitleLine *line = m_lines.at(i).obj();
+		SubtitleLine *dataLine = new SubtitleLine(SString(), SString(), line->m_showTime, line->m_hideTime);
+		dataLine->m_errorFlags = line->m_errorFlags & SubtitleLine::SharedErrors;
+		dataLines.append(dataLine);
+	}
+	if(!dataLines.isEmpty()) {
+		processAction(new SwapLinesDataAction(*this, SubtitleLine::Primary, dataLines, i18n("Set Primary Data")));
+		// the new times can be in another order, the lines are moved when the composite action ends
+		m_showTimeSortPending = true;
+	}
+
+	// lines that 'from' had in excess are inserted as they are
+	if(lines.size() > commonCount)
+		processAction(new InsertLinesAction(*this, lines.mid(commonCount)));
 }
 
 void
@@ -114,9 +209,9 @@ Subtitle::clearPrimaryTextData()
 {
 	beginCompositeAction(i18n("Clear Primary Text Data"));
 
-	for(SubtitleIterator it(*this); it.current(); ++it) {
-		it.current()->setPrimaryText(SString());
-		it.current()->setErrorFlags(SubtitleLine::PrimaryOnlyErrors, false);
+	for(SubtitleLine *line : SubtitleLinesView(*this)) {
+		line->setPrimaryText(SString());
+		line->setErrorFlags(SubtitleLine::PrimaryOnlyErrors, false);
 	}
 
 	endCompositeAction();
@@ -125,40 +220,51 @@ Subtitle::clearPrimaryTextData()
 void
 Subtitle::setSecondaryData(const Subtitle &from, bool usePrimaryData)
 {
+	QList<SubtitleLine *> lines;
+	lines.reserve(from.m_lines.size());
+	for(int i = 0, n = from.m_lines.size(); i < n; i++)
+		lines.append(new SubtitleLine(*from.m_lines.at(i).obj()));
+
 	beginCompositeAction(i18n("Set Secondary Data"));
 
-	const int srcErrors = usePrimaryData ? SubtitleLine::PrimaryOnlyErrors : SubtitleLine::SecondaryOnlyErrors;
-	const int dstErrors = SubtitleLine::PrimaryOnlyErrors | SubtitleLine::SharedErrors;
+	replaceSecondaryData(lines, usePrimaryData);
 
-	for(int i = 0, n = m_lines.size(); i < n; i++) {
-		const SubtitleLine *srcLine = from.m_lines.at(i).obj();
-		SubtitleLine *dstLine = m_lines.at(i).obj();
-		dstLine->setSecondaryText(usePrimaryData ? srcLine->primaryText() : srcLine->secondaryText());
-		dstLine->setErrorFlags((dstLine->errorFlags() & dstErrors) | (srcLine->errorFlags() & srcErrors));
-	}
+	endCompositeAction();
+}
 
-	// clear remaining local translations
-	for(int i = from.m_lines.size(), n = m_lines.size(); i < n; i++) {
-		SubtitleLine *dstLine = m_lines.at(i).obj();
-		dstLine->setSecondaryText(SString());
-		dstLine->setErrorFlags(SubtitleLine::SecondaryOnlyErrors, false);
-	}
+void
+Subtitle::takeSecondaryData(Subtitle &from, bool usePrimaryData)
+{
+	beginCompositeAction(i18n("Set Secondary Data"));
+
+	replaceSecondaryData(from.takeLines(), usePrimaryData);
+
+	endCompositeAction();
+}
 
-	// insert remaining source translations
-	QList<SubtitleLine *> newLines;
-	for(int i = m_lines.size(), n = from.m_lines.size(); i < n; i++) {
-		const SubtitleLine *srcLine = from.m_lines.at(i).obj();
-		SubtitleLine *dstLine = new SubtitleLine(*srcLine);
+void
+Subtitle::replaceSecondaryData(const QList<SubtitleLine *> &lines, bool usePrimaryData)
+{
+	foreach(SubtitleLine *line, lines) {
 		if(usePrimaryData)
-			dstLine->setSecondaryText(dstLine->primaryText());
-		dstLine->setPrimaryText(SString());
-		dstLine->setErrorFlags(SubtitleLine::PrimaryOnlyErrors, false);
-		newLines.append(dstLine);
+			qSwap(line->m_primaryText, line->m_secondaryText);
+		line->m_primaryText = SString();
+		line->m_errorFlags &= usePrimaryData ? 0 : int(SubtitleLine::SecondaryOnlyErrors);
+		line->setFormatData(nullptr);
 	}
-	if(!newLines.isEmpty())
-		processAction(new InsertLinesAction(*this, newLines));
 
-	endCompositeAction();
+	// the existing lines swap their secondary data with the new ones in one undoable pass,
+	// lines that '*this' has in excess get their translations and secondary errors cleared
+	const int commonCount = qMin(m_lines.size(), lines.size());
+	QList<SubtitleLine *> dataLines = lines.mid(0, commonCount);
+	for(int i = commonCount, n = m_lines.size(); i < n; i++)
+		dataLines.append(new SubtitleLine());
+	if(!dataLines.isEmpty())
+		processAction(new SwapLinesDataAction(*this, SubtitleLine::Secondary, dataLines, i18n("Set Secondary Data")));
+
+	// lines that 'from' had in excess are inserted with an empty primary text
+	if(lines.size() > commonCount)
+		processAction(new InsertLinesAction(*this, lines.mid(commonCount)));
 }
 
 void
@@ -166,9 +272,9 @@ Subtitle::clearSecondaryTextData()
 {
 	beginCompositeAction(i18n("Clear Secondary Text Data"));
 
-	for(SubtitleIterator it(*this); it.current(); ++it) {
-		it.current()->setSecondaryText(SString());
-		it.current()->setErrorFlags(SubtitleLine::SecondaryOnlyErrors, false);
+	for(SubtitleLine *line : SubtitleLinesView(*this)) {
+		line->setSecondaryText(SString());
+		line->setErrorFlags(SubtitleLine::SecondaryOnlyErrors, false);
 	}
 
 	endCompositeAction();
@@ -234,6 +340,8 @@ Subtitle::setFramesPerSecond(double framesPerSecond)
 void
 Subtitle::changeFramesPerSecond(double toFramesPerSecond, double fromFramesPerSecond)
 {
+	PROFILE();
+
 	if(toFramesPerSecond <= 0)
 		return;
 
@@ -247,14 +355,14 @@ Subtitle::changeFramesPerSecond(double toFramesPerSecond, double fromFramesPerSe
 	double scaleFactor = fromFramesPerSecond / toFramesPerSecond;
 
 	if(scaleFactor != 1.0) {
-		for(SubtitleIterator it(*this, Range::full()); it.current(); ++it) {
-			Time showTime = it.current()->showTime();
+		for(SubtitleLine *line : SubtitleLinesView(*this)) {
+			Time showTime = line->showTime();
 			showTime.adjust(0, scaleFactor);
 
-			Time hideTime = it.current()->hideTime();
+			Time hideTime = line->hideTime();
 			hideTime.adjust(0, scaleFactor);
 
-			processAction(new SetLineTimesAction(*it, showTime, hideTime));
+			processAction(new SetLineTimesAction(*line, showTime, hideTime));
 		}
 	}
 
@@ -315,6 +423,185 @@ Subtitle::lastLine() const
 	return m_lines.isEmpty() ? 0 : m_lines.last().obj();
 }
 
+void
+Subtitle::invalidateTimeIndex()
+{
+	m_timeIndex.invalidate();
+}
+
+void
+Subtitle::onLinesInserted(int firstIndex, int lastIndex)
+{
+	// the line before now has a different next line to overlap with
+	markErrorsDirty(firstIndex - 1, firstIndex - 1);
+	insertAnchors(firstIndex, lastIndex);
+}
+
+void
+Subtitle::onLinesRemoved(int firstIndex)
+{
+	markErrorsDirty(firstIndex - 1, firstIndex - 1);
+	removeRemovedAnchors();
+}
+
+void
+Subtitle::onLineRangesInserted(const RangeList &ranges)
+{
+	for(RangeList::ConstIterator it = ranges.begin(), end = ranges.end(); it != end; ++it) {
+		markErrorsDirty((*it).start() - 1, (*it).start() - 1);
+		insertAnchors((*it).start(), (*it).end());
+	}
+}
+
+void
+Subtitle::onLineRangesRemoved(const RangeList &ranges)
+{
+	// ranges are indexes from before the removal
+	int removedCount = 0;
+	for(RangeList::ConstIterator it = ranges.begin(), end = ranges.end(); it != end; ++it) {
+		const int prevIndex = (*it).start() - removedCount - 1;
+		markErrorsDirty(prevIndex, prevIndex);
+		removedCount += (*it).length();
+	}
+	removeRemovedAnchors();
+}
+
+void
+Subtitle::onLinesReordered(int firstIndex, int lastIndex)
+{
+	markErrorsDirty(firstIndex - 1, lastIndex);
+}
+
+void
+Subtitle::markErrorsDirty(int firstIndex, int lastIndex)
+{
+	firstIndex = qMax(firstIndex, 0);
+	lastIndex = qMin(lastIndex, m_lines.size() - 1);
+	for(int i = firstIndex; i <= lastIndex; i++)
+		m_lines.at(i)->m_errorsDirty = true;
+}
+
+void
+Subtitle::updateErrorIndex(int firstIndex, int lastIndex)
+{
+	QVector<int> lines[SubtitleLine::ErrorSIZE];
+	for(int i = firstIndex; i <= lastIndex; i++) {
+		const int errorFlags = m_lines.at(i)->m_errorFlags;
+		for(int id = 0; id < SubtitleLine::ErrorSIZE; id++) {
+			if(errorFlags & (1 << id))
+				lines[id].append(i);
+		}
+	}
+
+	// replace the part of each index that covers [firstIndex, lastIndex]
+	for(int id = 0; id < SubtitleLine::ErrorSIZE; id++) {
+		QVector<int> &errorLines = m_errorLines[id];
+		const int pos = std::lower_bound(errorLines.cbegin(), errorLines.cend(), firstIndex) - errorLines.cbegin();
+		const int oldCount = std::upper_bound(errorLines.cbegin() + pos, errorLines.cend(), lastIndex) - errorLines.cbegin() - pos;
+		const int newCount = lines[id].size();
+		if(newCount > oldCount)
+			errorLines.insert(pos + oldCount, newCount - oldCount, 0);
+		else if(newCount < oldCount)
+			errorLines.remove(pos + newCount, oldCount - newCount);
+		if(newCount)
+			std::copy(lines[id].cbegin(), lines[id].cend(), errorLines.begin() + pos);
+	}
+}
+
+void
+Subtitle::insertErrorIndex(int firstIndex, int lastIndex)
+{
+	const int count = lastIndex - firstIndex + 1;
+	for(int id = 0; id < SubtitleLine::ErrorSIZE; id++) {
+		QVector<int> &errorLines = m_errorLines[id];
+		int *index = errorLines.data();
+		int *end = index + errorLines.size();
+		for(index = std::lower_bound(index, end, firstIndex); index != end; ++index)
+			*index += count;
+	}
+	updateErrorIndex(firstIndex, lastIndex);
+}
+
+void
+Subtitle::removeErrorIndex(int firstIndex, int lastIndex)
+{
+	const int count = lastIndex - firstIndex + 1;
+	for(int id = 0; id < SubtitleLine::ErrorSIZE; id++) {
+		QVector<int> &errorLines = m_errorLines[id];
+		const int pos = std::lower_bound(errorLines.cbegin(), errorLines.cend(), firstIndex) - errorLines.cbegin();
+		const int removed = std::upper_bound(errorLines.cbegin() + pos, errorLines.cend(), lastIndex) - errorLines.cbegin() - pos;
+		if(removed)
+			errorLines.remove(pos, removed);
+		for(int *index = errorLines.data() + pos, *end = errorLines.data() + errorLines.size(); index != end; ++index)
+			*index -= count;
+	}
+}
+
+int
+Subtitle::errorCount(SubtitleLine::ErrorID errorId) const
+{
+	return m_errorLines[errorId].size();
+}
+
+int
+Subtitle::errorLinesCount(int errorFlags) const
+{
+	// a line having several of the errors is counted once
+	QVector<int> lines;
+	for(int id = 0; id < SubtitleLine::ErrorSIZE; id++) {
+		const QVector<int> &errorLines = m_errorLines[id];
+		if(!(errorFlags & (1 << id)) || errorLines.isEmpty())
+			continue;
+		QVector<int> united;
+		united.reserve(lines.size() + errorLines.size());
+		std::set_union(lines.cbegin(), lines.cend(), errorLines.cbegin(), errorLines.cend(), std::back_inserter(united));
+		lines.swap(united);
+	}
+	return lines.size();
+}
+
+int
+Subtitle::nextErrorLine(int fromIndex, int errorFlags) const
+{
+	int nextIndex = -1;
+	for(int id = 0; id < SubtitleLine::ErrorSIZE; id++) {
+		if(!(errorFlags & (1 << id)))
+			continue;
+		const QVector<int> &errorLines = m_errorLines[id];
+		QVector<int>::ConstIterator it = std::lower_bound(errorLines.cbegin(), errorLines.cend(), fromIndex);
+		if(it != errorLines.cend() && (nextIndex == -1 || *it < nextIndex))
+			nextIndex = *it;
+	}
+	return nextIndex;
+}
+
+int
+Subtitle::previousErrorLine(int fromIndex, int errorFlags) const
+{
+	int prevIndex = -1;
+	for(int id = 0; id < SubtitleLine::ErrorSIZE; id++) {
+		if(!(errorFlags & (1 << id)))
+			continue;
+		const QVector<int> &errorLines = m_errorLines[id];
+		QVector<int>::ConstIterator it = std::upper_bound(errorLines.cbegin(), errorLines.cend(), fromIndex);
+		if(it != errorLines.cbegin() && *(it - 1) > prevIndex)
+			prevIndex = *(it - 1);
+	}
+	return prevIndex;
+}
+
+QList<SubtitleLine *>
+Subtitle::linesInTimeRange(const Time &startTime, const Time &endTime)
+{
+	return m_timeIndex.linesInRange(startTime.toMillis(), endTime.toMillis());
+}
+
+SubtitleLine *
+Subtitle::firstLineHiddenAfter(const Time &time)
+{
+	return m_timeIndex.firstLineHiddenAfter(time.toMillis());
+}
+
 bool
 Subtitle::hasAnchors() const
 {
@@ -333,10 +620,7 @@ Subtitle::isLineAnchored(int index) const
 bool
 Subtitle::isLineAnchored(const SubtitleLine *line) const
 {
-	if(!line)
-		return false;
-
-	return m_anchoredLines.indexOf(line) != -1;
+	return line && line->m_anchored;
 }
 
 void
@@ -354,25 +638,77 @@ Subtitle::toggleLineAnchor(const SubtitleLine *line)
 	if(!line)
 		return;
 
-	int anchorIndex = m_anchoredLines.indexOf(line);
+	line->m_anchored = !line->m_anchored;
 
-	if(anchorIndex == -1)
-		m_anchoredLines.append(line);
-	else
-		m_anchoredLines.removeAt(anchorIndex);
+	if(line->m_anchored) {
+		const auto it = std::upper_bound(m_anchoredLines.begin(), m_anchoredLines.end(), line->m_showTime,
+			[](const Time &showTime, const SubtitleLine *anchor){ return showTime < anchor->m_showTime; });
+		m_anchoredLines.insert(it, line);
+	} else {
+		const int index = anchorIndex(line);
+		if(index >= 0)
+			m_anchoredLines.remove(index);
+	}
 
-	emit lineAnchorChanged(line, anchorIndex == -1);
+	emit lineAnchorChanged(line, line->m_anchored);
 }
 
 void
 Subtitle::removeAllAnchors()
 {
-	QList<const SubtitleLine *> anchoredLines = m_anchoredLines;
+	QVector<const SubtitleLine *> anchoredLines;
+	anchoredLines.swap(m_anchoredLines);
 
-	m_anchoredLines.clear();
-
-	foreach(auto line, anchoredLines)
+	foreach(auto line, anchoredLines) {
+		line->m_anchored = false;
 		emit lineAnchorChanged(line, false);
+	}
+}
+
+int
+Subtitle::anchorIndex(const SubtitleLine *line) const
+{
+	// binary search for the first anchor shown at the same time, then look for the line itself
+	const int count = m_anchoredLines.size();
+	int index = std::lower_bound(m_anchoredLines.constBegin(), m_anchoredLines.constEnd(), line->m_showTime,
+		[](const SubtitleLine *anchor, const Time &showTime){ return anchor->m_showTime < showTime; }) - m_anchoredLines.constBegin();
+	for(; index < count && m_anchoredLines.at(index)->m_showTime == line->m_showTime; index++) {
+		if(m_anchoredLines.at(index) == line)
+			return index;
+	}
+
+	// anchors are resorted on time changes, fall back to a linear search if they are out of order anyway
+	return m_anchoredLines.indexOf(line);
+}
+
+void
+Subtitle::sortAnchoredLines()
+{
+	// times are written directly by actions and their undo, restore the order after every change
+	std::stable_sort(m_anchoredLines.begin(), m_anchoredLines.end(),
+		[](const SubtitleLine *a, const SubtitleLine *b){ return a->m_showTime < b->m_showTime; });
+}
+
+void
+Subtitle::insertAnchors(int firstIndex, int lastIndex)
+{
+	// lines keep their anchor while an undo action holds them, restore it when they come back
+	for(int i = firstIndex; i <= lastIndex; i++) {
+		const SubtitleLine *line = m_lines.at(i);
+		if(!line->m_anchored)
+			continue;
+		const auto it = std::upper_bound(m_anchoredLines.begin(), m_anchoredLines.end(), line->m_showTime,
+			[](const Time &showTime, const SubtitleLine *anchor){ return showTime < anchor->m_showTime; });
+		m_anchoredLines.insert(it, line);
+	}
+}
+
+void
+Subtitle::removeRemovedAnchors()
+{
+	// removed lines are no longer ours and can be deleted with the undo history
+	m_anchoredLines.erase(std::remove_if(m_anchoredLines.begin(), m_anchoredLines.end(),
+		[this](const SubtitleLine *anchor){ return anchor->m_subtitle != this; }), m_anchoredLines.end());
 }
 
 void
@@ -386,6 +722,8 @@ Subtitle::insertLine(SubtitleLine *line, int index)
 void
 Subtitle::insertLines(const QList<SubtitleLine *> &lines, int index)
 {
+	PROFILE();
+
 	Q_ASSERT(index <= m_lines.count());
 
 	if(index < 0)
@@ -469,6 +807,8 @@ Subtitle::insertNewLine(int index, bool insertAfter, TextTarget target)
 void
 Subtitle::removeLines(const RangeList &r, TextTarget target)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty())
 		return;
 
@@ -479,72 +819,75 @@ Subtitle::removeLines(const RangeList &r, TextTarget target)
 		return;
 
 	if(target == Both) {
-		beginCompositeAction(i18n("Remove Lines"));
-
-		RangeList::ConstIterator rangesIt = ranges.end(), begin = ranges.begin();
-		do {
-			rangesIt--;
-			processAction(new RemoveLinesAction(*this, (*rangesIt).start(), (*rangesIt).end()));
-		} while(rangesIt != begin);
-
-		endCompositeAction();
+		if(ranges.rangesCount() == 1)
+			processAction(new RemoveLinesAction(*this, ranges.firstIndex(), ranges.lastIndex()));
+		else
+			processAction(new RemoveLineRangesAction(*this, ranges));
 	} else if(target == Secondary) {
 		beginCompositeAction(i18n("Remove Lines"));
 
+		// we have to move the secondary texts up, the remaining lines secondary text must be cleared
+		const int firstIndex = ranges.firstIndex();
 		RangeList rangesComplement = ranges.complement();
-		rangesComplement.trimToRange(Range(ranges.firstIndex(), m_lines.count() - 1));
+		rangesComplement.trimToRange(Range(firstIndex, m_lines.count() - 1));
 
-		// we have to move the secondary texts up (we do it in chunks)
-		SubtitleIterator srcIt(*this, rangesComplement);
-		SubtitleIterator dstIt(*this, Range::upper(ranges.firstIndex()));
-		for(; srcIt.current() && dstIt.current(); ++srcIt, ++dstIt)
-			dstIt.current()->setSecondaryText(srcIt.current()->secondaryText());
+		QVector<SubtitleLine *> lines;
+		QVector<SString> texts;
+		lines.reserve(m_lines.count() - firstIndex);
+		texts.reserve(m_lines.count() - firstIndex);
+		for(const SubtitleLine *line : SubtitleLinesView(*this, rangesComplement))
+			texts.append(line->secondaryText());
+		for(int index = firstIndex, size = m_lines.count(); index < size; index++)
+			lines.append(at(index));
+		texts.resize(lines.size());
 
-		// the remaining lines secondary text must be cleared
-		for(; dstIt.current(); ++dstIt)
-			dstIt.current()->setSecondaryText(SString());
+		setLinesText(lines, SubtitleLine::Secondary, texts);
 
 		endCompositeAction();
 	} else { // target == Primary
 		beginCompositeAction(i18n("Remove Lines"));
 
-		RangeList mutableRanges(ranges);
-		mutableRanges.trimToIndex(m_lines.count() - 1);
-
 		// first, we need to append as many empty lines as we're to remove
 		// we insert them with a greater time than the one of the last (non deleted) line
 
-		int linesCount = m_lines.count();
+		const int linesCount = m_lines.count();
 
-		Range lastRange = mutableRanges.last();
+		Range lastRange = ranges.last();
 		int lastIndex = lastRange.end() == linesCount - 1 ? lastRange.start() - 1 : linesCount - 1;
-		SubtitleLine *lastLine = lastIndex < linesCount ? at(lastIndex) : 0;
+		SubtitleLine *lastLine = lastIndex >= 0 ? at(lastIndex) : 0;
 		Time showTime(lastLine ? lastLine->hideTime() + 100. : Time());
 		Time hideTime(showTime + 1000.);
 
-		QList<SubtitleLine *> lines;
+		QList<SubtitleLine *> newLines;
 		for(int index = 0, size = ranges.indexesCount(); index < size; ++index) {
-			lines.append(new SubtitleLine(SString(), SString(), showTime, hideTime));
+			newLines.append(new SubtitleLine(SString(), SString(), showTime, hideTime));
 			showTime.shift(1100.);
 			hideTime.shift(1100.);
 		}
 
-		processAction(new InsertLinesAction(*this, lines));
+		processAction(new InsertLinesAction(*this, newLines));
+
+		// then, we move the secondary texts down so they stay with the lines that are kept
+		const int firstIndex = ranges.firstIndex();
+		RangeList rangesComplement = ranges.complement();
+		rangesComplement.trimToRange(Range(firstIndex, m_lines.count() - 1));
 
-		// then, we move the secondary texts down (we need to iterate from bottom to top for that)
-		RangeList rangesComplement = mutableRanges.complement();
+		QVector<SubtitleLine *> lines;
+		QVector<SString> texts;
+		lines.reserve(linesCount - firstIndex);
+		texts.reserve(linesCount - firstIndex);
+		for(SubtitleLine *line : SubtitleLinesView(*this, rangesComplement))
+			lines.append(line);
+		for(int index = firstIndex; index < linesCount; index++)
+			texts.append(at(index)->secondaryText());
 
-		SubtitleIterator srcIt(*this, Range(ranges.firstIndex(), m_lines.count() - lines.count() - 1), true);
-		SubtitleIterator dstIt(*this, rangesComplement, true);
-		for(; srcIt.current() && dstIt.current(); --srcIt, --dstIt)
-			dstIt.current()->setSecondaryText(srcIt.current()->secondaryText());
+		setLinesText(lines, SubtitleLine::Secondary, texts);
 
 		// finally, we can remove the specified lines
-		RangeList::ConstIterator rangesIt = ranges.end(), begin = ranges.begin();
-		do {
-			rangesIt--;
-			processAction(new RemoveLinesAction(*this, (*rangesIt).start(), (*rangesIt).end()));
-		} while(rangesIt != begin);
+		if(ranges.rangesCount() == 1)
+			processAction(new RemoveLinesAction(*this, ranges.firstIndex(), ranges.lastIndex()));
+		else
+			processAction(new RemoveLineRangesAction(*this, ranges));
 
 		endCompositeAction();
 	}
@@ -559,6 +902,8 @@ Subtitle::swapTexts(const RangeList &ranges)
 void
 Subtitle::splitLines(const RangeList &ranges)
 {
+	PROFILE();
+
 	auto splitOnSpace = [&](SString &text){
 		int len = text.length();
 		int i = len / 2;
@@ -653,6 +998,8 @@ Subtitle::splitLines(const RangeList &ranges)
 void
 Subtitle::joinLines(const RangeList &ranges)
 {
+	PROFILE();
+
 	beginCompositeAction(i18n("Join Lines"));
 
 	RangeList obsoletedRanges;
@@ -669,12 +1016,12 @@ Subtitle::joinLines(const RangeList &ranges)
 
 		SString primaryText, secondaryText;
 
-		for(SubtitleIterator it(*this, Range(rangeStart, rangeEnd - 1)); it.current(); ++it) {
-			if(!it.current()->primaryText().isEmpty())
-				primaryText.append(it.current()->primaryText()).append(QChar::LineFeed);
+		for(const SubtitleLine *line : SubtitleLinesView(*this, Range(rangeStart, rangeEnd - 1))) {
+			if(!line->primaryText().isEmpty())
+				primaryText.append(line->primaryText()).append(QChar::LineFeed);
 
-			if(!it.current()->secondaryText().isEmpty())
-				secondaryText.append(it.current()->secondaryText()).append(QChar::LineFeed);
+			if(!line->secondaryText().isEmpty())
+				secondaryText.append(line->secondaryText()).append(QChar::LineFeed);
 		}
 
 		primaryText.append(lastLine->primaryText());
@@ -694,16 +1041,20 @@ Subtitle::joinLines(const RangeList &ranges)
 void
 Subtitle::shiftAnchoredLine(SubtitleLine *anchoredLine, const Time &newShowTime)
 {
-	if(m_anchoredLines.indexOf(anchoredLine) == -1 || m_lines.isEmpty())
+	if(!anchoredLine->m_anchored || m_lines.isEmpty())
 		return;
 
+	// closest anchors shown before and after this one
 	const SubtitleLine *prevAnchor = nullptr;
 	const SubtitleLine *nextAnchor = nullptr;
-	foreach(auto anchor, m_anchoredLines) {
-		if((prevAnchor == nullptr || prevAnchor->m_showTime < anchor->m_showTime) && anchor->m_showTime < anchoredLine->m_showTime)
-			prevAnchor = anchor;
-		if((nextAnchor == nullptr || nextAnchor->m_showTime > anchor->m_showTime) && anchor->m_showTime > anchoredLine->m_showTime)
-			nextAnchor = anchor;
+	const int index = anchorIndex(anchoredLine);
+	for(int i = index - 1; i >= 0 && !prevAnchor; i--) {
+		if(m_anchoredLines.at(i)->m_showTime < anchoredLine->m_showTime)
+			prevAnchor = m_anchoredLines.at(i);
+	}
+	for(int i = index + 1, n = m_anchoredLines.size(); i < n && !nextAnchor; i++) {
+		if(m_anchoredLines.at(i)->m_showTime > anchoredLine->m_showTime)
+			nextAnchor = m_anchoredLines.at(i);
 	}
 	if((prevAnchor && prevAnchor->m_showTime > newShowTime) || (nextAnchor && nextAnchor->m_showTime < newShowTime))
 		return;
@@ -741,6 +1092,7 @@ Subtitle::shiftAnchoredLine(SubtitleLine *anchoredLine, const Time &newShowTime)
 		if(newShowTime.toMillis() < lastShowTime && anchoredLine != last) {
 			anchoredLine->m_showTime = savedShowTime;
 			anchoredLine->m_hideTime = savedHideTime;
+			m_timeIndex.invalidate();
 			adjustLines(Range(anchoredLine->index(), last->index()), newShowTime.toMillis(), lastShowTime);
 		}
 	}
@@ -749,22 +1101,23 @@ Subtitle::shiftAnchoredLine(SubtitleLine *anchoredLine, const Time &newShowTime)
 void
 Subtitle::shiftLines(const RangeList &ranges, long msecs)
 {
+	PROFILE();
+
 	if(msecs == 0)
 		return;
 
 	beginCompositeAction(i18n("Shift Lines"));
 
 	if(!m_anchoredLines.empty()) {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it) {
-			SubtitleLine *line = it.current();
-			if(m_anchoredLines.indexOf(line) != -1) {
+		for(SubtitleLine *line : SubtitleLinesView(*this, ranges)) {
+			if(line->m_anchored) {
 				shiftAnchoredLine(line, line->showTime().shifted(msecs));
 				break;
 			}
 		}
 	} else {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->shiftTimes(msecs);
+		for(SubtitleLine *line : SubtitleLinesView(*this, ranges))
+			line->shiftTimes(msecs);
 	}
 
 	endCompositeAction();
@@ -773,6 +1126,8 @@ Subtitle::shiftLines(const RangeList &ranges, long msecs)
 void
 Subtitle::adjustLines(const Range &range, long newFirstTime, long newLastTime)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty() || newFirstTime >= newLastTime)
 		return;
 
@@ -810,8 +1165,8 @@ Subtitle::adjustLines(const Range &range, long newFirstTime, long newLastTime)
 
 	beginCompositeAction(i18n("Adjust Lines"));
 
-	for(SubtitleIterator it(*this, range); it.current(); ++it)
-		it.current()->adjustTimes(shiftMseconds, scaleFactor);
+	for(SubtitleLine *line : SubtitleLinesView(*this, range))
+		line->adjustTimes(shiftMseconds, scaleFactor);
 
 	endCompositeAction();
 }
@@ -819,36 +1174,38 @@ Subtitle::adjustLines(const Range &range, long newFirstTime, long newLastTime)
 void
 Subtitle::sortLines(const Range &range)
 {
-	beginCompositeAction(i18n("Sort"));
+	PROFILE();
 
-	SubtitleIterator it(*this, range);
-	SubtitleLine *line = it.current();
-	SubtitleLine *nextLine = (++it).current();
-	for(; nextLine; ++it, line = nextLine, nextLine = it.current()) {
-//		qDebug() << "sort: test" << nextLine->index();
-		if(line->showTime() < nextLine->showTime()) // already sorted
-			continue;
+	if(m_lines.isEmpty())
+		return;
 
-		SubtitleIterator tmp(it);
-		int fromIndex = tmp.index();
-		int toIndex = -1;
-		while((--tmp).current() && tmp.current()->showTime() > nextLine->showTime())
-			toIndex = tmp.index();
+	const int firstIndex = qMax(0, range.start());
+	const int count = qMin(range.end(), lastIndex()) - firstIndex + 1;
+	if(count < 2)
+		return;
 
-		Q_ASSERT(toIndex != -1);
+	QVector<int> permutation(count);
+	for(int i = 0, n = permutation.size(); i < n; i++)
+		permutation[i] = i;
 
-//		qDebug() << "sort: move" << fromIndex << "to" << toIndex;
-		processAction(new MoveLineAction(*this, fromIndex, toIndex));
+	const ObjectRef<SubtitleLine> *lines = m_lines.constData() + firstIndex;
+	std::stable_sort(permutation.begin(), permutation.end(), [lines](int a, int b){
+		return lines[a]->showTime() < lines[b]->showTime();
+	});
 
-		--it;
+	for(int i = 0, n = permutation.size(); i < n; i++) {
+		if(permutation.at(i) != i) {
+			processAction(new PermuteLinesAction(*this, firstIndex, permutation));
+			return;
+		}
 	}
-
-	endCompositeAction();
 }
 
 void
 Subtitle::applyDurationLimits(const RangeList &ranges, const Time &minDuration, const Time &maxDuration, bool canOverlap)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty() || minDuration > maxDuration)
 		return;
 
@@ -856,12 +1213,11 @@ Subtitle::applyDurationLimits(const RangeList &ranges, const Time &minDuration,
 
 	for(RangeList::ConstIterator rangesIt = ranges.begin(), end = ranges.end(); rangesIt != end; ++rangesIt) {
 		Time lineDuration;
-		SubtitleIterator it(*this, *rangesIt);
-		SubtitleLine *line = it.current();
-		++it;
-		SubtitleLine *nextLine = it.current();
+		const SubtitleLinesView rangeLines(*this, *rangesIt);
+		for(SubtitleLinesView::Iterator it = rangeLines.begin(), linesEnd = rangeLines.end(); it != linesEnd;) {
+			SubtitleLine *line = *it;
+			SubtitleLine *nextLine = ++it != linesEnd ? *it : nullptr;
 
-		for(; line; ++it, line = nextLine, nextLine = it.current()) {
 			lineDuration = line->durationTime();
 
 			if(lineDuration > maxDuration)
@@ -888,18 +1244,21 @@ Subtitle::applyDurationLimits(const RangeList &ranges, const Time &minDuration,
 void
 Subtitle::setMaximumDurations(const RangeList &ranges)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty())
 		return;
 
 	beginCompositeAction(i18n("Maximize Durations"));
 
 	for(RangeList::ConstIterator rangesIt = ranges.begin(), end = ranges.end(); rangesIt != end; ++rangesIt) {
-		SubtitleIterator it(*this, *rangesIt);
-		SubtitleLine *line = it.current();
-		++it;
-		SubtitleLine *nextLine = it.current();
+		const SubtitleLinesView rangeLines(*this, *rangesIt);
+		for(SubtitleLinesView::Iterator it = rangeLines.begin(), linesEnd = rangeLines.end(); it != linesEnd;) {
+			SubtitleLine *line = *it;
+			if(++it == linesEnd)
+				break;
+			SubtitleLine *nextLine = *it;
 
-		for(; line && nextLine; ++it, line = nextLine, nextLine = it.current()) {
 			if(line->hideTime() < nextLine->showTime())
 				line->setHideTime(nextLine->showTime() - 1);
 		}
@@ -911,6 +1270,8 @@ Subtitle::setMaximumDurations(const RangeList &ranges)
 void
 Subtitle::setAutoDurations(const RangeList &ranges, int msecsPerChar, int msecsPerWord, int msecsPerLine, bool canOverlap, TextTarget calculationTarget)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty())
 		return;
 
@@ -919,12 +1280,11 @@ Subtitle::setAutoDurations(const RangeList &ranges, int msecsPerChar, int msecsP
 	for(RangeList::ConstIterator rangesIt = ranges.begin(), end = ranges.end(); rangesIt != end; ++rangesIt) {
 		Time autoDuration;
 
-		SubtitleIterator it(*this, *rangesIt);
-		SubtitleLine *line = it.current();
-		++it;
-		SubtitleLine *nextLine = it.current();
+		const SubtitleLinesView rangeLines(*this, *rangesIt);
+		for(SubtitleLinesView::Iterator it = rangeLines.begin(), linesEnd = rangeLines.end(); it != linesEnd;) {
+			SubtitleLine *line = *it;
+			SubtitleLine *nextLine = ++it != linesEnd ? *it : nullptr;
 
-		for(; line; ++it, line = nextLine, nextLine = it.current()) {
 			autoDuration = line->autoDuration(msecsPerChar, msecsPerWord, msecsPerLine, (SubtitleLine::TextTarget)
 											  calculationTarget);
 
@@ -945,6 +1305,8 @@ Subtitle::setAutoDurations(const RangeList &ranges, int msecsPerChar, int msecsP
 void
 Subtitle::fixOverlappingLines(const RangeList &ranges, const Time &minInterval)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty())
 		return;
 
@@ -957,12 +1319,13 @@ Subtitle::fixOverlappingLines(const RangeList &ranges, const Time &minInterval)
 		if(rangeStart >= rangeEnd)
 			break;
 
-		SubtitleIterator it(*this, Range(rangeStart, rangeEnd));
-		SubtitleLine *line = it.current();
-		++it;
-		SubtitleLine *nextLine = it.current();
+		const SubtitleLinesView rangeLines(*this, Range(rangeStart, rangeEnd));
+		for(SubtitleLinesView::Iterator it = rangeLines.begin(), linesEnd = rangeLines.end(); it != linesEnd;) {
+			SubtitleLine *line = *it;
+			if(++it == linesEnd)
+				break;
+			SubtitleLine *nextLine = *it;
 
-		for(; nextLine; ++it, line = nextLine, nextLine = it.current()) {
 			if(line->hideTime() + minInterval >= nextLine->showTime()) {
 				Time newHideTime = nextLine->showTime() - minInterval;
 				line->setHideTime(newHideTime >= line->showTime() ? newHideTime : line->showTime());
@@ -973,81 +1336,130 @@ Subtitle::fixOverlappingLines(const RangeList &ranges, const Time &minInterval)
 	endCompositeAction();
 }
 
+static inline const SString &
+lineText(const SubtitleLine *line, bool primary)
+{
+	return primary ? line->primaryText() : line->secondaryText();
+}
+
+template<class Fn>
 void
-Subtitle::fixPunctuation(const RangeList &ranges, bool spaces, bool quotes, bool engI, bool ellipsis, TextTarget target)
+Subtitle::transformTexts(const RangeList &ranges, TextTarget target, Fn fn)
 {
-	if(m_lines.isEmpty() || (!spaces && !quotes && !engI && !ellipsis)
-	   || target >= TextTargetSIZE)
-		return;
+	QVector<SubtitleLine *> lines;
+	for(SubtitleLine *line : SubtitleLinesView(*this, ranges))
+		lines.append(line);
 
-	beginCompositeAction(i18n("Fix Lines Punctuation"));
+	for(int textTarget = Primary; textTarget <= Secondary; textTarget++) {
+		if(target != textTarget && target != Both)
+			continue;
 
-	for(RangeList::ConstIterator rangesIt = ranges.begin(), end = ranges.end(); rangesIt != end; ++rangesIt) {
-		SubtitleIterator it(*this, *rangesIt);
+		const bool primary = textTarget == Primary;
+		QVector<SString> texts(lines.size());
+		SString *newTexts = texts.data();
+		// fn runs on pool threads and must not share mutable state such as a static QRegExp
+		Parallel::forEach(lines.size(), [&](int i){
+			newTexts[i] = fn(lineText(lines.at(i), primary));
+		});
+
+		setLinesText(lines, SubtitleLine::TextTarget(textTarget), texts);
+	}
+}
+
+template<class Fn>
+void
+Subtitle::scanTexts(const RangeList &ranges, TextTarget target, Fn fn)
+{
+	// each range is a segment whose state is initialized from the line before it
+	QVector<SubtitleLine *> lines;
+	QVector<QPair<int, const SubtitleLine *>> segments;
+	for(RangeList::ConstIterator rangesIt = ranges.begin(), rangesEnd = ranges.end(); rangesIt != rangesEnd; ++rangesIt) {
+		const SubtitleLinesView rangeLines(*this, *rangesIt);
+		if(rangeLines.isEmpty())
+			continue;
+		const int firstIndex = rangeLines.begin().index();
+		segments.append(qMakePair(lines.size(), firstIndex > 0 ? at(firstIndex - 1) : nullptr));
+		for(SubtitleLine *line : rangeLines)
+			lines.append(line);
+	}
 
-		bool primaryContinues = false;
-		bool secondaryContinues = false;
+	for(int textTarget = Primary; textTarget <= Secondary; textTarget++) {
+		if(target != textTarget && target != Both)
+			continue;
 
-		if(it.index() > 0) {
-			if(target == Primary || target == Both)
-				// Initialize the value of primaryContinues
-				SubtitleLine::fixPunctuation(at(it.index() - 1)->primaryText(), spaces, quotes, engI, ellipsis, &primaryContinues);
+		const bool primary = textTarget == Primary;
 
-			if(target == Secondary || target == Both)
-				// Initialize the value of secondaryContinues
-				SubtitleLine::fixPunctuation(at(it.index() - 1)->secondaryText(), spaces, quotes, engI, ellipsis, &secondaryContinues);
+		QVector<char> segmentStates(lines.size(), -1);
+		for(int i = 0, n = segments.size(); i < n; i++) {
+			bool cont = false;
+			if(segments.at(i).second)
+				fn(lineText(segments.at(i).second, primary), &cont);
+			segmentStates[segments.at(i).first] = cont;
 		}
+		const char *segmentState = segmentStates.constData();
+
+		QVector<SString> texts(lines.size());
+		Parallel::orderedScan(lines.size(), texts.data(),
+			[&](int i, bool *cont){ return fn(lineText(lines.at(i), primary), cont); },
+			[&](int i, bool *cont){
+				if(segmentState[i] < 0)
+					return false;
+				*cont = segmentState[i];
+				return true;
+			});
+
+		setLinesText(lines, SubtitleLine::TextTarget(textTarget), texts);
+	}
+}
 
-		for(; it.current(); ++it) {
-			switch(target) {
-			case Primary:
-				it.current()->setPrimaryText(SubtitleLine::fixPunctuation(it.current()->primaryText(), spaces, quotes, engI, ellipsis, &primaryContinues)
-											 );
-				break;
-			case Secondary:
-				it.current()->setSecondaryText(SubtitleLine::fixPunctuation(it.current()->secondaryText(), spaces, quotes, engI, ellipsis, &secondaryContinues)
-											   );
-				break;
-			case Both:
-				it.current()->setTexts(SubtitleLine::fixPunctuation(it.current()->primaryText(), spaces, quotes, engI, ellipsis, &primaryContinues), SubtitleLine::fixPunctuation(it.current()->secondaryText(), spaces, quotes, engI, ellipsis, &secondaryContinues)
-									   );
-				break;
-			default:
-				break;
-			}
+void
+Subtitle::setLinesText(const QVector<SubtitleLine *> &lines, SubtitleLine::TextTarget target, const QVector<SString> &texts)
+{
+	const bool primary = target == SubtitleLine::Primary;
+
+	// only the lines that really change go into the undo action
+	QVector<SubtitleLine *> changedLines;
+	QVector<SString> changedTexts;
+	for(int i = 0, n = lines.size(); i < n; i++) {
+		if(lineText(lines.at(i), primary) != texts.at(i)) {
+			changedLines.append(lines.at(i));
+			changedTexts.append(texts.at(i));
 		}
 	}
 
+	if(!changedLines.isEmpty())
+		processAction(new SetLinesTextAction(*this, target, changedLines, changedTexts, primary ? i18n("Set Lines Text") : i18n("Set Lines Secondary Text")));
+}
+
+void
+Subtitle::fixPunctuation(const RangeList &ranges, bool spaces, bool quotes, bool engI, bool ellipsis, TextTarget target)
+{
+	PROFILE();
+
+	if(m_lines.isEmpty() || (!spaces && !quotes && !engI && !ellipsis)
+	   || target >= TextTargetSIZE)
+		return;
+
+	beginCompositeAction(i18n("Fix Lines Punctuation"));
+
+	scanTexts(ranges, target, [=](const SString &text, bool *cont){
+		return SubtitleLine::fixPunctuation(text, spaces, quotes, engI, ellipsis, cont);
+	});
+
 	endCompositeAction();
 }
 
 void
 Subtitle::lowerCase(const RangeList &ranges, TextTarget target)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty() || target >= TextTargetSIZE)
 		return;
 
 	beginCompositeAction(i18n("Lower Case"));
 
-	switch(target) {
-	case Primary: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setPrimaryText(it.current()->primaryText().toLower());
-		break;
-	}
-	case Secondary: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setSecondaryText(it.current()->secondaryText().toLower());
-		break;
-	}
-	case Both: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setTexts(it.current()->primaryText().toLower(), it.current()->secondaryText().toLower());
-		break;
-	}
-	default:
-		break;
-	}
+	transformTexts(ranges, target, [](const SString &text){ return text.toLower(); });
 
 	endCompositeAction();
 }
@@ -1055,30 +1467,14 @@ Subtitle::lowerCase(const RangeList &ranges, TextTarget target)
 void
 Subtitle::upperCase(const RangeList &ranges, TextTarget target)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty() || target >= TextTargetSIZE)
 		return;
 
 	beginCompositeAction(i18n("Upper Case"));
 
-	switch(target) {
-	case Primary: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setPrimaryText(it.current()->primaryText().toUpper());
-		break;
-	}
-	case Secondary: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setSecondaryText(it.current()->secondaryText().toUpper());
-		break;
-	}
-	case Both: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setTexts(it.current()->primaryText().toUpper(), it.current()->secondaryText().toUpper());
-		break;
-	}
-	default:
-		break;
-	}
+	transformTexts(ranges, target, [](const SString &text){ return text.toUpper(); });
 
 	endCompositeAction();
 }
@@ -1086,31 +1482,14 @@ Subtitle::upperCase(const RangeList &ranges, TextTarget target)
 void
 Subtitle::titleCase(const RangeList &ranges, bool lowerFirst, TextTarget target)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty() || target >= TextTargetSIZE)
 		return;
 
 	beginCompositeAction(i18n("Title Case"));
 
-	switch(target) {
-	case Primary: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setPrimaryText(it.current()->primaryText().toTitleCase(lowerFirst));
-		break;
-	}
-	case Secondary: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setSecondaryText(it.current()->secondaryText().toTitleCase(lowerFirst));
-		break;
-	}
-	case Both: {
-		for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-			it.current()->setTexts(it.current()->primaryText().toTitleCase(lowerFirst), it.current()->secondaryText().toTitleCase(lowerFirst)
-								   );
-		break;
-	}
-	default:
-		break;
-	}
+	transformTexts(ranges, target, [=](const SString &text){ return text.toTitleCase(lowerFirst); });
 
 	endCompositeAction();
 }
@@ -1118,45 +1497,14 @@ Subtitle::titleCase(const RangeList &ranges, bool lowerFirst, TextTarget target)
 void
 Subtitle::sentenceCase(const RangeList &ranges, bool lowerFirst, TextTarget target)
 {
+	PROFILE();
+
 	if(m_lines.isEmpty() || target >= TextTargetSIZE)
 		return;
 
 	beginCompositeAction(i18n("Sentence Case"));
 
-	for(RangeList::ConstIterator rangesIt = ranges.begin(), rangesEnd = ranges.end(); rangesIt != rangesEnd; ++rangesIt) {
-		SubtitleIterator it(*this, *rangesIt);
-
-		bool pCont = false;
-		bool sCont = false;
-
-		if(it.index() > 0) {
-			if(target == Primary || target == Both) // Initialize pCont
-				at(it.index() - 1)->primaryText().toSentenceCase(lowerFirst, &pCont);
-			if(target == Secondary || target == Both) // Initialize sCont
-				at(it.index() - 1)->secondaryText().toSentenceCase(lowerFirst, &sCont);
-		}
-
-		switch(target) {
-		case Primary: {
-			for(; it.current(); ++it)
-				it.current()->setPrimaryText(it.current()->primaryText().toSentenceCase(lowerFirst, &pCont));
-			break;
-		}
-		case Secondary: {
-			for(; it.current(); ++it)
-				it.current()->setSecondaryText(it.current()->secondaryText().toSentenceCase(lowerFirst, &sCont));
-			break;
-		}
-		case Both: {
-			for(; it.current(); ++it)
-				it.current()->setTexts(it.current()->primaryText().toSentenceCase(lowerFirst, &pCont), it.current()->secondaryText().toSentenceCase(lowerFirst, &sCont)
-									   );
-			break;
-		}
-		default:
-			break;
-		}
-	}
+	scanTexts(ranges, target, [=](const SString &text, bool *cont){ return text.toSentenceCase(lowerFirst, cont); });
 
 	endCompositeAction();
 }
@@ -1164,37 +1512,42 @@ Subtitle::sentenceCase(const RangeList &ranges, bool lowerFirst, TextTarget targ
 void
 Subtitle::breakLines(const RangeList &ranges, unsigned minLengthForLineBreak, TextTarget target)
 {
+	PROFILE();
+
 	SubtitleCompositeActionExecutor executor(*this, i18n("Break Lines"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-		it.current()->breakText(minLengthForLineBreak, (SubtitleLine::TextTarget)target);
+	transformTexts(ranges, target, [=](const SString &text){ return SubtitleLine::breakText(text, minLengthForLineBreak); });
 }
 
 void
 Subtitle::unbreakTexts(const RangeList &ranges, TextTarget target)
 {
+	PROFILE();
+
 	SubtitleCompositeActionExecutor executor(*this, i18n("Unbreak Lines"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-		it.current()->unbreakText((SubtitleLine::TextTarget)target);
+	transformTexts(ranges, target, [](const SString &text){ return SString(text).replace('\n', ' '); });
 }
 
 void
 Subtitle::simplifyTextWhiteSpace(const RangeList &ranges, TextTarget target)
 {
+	PROFILE();
+
 	SubtitleCompositeActionExecutor executor(*this, i18n("Simplify Spaces"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-		it.current()->simplifyTextWhiteSpace((SubtitleLine::TextTarget)target);
+	transformTexts(ranges, target, [](const SString &text){ return SubtitleLine::simplifyTextWhiteSpace(text); });
 }
 
 void
 Subtitle::syncWithSubtitle(const Subtitle &refSubtitle)
 {
+	PROFILE();
+
 	beginCompositeAction(i18n("Synchronize Subtitles"));
 
-	for(SubtitleIterator it(*this, Range::full()), refIt(refSubtitle, Range::full()); it.current() && refIt.current(); ++it, ++refIt)
-		it.current()->setTimes(refIt.current()->showTime(), refIt.current()->hideTime());
+	for(int i = 0, n = qMin(count(), refSubtitle.count()); i < n; i++)
+		at(i)->setTimes(refSubtitle.at(i)->showTime(), refSubtitle.at(i)->hideTime());
 
 	endCompositeAction();
 }
@@ -1202,12 +1555,14 @@ Subtitle::syncWithSubtitle(const Subtitle &refSubtitle)
 void
 Subtitle::appendSubtitle(const Subtitle &srcSubtitle, long shiftMsecsBeforeAppend)
 {
+	PROFILE();
+
 	if(!srcSubtitle.count())
 		return;
 
 	QList<SubtitleLine *> lines;
-	for(SubtitleIterator it(srcSubtitle); it.current(); ++it) {
-		SubtitleLine *newLine = new SubtitleLine(*(it.current()));
+	for(const SubtitleLine *srcLine : SubtitleLinesView(srcSubtitle)) {
+		SubtitleLine *newLine = new SubtitleLine(*srcLine);
 		newLine->shiftTimes(shiftMsecsBeforeAppend);
 		lines.append(newLine);
 	}
@@ -1222,6 +1577,8 @@ Subtitle::appendSubtitle(const Subtitle &srcSubtitle, long shiftMsecsBeforeAppen
 void
 Subtitle::splitSubtitle(Subtitle &dstSubtitle, const Time &splitTime, bool shiftSplitLines)
 {
+	PROFILE();
+
 	if(!m_lines.count())
 		return;
 
@@ -1229,20 +1586,21 @@ Subtitle::splitSubtitle(Subtitle &dstSubtitle, const Time &splitTime, bool shift
 	bool splitsLine = false;        // splitTime falls in within a line's time
 
 	QList<SubtitleLine *> lines;
-	for(SubtitleIterator it(*this, Range::full()); it.current(); ++it) {
-		if(splitTime <= it.current()->hideTime()) {
-			SubtitleLine *newLine = new SubtitleLine(*(it.current()));
+	for(int index = 0, size = m_lines.count(); index < size; index++) {
+		const SubtitleLine *line = at(index);
+		if(splitTime <= line->hideTime()) {
+			SubtitleLine *newLine = new SubtitleLine(*line);
 
 			if(splitIndex < 0) {    // the first line of the new subtitle
-				splitIndex = it.index();
+				splitIndex = index;
 				splitsLine = splitTime > newLine->showTime();
 
 				if(splitsLine)
 					newLine->setShowTime(splitTime);
 			}
 
-			if(it.current()->m_formatData)
-				newLine->m_formatData = new FormatData(*(it.current()->m_formatData));
+			if(line->m_formatData)
+				newLine->m_formatData = new FormatData(*(line->m_formatData));
 
 			if(shiftSplitLines)
 				newLine->shiftTimes(-splitTime.toMillis());
@@ -1277,11 +1635,9 @@ Subtitle::setStyleFlags(const RangeList &ranges, int styleFlags)
 {
 	beginCompositeAction(i18n("Set Lines Style"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it) {
-		qDebug() << it.current()->primaryText().string();
-
-		it.current()->setPrimaryText(SString(it.current()->primaryText()).setStyleFlags(0, -1, styleFlags));
-		it.current()->setSecondaryText(SString(it.current()->secondaryText()).setStyleFlags(0, -1, styleFlags));
+	for(SubtitleLine *line : SubtitleLinesView(*this, ranges)) {
+		line->setPrimaryText(SString(line->primaryText()).setStyleFlags(0, -1, styleFlags));
+		line->setSecondaryText(SString(line->secondaryText()).setStyleFlags(0, -1, styleFlags));
 	}
 
 	endCompositeAction();
@@ -1292,9 +1648,9 @@ Subtitle::setStyleFlags(const RangeList &ranges, int styleFlags, bool on)
 {
 	beginCompositeAction(i18n("Set Lines Style"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it) {
-		it.current()->setPrimaryText(SString(it.current()->primaryText()).setStyleFlags(0, -1, styleFlags, on));
-		it.current()->setSecondaryText(SString(it.current()->secondaryText()).setStyleFlags(0, -1, styleFlags, on));
+	for(SubtitleLine *line : SubtitleLinesView(*this, ranges)) {
+		line->setPrimaryText(SString(line->primaryText()).setStyleFlags(0, -1, styleFlags, on));
+		line->setSecondaryText(SString(line->secondaryText()).setStyleFlags(0, -1, styleFlags, on));
 	}
 
 	endCompositeAction();
@@ -1303,13 +1659,14 @@ Subtitle::setStyleFlags(const RangeList &ranges, int styleFlags, bool on)
 void
 Subtitle::toggleStyleFlag(const RangeList &ranges, SString::StyleFlag styleFlag)
 {
-	SubtitleIterator it(*this, ranges);
-	if(!it.current())
+	const SubtitleLinesView lines(*this, ranges);
+	if(lines.isEmpty())
 		return;
 
 	beginCompositeAction(i18n("Toggle Lines Style"));
 
-	bool isOn = it.current()->primaryText().hasStyleFlags(styleFlag) || it.current()->secondaryText().hasStyleFlags(styleFlag);
+	const SubtitleLine *line = lines.first();
+	bool isOn = line->primaryText().hasStyleFlags(styleFlag) || line->secondaryText().hasStyleFlags(styleFlag);
 
 	setStyleFlags(ranges, styleFlag, !isOn);
 
@@ -1321,9 +1678,9 @@ Subtitle::changeTextColor(const RangeList &ranges, QRgb color)
 {
 	beginCompositeAction(i18n("Change Lines Text Color"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it) {
-		it.current()->setPrimaryText(SString(it.current()->primaryText()).setStyleColor(0, -1, color));
-		it.current()->setSecondaryText(SString(it.current()->secondaryText()).setStyleColor(0, -1, color));
+	for(SubtitleLine *line : SubtitleLinesView(*this, ranges)) {
+		line->setPrimaryText(SString(line->primaryText()).setStyleColor(0, -1, color));
+		line->setSecondaryText(SString(line->secondaryText()).setStyleColor(0, -1, color));
 	}
 
 	endCompositeAction();
@@ -1334,8 +1691,8 @@ Subtitle::setMarked(const RangeList &ranges, bool value)
 {
 	beginCompositeAction(value ? i18n("Set Lines Mark") : i18n("Clear Lines Mark"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-		it.current()->setErrorFlags(SubtitleLine::UserMark, value);
+	for(SubtitleLine *line : SubtitleLinesView(*this, ranges))
+		line->setErrorFlags(SubtitleLine::UserMark, value);
 
 	endCompositeAction();
 }
@@ -1343,13 +1700,13 @@ Subtitle::setMarked(const RangeList &ranges, bool value)
 void
 Subtitle::toggleMarked(const RangeList &ranges)
 {
-	SubtitleIterator it(*this, ranges);
-	if(!it.current())
+	const SubtitleLinesView lines(*this, ranges);
+	if(lines.isEmpty())
 		return;
 
 	beginCompositeAction(i18n("Toggle Lines Mark"));
 
-	setMarked(ranges, !(it.current()->errorFlags() & SubtitleLine::UserMark));
+	setMarked(ranges, !(lines.first()->errorFlags() & SubtitleLine::UserMark));
 
 	endCompositeAction();
 }
@@ -1359,8 +1716,8 @@ Subtitle::clearErrors(const RangeList &ranges, int errorFlags)
 {
 	beginCompositeAction(i18n("Clear Lines Errors"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it)
-		it.current()->setErrorFlags(errorFlags, false);
+	for(SubtitleLine *line : SubtitleLinesView(*this, ranges))
+		line->setErrorFlags(errorFlags, false);
 
 	endCompositeAction();
 }
@@ -1370,9 +1727,7 @@ Subtitle::checqCriticals(const RangeList &ranges, int errorFlags, int minDuratio
 {
 	beginCompositeAction(i18n("Check Lines Errors"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it) {
-		it.current()->check(errorFlags, minDurationMsecs, maxDurationMsecs, minMsecsPerChar, maxMsecsPerChar, maxChars, maxLines);
-	}
+	checkLinesErrors(ranges, errorFlags, QVector<int>() << minDurationMsecs << maxDurationMsecs << minMsecsPerChar << maxMsecsPerChar << maxChars << maxLines);
 
 	endCompositeAction();
 }
@@ -1382,34 +1737,370 @@ Subtitle::rechecqCriticals(const RangeList &ranges, int minDurationMsecs, int ma
 {
 	beginCompositeAction(i18n("Check Lines Errors"));
 
-	for(SubtitleIterator it(*this, ranges); it.current(); ++it) {
-		it.current()->check(it.current()->errorFlags(), minDurationMsecs, maxDurationMsecs, minMsecsPerChar, maxMsecsPerChar, maxChars, maxLines);
-	}
+	checkLinesErrors(ranges, -1, QVector<int>() << minDurationMsecs << maxDurationMsecs << minMsecsPerChar << maxMsecsPerChar << maxChars << maxLines);
 
 	endCompositeAction();
 }
 
+void
+Subtitle::checkLinesErrors(const RangeList &ranges, int errorFlags, const QVector<int> &settings)
+{
+	PROFILE();
+
+	if(m_lines.isEmpty() || ranges.isEmpty())
+		return;
+
+	// errorFlags < 0 rechecks the errors each line already has. If the lines were last
+	// rechecked with the same settings only the ones changed since then are revisited.
+	const bool recheck = errorFlags < 0;
+	const bool sameSettings = settings == m_errorCheckSettings;
+	const bool incremental = recheck && sameSettings;
+
+	QVector<SubtitleLine *> lines;
+	for(SubtitleLine *line : SubtitleLinesView(*this, ranges)) {
+		if(!incremental || line->m_errorsDirty)
+			lines.append(line);
+	}
+
+	// the checks only read the line and its next line
+	QVector<int> newErrorFlags(lines.size());
+	int *errorFlagsOut = newErrorFlags.data();
+	Parallel::forEach(lines.size(), [&](int i){
+		SubtitleLine *line = lines.at(i);
+		errorFlagsOut[i] = line->check(recheck ? line->m_errorFlags : errorFlags,
+			settings.at(0), settings.at(1), settings.at(2), settings.at(3), settings.at(4), settings.at(5), false);
+	});
+
+	const bool allLines = ranges.rangesCount() == 1 && ranges.firstIndex() <= 0 && ranges.lastIndex() >= lastIndex();
+	if(recheck && (sameSettings || allLines)) {
+		// every error these lines have now is up to date with settings
+		m_errorCheckSettings = settings;
+		foreach(SubtitleLine *line, lines)
+			line->m_errorsDirty = false;
+	} else if(!sameSettings) {
+		// errors checked with other settings must be revisited by the next recheck
+		foreach(SubtitleLine *line, lines)
+			line->m_errorsDirty = true;
+	}
+
+	QVector<SubtitleLine *> changedLines;
+	QVector<int> changedErrorFlags;
+	for(int i = 0, n = lines.size(); i < n; i++) {
+		if(lines.at(i)->m_errorFlags != newErrorFlags.at(i)) {
+			changedLines.append(lines.at(i));
+			changedErrorFlags.append(newErrorFlags.at(i));
+		}
+	}
+
+	if(!changedLines.isEmpty())
+		processAction(new SetLinesErrorsAction(*this, changedLines, changedErrorFlags));
+}
+
 void
 Subtitle::processAction(QUndoCommand *action)
 {
-	if(app()->subtitle() == this)
-		app()->undoStack()->push(action);
-	else
+	if(m_undoStack) {
+		m_undoStack->push(action);
+		PROFILE_COUNTER("undo stack size", m_undoStack->count());
+	} else {
 		action->redo();
+	}
 }
 
 void
 Subtitle::beginCompositeAction(const QString &title)
 {
-	if(app()->subtitle() == this)
-		app()->undoStack()->beginMacro(title);
+	m_compositeActionDepth++;
+
+	if(m_undoStack)
+		m_undoStack->beginMacro(title);
 }
 
 void
 Subtitle::endCompositeAction()
 {
-	if(app()->subtitle() == this)
-		app()->undoStack()->endMacro();
+	Q_ASSERT(m_compositeActionDepth > 0);
+
+	// changes made by the receivers (e.g. error tracker) still belong to this action
+	if(m_compositeActionDepth == 1) {
+		if(m_showTimeSortPending) {
+			m_showTimeSortPending = false;
+			moveLinesToShowTimePosition(m_changedLines[TimesChange]);
+		}
+		emitLineChanges();
+	}
+
+	m_compositeActionDepth--;
+
+	if(m_undoStack) {
+		m_undoStack->endMacro();
+		PROFILE_COUNTER("undo stack size", m_undoStack->count());
+	}
+}
+
+bool
+Subtitle::deferShowTimeSort()
+{
+	// line time setters run inside their own composite action - if there is an outer one
+	// the changed lines are moved at once when it ends
+	if(m_compositeActionDepth < 2)
+		return false;
+
+	m_showTimeSortPending = true;
+	return true;
+}
+
+void
+Subtitle::moveLinesToShowTimePosition(const RangeList &ranges)
+{
+	if(m_lines.isEmpty() || ranges.isEmpty())
+		return;
+
+	// like SubtitleLine::processShowTimeSort() each moved line only goes past its neighbours,
+	// other lines keep their order even if the subtitle isn't sorted
+	QVector<int> others;
+	QVector<QPair<int, int>> moved; // (slot in others, line index)
+	others.reserve(m_lines.size());
+	for(int index = 0, n = m_lines.size(); index < n; index++) {
+		if(!ranges.contains(index))
+			others.append(index);
+		else
+			moved.append(qMakePair(others.size(), index));
+	}
+
+	const auto showTime = [this](int index){ return m_lines.at(index)->m_showTime; };
+	for(QPair<int, int> &line : moved) {
+		const Time time = showTime(line.second);
+		int slot = line.first;
+		if(slot < others.size() && showTime(others.at(slot)) < time) {
+			// before the first line after this one that doesn't show earlier
+			slot = std::lower_bound(others.constBegin() + slot, others.constEnd(), time,
+				[&](int index, const Time &t){ return showTime(index) < t; }) - others.constBegin();
+		} else if(slot > 0 && showTime(others.at(slot - 1)) > time) {
+			// before the first line before this one that shows later
+			slot = std::upper_bound(others.constBegin(), others.constBegin() + slot, time,
+				[&](const Time &t, int index){ return t < showTime(index); }) - others.constBegin();
+		}
+		line.first = slot;
+	}
+	std::stable_sort(moved.begin(), moved.end(), [&](const QPair<int, int> &a, const QPair<int, int> &b){
+		return a.first < b.first || (a.first == b.first && showTime(a.second) < showTime(b.second));
+	});
+
+	QVector<int> permutation;
+	permutation.reserve(m_lines.size());
+	for(int slot = 0, i = 0, n = others.size(); slot <= n; slot++) {
+		for(; i < moved.size() && moved.at(i).first == slot; i++)
+			permutation.append(moved.at(i).second);
+		if(slot < n)
+			permutation.append(others.at(slot));
+	}
+
+	int firstIndex = 0;
+	int lastIndex = permutation.size() - 1;
+	while(firstIndex <= lastIndex && permutation.at(firstIndex) == firstIndex)
+		firstIndex++;
+	if(firstIndex > lastIndex)
+		return;
+	while(permutation.at(lastIndex) == lastIndex)
+		lastIndex--;
+
+	permutation = permutation.mid(firstIndex, lastIndex - firstIndex + 1);
+	for(int &index : permutation)
+		index -= firstIndex;
+	processAction(new PermuteLinesAction(*this, firstIndex, permutation));
+}
+
+void
+Subtitle::lineChanged(int index, LineChange change)
+{
+	beginUndoStackAction();
+
+	m_changedLines[change] << Range(index);
+
+	if(change == TimesChange && m_lines.at(index)->m_anchored)
+		sortAnchoredLines();
+
+	if(change != ErrorFlagsChange)
+		markErrorsDirty(change == TimesChange ? index - 1 : index, index);
+	else
+		updateErrorIndex(index, index);
+
+	// queries made while a composite action is running must see the new times
+	if(change == TimesChange)
+		m_timeIndex.updateLine(m_lines.at(index));
+
+	if(!m_compositeActionDepth)
+		emitLineChanges();
+}
+
+void
+Subtitle::linesChanged(const RangeList &ranges, int changes)
+{
+	if(m_lines.isEmpty())
+		return;
+
+	beginUndoStackAction();
+
+	RangeList changedRanges = ranges;
+	changedRanges.trimToIndex(lastIndex());
+
+	for(int i = 0; i < LineChangeSIZE; i++) {
+		if(changes & (1 << i))
+			m_changedLines[i] = m_changedLines[i].united(changedRanges);
+	}
+
+	if(changes & (1 << TimesChange) && !m_anchoredLines.empty())
+		sortAnchoredLines();
+
+	if(changes & ~(1 << ErrorFlagsChange)) {
+		const int prevLine = changes & (1 << TimesChange) ? 1 : 0;
+		for(RangeList::ConstIterator it = changedRanges.begin(), end = changedRanges.end(); it != end; ++it)
+			markErrorsDirty((*it).start() - prevLine, (*it).end());
+	}
+
+	if(changes & (1 << ErrorFlagsChange)) {
+		for(RangeList::ConstIterator it = changedRanges.begin(), end = changedRanges.end(); it != end; ++it)
+			updateErrorIndex((*it).start(), (*it).end());
+	}
+
+	if(changes & (1 << TimesChange))
+		m_timeIndex.invalidate();
+
+	if(!m_compositeActionDepth)
+		emitLineChanges();
+}
+
+int
+Subtitle::takeLineChanges(int index)
+{
+	int changes = 0;
+	for(int i = 0; i < LineChangeSIZE; i++) {
+		if(m_changedLines[i].contains(index))
+			changes |= 1 << i;
+	}
+	removeLineChanges(index, index);
+	return changes;
+}
+
+void
+Subtitle::insertLineChanges(int firstIndex, int lastIndex, int changes)
+{
+	for(int i = 0; i < LineChangeSIZE; i++) {
+		RangeList &changedLines = m_changedLines[i];
+		changedLines.shiftIndexesForwards(firstIndex, lastIndex - firstIndex + 1, false);
+		if(changes & (1 << i))
+			changedLines << Range(firstIndex, lastIndex);
+	}
+	insertErrorIndex(firstIndex, lastIndex);
+}
+
+void
+Subtitle::removeLineChanges(int firstIndex, int lastIndex)
+{
+	for(int i = 0; i < LineChangeSIZE; i++)
+		m_changedLines[i].shiftIndexesBackwards(firstIndex, lastIndex - firstIndex + 1);
+	removeErrorIndex(firstIndex, lastIndex);
+}
+
+void
+Subtitle::permuteLineChanges(int firstIndex, const QVector<int> &permutation)
+{
+	const int lastIndex = firstIndex + permutation.size() - 1;
+
+	updateErrorIndex(firstIndex, lastIndex);
+
+	for(int i = 0; i < LineChangeSIZE; i++) {
+		RangeList &changedLines = m_changedLines[i];
+		if(changedLines.isEmpty() || changedLines.intersected(Range(firstIndex, lastIndex)).isEmpty())
+			continue;
+
+		RangeList permuted;
+		for(int j = 0, n = permutation.size(); j < n; j++) {
+			if(changedLines.contains(firstIndex + permutation.at(j)))
+				permuted << Range(firstIndex + j);
+		}
+		changedLines = changedLines.intersected(RangeList(Range(firstIndex, lastIndex)).complement()).united(permuted);
+	}
+}
+
+QList<SubtitleLine *>
+Subtitle::takeLines()
+{
+	QList<SubtitleLine *> lines;
+	if(m_lines.isEmpty())
+		return lines;
+
+	// not undoable - meant for temporary subtitles that lines are read into
+	const int lastIndex = m_lines.size() - 1;
+	emit linesAboutToBeRemoved(0, lastIndex);
+
+	ObjectRef<SubtitleLine>::remove(m_lines, 0, m_lines.size(), &lines);
+	removeLineChanges(0, lastIndex);
+	foreach(SubtitleLine *line, lines)
+		line->m_subtitle = nullptr;
+
+	emit linesRemoved(0, lastIndex);
+
+	return lines;
+}
+
+void
+Subtitle::beginUndoStackAction()
+{
+	// QUndoStack undoes/redoes the actions of a composite action one by one without us knowing,
+	// collect their changes as one composite action that ends when the stack reports the new index
+	if(m_compositeActionDepth || !m_undoStack)
+		return;
+
+	m_undoStackActionOpen = true;
+	m_compositeActionDepth++;
+}
+
+void
+Subtitle::onUndoStackIndexChanged()
+{
+	if(!m_undoStackActionOpen)
+		return;
+
+	m_undoStackActionOpen = false;
+	if(m_showTimeSortPending) {
+		m_showTimeSortPending = false;
+		moveLinesToShowTimePosition(m_changedLines[TimesChange]);
+	}
+	emitLineChanges();
+	m_compositeActionDepth--;
+}
+
+void
+Subtitle::emitLineChanges()
+{
+	// receivers may change lines again, keep going until nothing is left
+	for(;;) {
+		int i = 0;
+		while(i < LineChangeSIZE && m_changedLines[i].isEmpty())
+			i++;
+		if(i == LineChangeSIZE)
+			break;
+
+		const RangeList ranges = m_changedLines[i];
+		m_changedLines[i].clear();
+
+		switch(i) {
+		case PrimaryTextChange:
+			emit linesPrimaryTextChanged(ranges);
+			break;
+		case SecondaryTextChange:
+			emit linesSecondaryTextChanged(ranges);
+			break;
+		case TimesChange:
+			emit linesTimesChanged(ranges);
+			break;
+		case ErrorFlagsChange:
+			emit linesErrorFlagsChanged(ranges);
+			break;
+		}
+	}
 }
 
 void
@@ -1432,9 +2123,11 @@ Subtitle::updateState()
 		emit secondaryChanged();
 	};
 
-	const QUndoStack *undoStack = app()->undoStack();
-	const int index = undoStack->index();
-	const UndoAction *action = index > 0 ? dynamic_cast<const UndoAction *>(undoStack->command(index - 1)) : nullptr;
+	if(!m_undoStack)
+		return;
+
+	const int index = m_undoStack->index();
+	const UndoAction *action = index > 0 ? dynamic_cast<const UndoAction *>(m_undoStack->command(index - 1)) : nullptr;
 	const UndoAction::DirtyMode dirtyMode = action != nullptr ? action->m_dirtyMode : SubtitleAction::Both;
 
 	switch(dirtyMode) {
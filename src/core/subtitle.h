@@ -25,14 +25,18 @@
 #include "core/rangelist.h"
 #include "core/time.h"
 #include "core/sstring.h"
+#include "core/subtitletimeindex.h"
 #include "subtitleline.h"
 #include "formatdata.h"
+#include "helpers/memoryusage.h"
 
 #include <QObject>
 #include <QString>
 #include <QStringList>
 #include <QList>
 
+QT_FORWARD_DECLARE_CLASS(QUndoStack)
+
 namespace SubtitleComposer {
 
 class Subtitle : public QObject
@@ -43,6 +47,7 @@ class Subtitle : public QObject
 
 	friend class SubtitleLine;
 	friend class SubtitleIterator;
+	friend class SubtitleLinesView;
 
 	friend class UndoAction;
 
@@ -50,7 +55,13 @@ class Subtitle : public QObject
 	friend class SetFramesPerSecondAction;
 	friend class InsertLinesAction;
 	friend class RemoveLinesAction;
+	friend class RemoveLineRangesAction;
 	friend class MoveLineAction;
+	friend class PermuteLinesAction;
+	friend class SwapLinesTextsAction;
+	friend class SetLinesTextAction;
+	friend class SwapLinesDataAction;
+	friend class SetLinesErrorsAction;
 
 	friend class SubtitleLineAction;
 	friend class SetLinePrimaryTextAction;
@@ -81,12 +92,22 @@ public:
 	Subtitle(double framesPerSecond = defaultFramesPerSecond());
 	virtual ~Subtitle();
 
+/// actions are pushed to undoStack, without one they are applied right away
+	void setUndoStack(QUndoStack *undoStack);
+
+/// adds bytes held by lines, texts, styles, indexes and undo history to report
+	void reportMemoryUsage(MemoryUsage::Report &report) const;
+
 /// primary data includes primary text, timing information, format data and all errors except secondary only errors
 	void setPrimaryData(const Subtitle &from, bool usePrimaryData);
+/// same as setPrimaryData() but adopts the lines of 'from' instead of copying them, 'from' is left empty
+	void takePrimaryData(Subtitle &from, bool usePrimaryData);
 	void clearPrimaryTextData();
 
 /// secondary data includes secondary text and secondary only errors
 	void setSecondaryData(const Subtitle &from, bool usePrimaryData);
+/// same as setSecondaryData() but adopts the lines of 'from' instead of copying them, 'from' is left empty
+	void takeSecondaryData(Subtitle &from, bool usePrimaryData);
 	void clearSecondaryTextData();
 
 	bool isPrimaryDirty() const;
@@ -118,7 +139,12 @@ public:
 
 //	inline const QVector<ObjectRef<SubtitleLine>> & allLines() const { return m_lines; }
 
-//	inline const QList<const SubtitleLine *> & anchoredLines() const { return m_anchoredLines; }
+//	inline const QVector<const SubtitleLine *> & anchoredLines() const { return m_anchoredLines; }
+
+/// lines whose [showTime, hideTime] overlap [startTime, endTime], sorted by show time
+	QList<SubtitleLine *> linesInTimeRange(const Time &startTime, const Time &endTime);
+/// first line (sorted by show time) with hideTime >= time
+	SubtitleLine * firstLineHiddenAfter(const Time &time);
 
 	bool hasAnchors() const;
 	bool isLineAnchored(int index) const;
@@ -176,6 +202,15 @@ public:
 	void checqCriticals(const RangeList &ranges, int errorFlags, int minDurationMsecs, int maxDurationMsecs, int minMsecsPerChar, int maxMsecsPerChar, int maxChars, int maxLines);
 	void rechecqCriticals(const RangeList &ranges, int minDurationMsecs, int maxDurationMsecs, int minMsecsPerChar, int maxMsecsPerChar, int maxChars, int maxLines);
 
+/// number of lines that have the error
+	int errorCount(SubtitleLine::ErrorID errorId) const;
+/// number of lines that have any of errorFlags
+	int errorLinesCount(int errorFlags) const;
+/// first line at or after fromIndex having any of errorFlags, -1 if there is none
+	int nextErrorLine(int fromIndex, int errorFlags) const;
+/// last line at or before fromIndex having any of errorFlags, -1 if there is none
+	int previousErrorLine(int fromIndex, int errorFlags) const;
+
 signals:
 	void primaryChanged();
 	void secondaryChanged();
@@ -188,17 +223,37 @@ signals:
 	void linesInserted(int firstIndex, int lastIndex);
 	void linesAboutToBeRemoved(int firstIndex, int lastIndex);
 	void linesRemoved(int firstIndex, int lastIndex);
+	// ranges are line indexes as they are when the lines are in the subtitle
+	void lineRangesAboutToBeInserted(const RangeList &ranges);
+	void lineRangesInserted(const RangeList &ranges);
+	void lineRangesAboutToBeRemoved(const RangeList &ranges);
+	void lineRangesRemoved(const RangeList &ranges);
+	void linesAboutToBeReordered(int firstIndex, int lastIndex);
+	// line at firstIndex + i was at firstIndex + permutation[i] before the reorder
+	void linesReordered(int firstIndex, int lastIndex, const QVector<int> &permutation);
 
 	void lineAnchorChanged(const SubtitleLine *line, bool anchored);
 
 /// forwarded line signals
-	void linePrimaryTextChanged(SubtitleLine *line, const SString &text);
-	void lineSecondaryTextChanged(SubtitleLine *line, const SString &text);
-	void lineShowTimeChanged(SubtitleLine *line, const Time &showTime);
-	void lineHideTimeChanged(SubtitleLine *line, const Time &hideTime);
-	void lineErrorFlagsChanged(SubtitleLine *line, int errorFlags);
 	void lineMarkChanged(SubtitleLine *line, bool marked);
 
+/// coalesced line signals - a single line change outside of a composite action is
+/// reported right away, changes made inside one are collected and reported once
+/// before the outermost composite action ends, or once undo/redo of a whole action is done
+	void linesPrimaryTextChanged(const RangeList &ranges);
+	void linesSecondaryTextChanged(const RangeList &ranges);
+	void linesTimesChanged(const RangeList &ranges);
+	void linesErrorFlagsChanged(const RangeList &ranges);
+
+private slots:
+	void invalidateTimeIndex();
+	void onLinesInserted(int firstIndex, int lastIndex);
+	void onLinesRemoved(int firstIndex);
+	void onLineRangesInserted(const RangeList &ranges);
+	void onLineRangesRemoved(const RangeList &ranges);
+	void onLinesReordered(int firstIndex, int lastIndex);
+	void onUndoStackIndexChanged();
+
 private:
 	FormatData * formatData() const;
 	void setFormatData(const FormatData *formatData);
@@ -207,6 +262,44 @@ private:
 	void endCompositeAction();
 	void processAction(QUndoCommand *action);
 
+	enum LineChange {
+		PrimaryTextChange = 0,
+		SecondaryTextChange,
+		TimesChange,
+		ErrorFlagsChange,
+		LineChangeSIZE
+	};
+
+	void lineChanged(int index, LineChange change);
+	void linesChanged(const RangeList &ranges, int changes);
+	int takeLineChanges(int index);
+	void insertLineChanges(int firstIndex, int lastIndex, int changes = 0);
+	void removeLineChanges(int firstIndex, int lastIndex);
+	void permuteLineChanges(int firstIndex, const QVector<int> &permutation);
+	void beginUndoStackAction();
+	void emitLineChanges();
+	bool deferShowTimeSort();
+	void moveLinesToShowTimePosition(const RangeList &ranges);
+
+	void markErrorsDirty(int firstIndex, int lastIndex);
+	void updateErrorIndex(int firstIndex, int lastIndex);
+	void insertErrorIndex(int firstIndex, int lastIndex);
+	void removeErrorIndex(int firstIndex, int lastIndex);
+	void checkLinesErrors(const RangeList &ranges, int errorFlags, const QVector<int> &settings);
+
+	int anchorIndex(const SubtitleLine *line) const;
+	void sortAnchoredLines();
+	void insertAnchors(int firstIndex, int lastIndex);
+	void removeRemovedAnchors();
+
+	QList<SubtitleLine *> takeLines();
+	void replacePrimaryData(const QList<SubtitleLine *> &lines, bool usePrimaryData);
+	void replaceSecondaryData(const QList<SubtitleLine *> &lines, bool usePrimaryData);
+
+	template<class Fn> void transformTexts(const RangeList &ranges, TextTarget target, Fn fn);
+	template<class Fn> void scanTexts(const RangeList &ranges, TextTarget target, Fn fn);
+	void setLinesText(const QVector<SubtitleLine *> &lines, SubtitleLine::TextTarget target, const QVector<SString> &texts);
+
 	void updateState();
 
 	inline int normalizeRangeIndex(int index) const { return index >= m_lines.count() ? m_lines.count() - 1 : index; }
@@ -222,8 +315,17 @@ private:
 	int m_secondaryCleanState;
 
 	double m_framesPerSecond;
+	QUndoStack *m_undoStack;
 	mutable QVector<ObjectRef<SubtitleLine>> m_lines;
-	QList<const SubtitleLine *> m_anchoredLines;
+	QVector<const SubtitleLine *> m_anchoredLines; // sorted by show time
+	SubtitleTimeIndex m_timeIndex;
+
+	int m_compositeActionDepth;
+	bool m_undoStackActionOpen;
+	RangeList m_changedLines[LineChangeSIZE];
+	bool m_showTimeSortPending;
+	QVector<int> m_errorCheckSettings;
+	QVector<int> m_errorLines[SubtitleLine::ErrorSIZE]; // sorted indexes of the lines having each error
 
 	FormatData *m_formatData;
 
@@ -19,9 +19,10 @@
  */
 
 #include "core/subtitleactions.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 #include "core/subtitleline.h"
 #include "core/sstring.h"
+#include "helpers/objectref.h"
 
 #include <QObject>
 
@@ -38,6 +39,16 @@ SubtitleAction::SubtitleAction(Subtitle &subtitle, SubtitleAction::DirtyMode dir
 SubtitleAction::~SubtitleAction()
 {}
 
+qint64
+SubtitleAction::linesMemoryUsage(const QList<SubtitleLine *> &lines)
+{
+	// lines owned by the action while they are not in the subtitle
+	qint64 bytes = lines.size() * sizeof(void *);
+	foreach(const SubtitleLine *line, lines)
+		bytes += line->memoryUsage();
+	return bytes;
+}
+
 
 // *** SetFramesPerSecondAction
 SetFramesPerSecondAction::SetFramesPerSecondAction(Subtitle &subtitle, double framesPerSecond)
@@ -77,6 +88,12 @@ InsertLinesAction::~InsertLinesAction()
 	qDeleteAll(m_lines);
 }
 
+qint64
+InsertLinesAction::memoryUsage() const
+{
+	return sizeof(*this) + linesMemoryUsage(m_lines);
+}
+
 bool
 InsertLinesAction::mergeWith(const QUndoCommand *command)
 {
@@ -101,16 +118,11 @@ InsertLinesAction::redo()
 {
 	emit m_subtitle.linesAboutToBeInserted(m_insertIndex, m_lastIndex);
 
-	SubtitleLine *line;
-	int insertOffset = 0;
-	int lineIndex = -1;
-
-	while(!m_lines.isEmpty()) {
-		line = m_lines.takeFirst();
-		lineIndex = m_insertIndex + insertOffset++;
+	foreach(SubtitleLine *line, m_lines)
 		setLineSubtitle(line);
-		m_subtitle.m_lines.insert(lineIndex, line);
-	}
+	ObjectRef<SubtitleLine>::insert(m_subtitle.m_lines, m_insertIndex, m_lines);
+	m_lines.clear();
+	m_subtitle.insertLineChanges(m_insertIndex, m_lastIndex);
 
 	emit m_subtitle.linesInserted(m_insertIndex, m_lastIndex);
 }
@@ -120,11 +132,10 @@ InsertLinesAction::undo()
 {
 	emit m_subtitle.linesAboutToBeRemoved(m_insertIndex, m_lastIndex);
 
-	for(int index = m_insertIndex; index <= m_lastIndex; ++index) {
-		SubtitleLine *line = m_subtitle.takeAt(m_insertIndex);
+	ObjectRef<SubtitleLine>::remove(m_subtitle.m_lines, m_insertIndex, m_lastIndex - m_insertIndex + 1, &m_lines);
+	m_subtitle.removeLineChanges(m_insertIndex, m_lastIndex);
+	foreach(SubtitleLine *line, m_lines)
 		clearLineSubtitle(line);
-		m_lines.append(line);
-	}
 
 	emit m_subtitle.linesRemoved(m_insertIndex, m_lastIndex);
 }
@@ -149,6 +160,12 @@ RemoveLinesAction::~RemoveLinesAction()
 	qDeleteAll(m_lines);
 }
 
+qint64
+RemoveLinesAction::memoryUsage() const
+{
+	return sizeof(*this) + linesMemoryUsage(m_lines);
+}
+
 bool
 RemoveLinesAction::mergeWith(const QUndoCommand *command)
 {
@@ -180,11 +197,10 @@ RemoveLinesAction::redo()
 {
 	emit m_subtitle.linesAboutToBeRemoved(m_firstIndex, m_lastIndex);
 
-	for(int index = m_firstIndex; index <= m_lastIndex; ++index) {
-		SubtitleLine *line = m_subtitle.takeAt(m_firstIndex);
+	ObjectRef<SubtitleLine>::remove(m_subtitle.m_lines, m_firstIndex, m_lastIndex - m_firstIndex + 1, &m_lines);
+	m_subtitle.removeLineChanges(m_firstIndex, m_lastIndex);
+	foreach(SubtitleLine *line, m_lines)
 		clearLineSubtitle(line);
-		m_lines.append(line);
-	}
 
 	emit m_subtitle.linesRemoved(m_firstIndex, m_lastIndex);
 }
@@ -194,20 +210,68 @@ RemoveLinesAction::undo()
 {
 	emit m_subtitle.linesAboutToBeInserted(m_firstIndex, m_lastIndex);
 
-	int insertOffset = 0;
-	int lineIndex = -1;
-
-	while(!m_lines.isEmpty()) {
-		SubtitleLine *line = m_lines.takeFirst();
-		lineIndex = m_firstIndex + insertOffset++;
+	foreach(SubtitleLine *line, m_lines)
 		setLineSubtitle(line);
-		m_subtitle.m_lines.insert(lineIndex, line);
-	}
+	ObjectRef<SubtitleLine>::insert(m_subtitle.m_lines, m_firstIndex, m_lines);
+	m_lines.clear();
+	m_subtitle.insertLineChanges(m_firstIndex, m_lastIndex);
 
 	emit m_subtitle.linesInserted(m_firstIndex, m_lastIndex);
 }
 
 
+// *** RemoveLineRangesAction
+RemoveLineRangesAction::RemoveLineRangesAction(Subtitle &subtitle, const RangeList &ranges)
+	: SubtitleAction(subtitle, UndoAction::Both, i18n("Remove Lines")),
+	  m_ranges(ranges),
+	  m_lines()
+{
+	Q_ASSERT(!m_ranges.isEmpty());
+	Q_ASSERT(m_ranges.firstIndex() >= 0);
+	Q_ASSERT(m_ranges.lastIndex() < m_subtitle.linesCount());
+}
+
+RemoveLineRangesAction::~RemoveLineRangesAction()
+{
+	qDeleteAll(m_lines);
+}
+
+qint64
+RemoveLineRangesAction::memoryUsage() const
+{
+	return sizeof(*this) + linesMemoryUsage(m_lines);
+}
+
+void
+RemoveLineRangesAction::redo()
+{
+	emit m_subtitle.lineRangesAboutToBeRemoved(m_ranges);
+
+	ObjectRef<SubtitleLine>::removeRanges(m_subtitle.m_lines, m_ranges, &m_lines);
+	for(int i = m_ranges.rangesCount() - 1; i >= 0; i--)
+		m_subtitle.removeLineChanges(m_ranges.range(i).start(), m_ranges.range(i).end());
+	foreach(SubtitleLine *line, m_lines)
+		clearLineSubtitle(line);
+
+	emit m_subtitle.lineRangesRemoved(m_ranges);
+}
+
+void
+RemoveLineRangesAction::undo()
+{
+	emit m_subtitle.lineRangesAboutToBeInserted(m_ranges);
+
+	foreach(SubtitleLine *line, m_lines)
+		setLineSubtitle(line);
+	ObjectRef<SubtitleLine>::insertRanges(m_subtitle.m_lines, m_ranges, m_lines);
+	m_lines.clear();
+	for(int i = 0, n = m_ranges.rangesCount(); i < n; i++)
+		m_subtitle.insertLineChanges(m_ranges.range(i).start(), m_ranges.range(i).end());
+
+	emit m_subtitle.lineRangesInserted(m_ranges);
+}
+
+
 // *** MoveLineAction
 MoveLineAction::MoveLineAction(Subtitle &subtitle, int fromIndex, int toIndex) :
 	SubtitleAction(subtitle, UndoAction::Both, i18n("Move Line")),
@@ -270,11 +334,14 @@ MoveLineAction::redo()
 	emit m_subtitle.linesAboutToBeRemoved(m_fromIndex, m_fromIndex);
 	SubtitleLine *line = m_subtitle.takeAt(m_fromIndex);
 	clearLineSubtitle(line);
+	// pending changes move along with the line
+	const int changes = m_subtitle.takeLineChanges(m_fromIndex);
 	emit m_subtitle.linesRemoved(m_fromIndex, m_fromIndex);
 
 	emit m_subtitle.linesAboutToBeInserted(m_toIndex, m_toIndex);
 	setLineSubtitle(line);
 	m_subtitle.m_lines.insert(m_toIndex, line);
+	m_subtitle.insertLineChanges(m_toIndex, m_toIndex, changes);
 	emit m_subtitle.linesInserted(m_toIndex, m_toIndex);
 }
 
@@ -284,15 +351,64 @@ MoveLineAction::undo()
 	emit m_subtitle.linesAboutToBeRemoved(m_toIndex, m_toIndex);
 	SubtitleLine *line = m_subtitle.takeAt(m_toIndex);
 	clearLineSubtitle(line);
+	// pending changes move along with the line
+	const int changes = m_subtitle.takeLineChanges(m_toIndex);
 	emit m_subtitle.linesRemoved(m_toIndex, m_toIndex);
 
 	emit m_subtitle.linesAboutToBeInserted(m_fromIndex, m_fromIndex);
 	setLineSubtitle(line);
 	m_subtitle.m_lines.insert(m_fromIndex, line);
+	m_subtitle.insertLineChanges(m_fromIndex, m_fromIndex, changes);
 	emit m_subtitle.linesInserted(m_fromIndex, m_fromIndex);
 }
 
 
+// *** PermuteLinesAction
+PermuteLinesAction::PermuteLinesAction(Subtitle &subtitle, int firstIndex, const QVector<int> &permutation) :
+	SubtitleAction(subtitle, UndoAction::Both, i18n("Sort Lines")),
+	m_firstIndex(firstIndex),
+	m_permutation(permutation)
+{
+	Q_ASSERT(m_firstIndex >= 0);
+	Q_ASSERT(m_firstIndex + m_permutation.size() <= m_subtitle.linesCount());
+}
+
+PermuteLinesAction::~PermuteLinesAction()
+{}
+
+qint64
+PermuteLinesAction::memoryUsage() const
+{
+	return sizeof(*this) + m_permutation.capacity() * sizeof(int);
+}
+
+void
+PermuteLinesAction::apply(const QVector<int> &permutation)
+{
+	const int lastIndex = m_firstIndex + permutation.size() - 1;
+
+	emit m_subtitle.linesAboutToBeReordered(m_firstIndex, lastIndex);
+	ObjectRef<SubtitleLine>::permute(m_subtitle.m_lines, m_firstIndex, permutation);
+	m_subtitle.permuteLineChanges(m_firstIndex, permutation);
+	emit m_subtitle.linesReordered(m_firstIndex, lastIndex, permutation);
+}
+
+void
+PermuteLinesAction::redo()
+{
+	apply(m_permutation);
+}
+
+void
+PermuteLinesAction::undo()
+{
+	QVector<int> inverse(m_permutation.size());
+	for(int i = 0, n = m_permutation.size(); i < n; i++)
+		inverse[m_permutation.at(i)] = i;
+	apply(inverse);
+}
+
+
 // *** SwapLinesTextsAction
 SwapLinesTextsAction::SwapLinesTextsAction(Subtitle &subtitle, const RangeList &ranges) :
 	SubtitleAction(subtitle, UndoAction::Both, i18n("Swap Texts")),
@@ -305,14 +421,150 @@ SwapLinesTextsAction::~SwapLinesTextsAction()
 void
 SwapLinesTextsAction::redo()
 {
-	for(SubtitleIterator it(m_subtitle, m_ranges); it.current(); ++it) {
-		SubtitleLine *line = it.current();
-		SString aux = line->m_primaryText;
+	for(SubtitleLine *line : SubtitleLinesView(m_subtitle, m_ranges)) {
+		qSwap(line->m_primaryText, line->m_secondaryText);
+	}
+
+	m_subtitle.linesChanged(m_ranges, 1 << Subtitle::PrimaryTextChange | 1 << Subtitle::SecondaryTextChange);
+}
+
+
+// *** SetLinesTextAction
+SetLinesTextAction::SetLinesTextAction(Subtitle &subtitle, SubtitleLine::TextTarget target, const QVector<SubtitleLine *> &lines, const QVector<SString> &texts, const QString &description) :
+	SubtitleAction(subtitle, target == SubtitleLine::Primary ? UndoAction::Primary : UndoAction::Secondary, description),
+	m_target(target),
+	m_lines(lines),
+	m_texts(texts)
+{
+	Q_ASSERT(target == SubtitleLine::Primary || target == SubtitleLine::Secondary);
+	Q_ASSERT(lines.size() == texts.size());
+}
+
+SetLinesTextAction::~SetLinesTextAction()
+{}
+
+qint64
+SetLinesTextAction::memoryUsage() const
+{
+	qint64 bytes = sizeof(*this) + m_lines.capacity() * sizeof(void *) + m_texts.capacity() * sizeof(SString);
+	foreach(const SString &text, m_texts)
+		bytes += text.memoryUsage();
+	return bytes;
+}
+
+void
+SetLinesTextAction::redo()
+{
+	RangeList ranges;
+	SString *texts = m_texts.data();
+
+	for(int i = 0, n = m_lines.size(); i < n; i++) {
+		SubtitleLine *line = m_lines.at(i);
+		qSwap(m_target == SubtitleLine::Primary ? line->m_primaryText : line->m_secondaryText, texts[i]);
+		ranges << Range(line->index());
+	}
+
+	m_subtitle.linesChanged(ranges, 1 << (m_target == SubtitleLine::Primary ? Subtitle::PrimaryTextChange : Subtitle::SecondaryTextChange));
+}
+
+
+// *** SetLinesErrorsAction
+SetLinesErrorsAction::SetLinesErrorsAction(Subtitle &subtitle, const QVector<SubtitleLine *> &lines, const QVector<int> &errorFlags) :
+	SubtitleAction(subtitle, UndoAction::None, i18n("Set Lines Errors")),
+	m_lines(lines),
+	m_errorFlags(errorFlags),
+	m_undone(false)
+{
+	Q_ASSERT(lines.size() == errorFlags.size());
+}
+
+SetLinesErrorsAction::~SetLinesErrorsAction()
+{}
+
+qint64
+SetLinesErrorsAction::memoryUsage() const
+{
+	return sizeof(*this) + m_lines.capacity() * sizeof(void *) + m_errorFlags.capacity() * sizeof(int);
+}
+
+void
+SetLinesErrorsAction::redo()
+{
+	RangeList ranges;
+	int *errorFlags = m_errorFlags.data();
+
+	for(int i = 0, n = m_lines.size(); i < n; i++) {
+		SubtitleLine *line = m_lines.at(i);
+		qSwap(line->m_errorFlags, errorFlags[i]);
+		// restored flags may not match the settings of the last check, the next recheck must revisit them
+		if(m_undone)
+			line->m_errorsDirty = true;
+		ranges << Range(line->index());
+	}
+
+	m_subtitle.linesChanged(ranges, 1 << Subtitle::ErrorFlagsChange);
+}
+
+void
+SetLinesErrorsAction::undo()
+{
+	m_undone = true;
+	redo();
+}
 
-		line->m_secondaryText = line->m_primaryText;
-		emit line->primaryTextChanged(line->m_primaryText);
 
-		line->m_primaryText = aux;
-		emit line->secondaryTextChanged(line->m_secondaryText);
+// *** SwapLinesDataAction
+SwapLinesDataAction::SwapLinesDataAction(Subtitle &subtitle, SubtitleLine::TextTarget target, const QList<SubtitleLine *> &lines, const QString &description) :
+	SubtitleAction(subtitle, target == SubtitleLine::Primary ? UndoAction::Primary : UndoAction::Secondary, description),
+	m_target(target),
+	m_lines(lines)
+{
+	Q_ASSERT(target == SubtitleLine::Primary || target == SubtitleLine::Secondary);
+	Q_ASSERT(lines.size() <= subtitle.linesCount());
+}
+
+SwapLinesDataAction::~SwapLinesDataAction()
+{
+	qDeleteAll(m_lines);
+}
+
+qint64
+SwapLinesDataAction::memoryUsage() const
+{
+	return sizeof(*this) + linesMemoryUsage(m_lines);
+}
+
+void
+SwapLinesDataAction::redo()
+{
+	const int count = m_lines.size();
+	if(!count)
+		return;
+
+	if(m_target == SubtitleLine::Primary) {
+		const int errorMask = ~SubtitleLine::SecondaryOnlyErrors;
+		for(int i = 0; i < count; i++) {
+			SubtitleLine *line = m_subtitle.at(i);
+			SubtitleLine *data = m_lines.at(i);
+			qSwap(line->m_primaryText, data->m_primaryText);
+			qSwap(line->m_showTime, data->m_showTime);
+			qSwap(line->m_hideTime, data->m_hideTime);
+			qSwap(line->m_formatData, data->m_formatData);
+			const int errorFlags = line->m_errorFlags;
+			line->m_errorFlags = (data->m_errorFlags & errorMask) | (errorFlags & ~errorMask);
+			data->m_errorFlags = (errorFlags & errorMask) | (data->m_errorFlags & ~errorMask);
+		}
+		m_subtitle.linesChanged(Range(0, count - 1), (1 << Subtitle::PrimaryTextChange) | (1 << Subtitle::TimesChange) | (1 << Subtitle::ErrorFlagsChange));
+	} else {
+		const int errorMask = SubtitleLine::SecondaryOnlyErrors;
+		for(int i = 0; i < count; i++) {
+			SubtitleLine *line = m_subtitle.at(i);
+			SubtitleLine *data = m_lines.at(i);
+			qSwap(line->m_secondaryText, data->m_secondaryText);
+			const int errorFlags = line->m_errorFlags;
+			line->m_errorFlags = (data->m_errorFlags & errorMask) | (errorFlags & ~errorMask);
+			data->m_errorFlags = (errorFlags & errorMask) | (data->m_errorFlags & ~errorMask);
+		}
+		m_subtitle.linesChanged(Range(0, count - 1), (1 << Subtitle::SecondaryTextChange) | (1 << Subtitle::ErrorFlagsChange));
 	}
 }
@@ -28,6 +28,7 @@
 
 #include <QString>
 #include <QList>
+#include <QVector>
 
 namespace SubtitleComposer {
 class CompositeAction;
@@ -48,6 +49,9 @@ public:
 		line->m_subtitle = nullptr;
 	}
 
+protected:
+	static qint64 linesMemoryUsage(const QList<SubtitleLine *> &lines);
+
 protected:
 	Subtitle &m_subtitle;
 };
@@ -74,6 +78,7 @@ public:
 	virtual ~InsertLinesAction();
 
 	inline int id() const override { return UndoAction::InsertLines; }
+	qint64 memoryUsage() const override;
 	bool mergeWith(const QUndoCommand *command) override;
 
 protected:
@@ -93,6 +98,7 @@ public:
 	virtual ~RemoveLinesAction();
 
 	inline int id() const override { return UndoAction::RemoveLines; }
+	qint64 memoryUsage() const override;
 	bool mergeWith(const QUndoCommand *command) override;
 
 protected:
@@ -105,6 +111,24 @@ private:
 	QList<SubtitleLine *> m_lines;
 };
 
+class RemoveLineRangesAction : public SubtitleAction
+{
+public:
+	RemoveLineRangesAction(Subtitle &subtitle, const RangeList &ranges);
+	virtual ~RemoveLineRangesAction();
+
+	inline int id() const override { return UndoAction::RemoveLineRanges; }
+	qint64 memoryUsage() const override;
+
+protected:
+	void redo() override;
+	void undo() override;
+
+private:
+	const RangeList m_ranges;
+	QList<SubtitleLine *> m_lines;
+};
+
 class MoveLineAction : public SubtitleAction
 {
 public:
@@ -123,6 +147,26 @@ private:
 	int m_toIndex;
 };
 
+class PermuteLinesAction : public SubtitleAction
+{
+public:
+	PermuteLinesAction(Subtitle &subtitle, int firstIndex, const QVector<int> &permutation);
+	virtual ~PermuteLinesAction();
+
+	inline int id() const override { return UndoAction::PermuteLines; }
+	qint64 memoryUsage() const override;
+
+protected:
+	void redo() override;
+	void undo() override;
+
+private:
+	void apply(const QVector<int> &permutation);
+
+	const int m_firstIndex;
+	const QVector<int> m_permutation;
+};
+
 class SwapLinesTextsAction : public SubtitleAction
 {
 public:
@@ -137,6 +181,63 @@ protected:
 private:
 	const RangeList m_ranges;
 };
+
+class SetLinesTextAction : public SubtitleAction
+{
+public:
+	SetLinesTextAction(Subtitle &subtitle, SubtitleLine::TextTarget target, const QVector<SubtitleLine *> &lines, const QVector<SString> &texts, const QString &description);
+	virtual ~SetLinesTextAction();
+
+	inline int id() const override { return UndoAction::SetLinesText; }
+	qint64 memoryUsage() const override;
+
+protected:
+	void redo() override;
+
+private:
+	const SubtitleLine::TextTarget m_target;
+	const QVector<SubtitleLine *> m_lines;
+	QVector<SString> m_texts;
+};
+
+class SetLinesErrorsAction : public SubtitleAction
+{
+public:
+	SetLinesErrorsAction(Subtitle &subtitle, const QVector<SubtitleLine *> &lines, const QVector<int> &errorFlags);
+	virtual ~SetLinesErrorsAction();
+
+	inline int id() const override { return UndoAction::SetLinesErrors; }
+	qint64 memoryUsage() const override;
+
+protected:
+	void redo() override;
+	void undo() override;
+
+private:
+	const QVector<SubtitleLine *> m_lines;
+	QVector<int> m_errorFlags;
+	bool m_undone;
+};
+
+class SwapLinesDataAction : public SubtitleAction
+{
+public:
+	// lines are owned by the action, lines[i] holds the data for the subtitle line i.
+	// Primary target swaps primary text, times, format data and all but secondary only errors,
+	// Secondary target swaps secondary text and secondary only errors.
+	SwapLinesDataAction(Subtitle &subtitle, SubtitleLine::TextTarget target, const QList<SubtitleLine *> &lines, const QString &description);
+	virtual ~SwapLinesDataAction();
+
+	inline int id() const override { return UndoAction::SwapLinesData; }
+	qint64 memoryUsage() const override;
+
+protected:
+	void redo() override;
+
+private:
+	const SubtitleLine::TextTarget m_target;
+	const QList<SubtitleLine *> m_lines;
+};
 }
 
 #endif
@@ -24,6 +24,8 @@
 #include "core/subtitleactions.h"
 
 #include <QRegExp>
+#include <QMutex>
+#include <QVector>
 
 #include <KLocalizedString>
 
@@ -140,8 +142,100 @@ SubtitleLine::fullErrorText(SubtitleLine::ErrorID errorID) const
 	}
 }
 
+namespace {
+// Lines are carved out of big blocks, so lines created one after another (e.g. while
+// loading a file) end up next to each other in memory and cost a single allocation
+// per block instead of one per line.
+class LineArena
+{
+public:
+	void * alloc()
+	{
+		QMutexLocker locker(&m_mutex);
+		if(!m_freeSlots)
+			grow();
+		FreeSlot *slot = m_freeSlots;
+		m_freeSlots = slot->next;
+		m_usedSlots++;
+		return slot;
+	}
+
+	void free(void *ptr)
+	{
+		QMutexLocker locker(&m_mutex);
+		FreeSlot *slot = static_cast<FreeSlot *>(ptr);
+		slot->next = m_freeSlots;
+		m_freeSlots = slot;
+		if(--m_usedSlots == 0)
+			shrink();
+	}
+
+private:
+	struct FreeSlot {
+		FreeSlot *next;
+	};
+
+	enum { BlockSlots = 1024 };
+
+	void grow()
+	{
+		char *block = static_cast<char *>(::operator new(BlockSlots * sizeof(SubtitleLine)));
+		m_blocks.append(block);
+		addFreeSlots(block);
+	}
+
+	void shrink()
+	{
+		// all lines are gone - return memory of big subtitles, keep one block for small ones
+		if(m_blocks.size() <= 1)
+			return;
+		for(int i = 1, n = m_blocks.size(); i < n; i++)
+			::operator delete(m_blocks.at(i));
+		m_blocks.resize(1);
+		m_freeSlots = nullptr;
+		addFreeSlots(m_blocks.first());
+	}
+
+	void addFreeSlots(char *block)
+	{
+		// chain slots in address order so consecutive allocations are adjacent
+		for(int i = BlockSlots - 1; i >= 0; i--) {
+			FreeSlot *slot = reinterpret_cast<FreeSlot *>(block + i * sizeof(SubtitleLine));
+			slot->next = m_freeSlots;
+			m_freeSlots = slot;
+		}
+	}
+
+	QMutex m_mutex;
+	FreeSlot *m_freeSlots = nullptr;
+	int m_usedSlots = 0;
+	QVector<char *> m_blocks;
+};
+
+LineArena *
+lineArena()
+{
+	// never destroyed, lines may outlive static destructors
+	static LineArena *arena = new LineArena();
+	return arena;
+}
+}
+
+void *
+SubtitleLine::operator new(size_t size)
+{
+	Q_ASSERT(size == sizeof(SubtitleLine));
+	return lineArena()->alloc();
+}
+
+void
+SubtitleLine::operator delete(void *ptr)
+{
+	if(ptr)
+		lineArena()->free(ptr);
+}
+
 SubtitleLine::SubtitleLine(const SString &pText, const SString &sText) :
-	QObject(),
 	m_subtitle(0),
 	m_primaryText(pText),
 	m_secondaryText(sText),
@@ -152,7 +246,6 @@ SubtitleLine::SubtitleLine(const SString &pText, const SString &sText) :
 {}
 
 SubtitleLine::SubtitleLine(const SString &pText, const Time &showTime, const Time &hideTime) :
-	QObject(),
 	m_subtitle(0),
 	m_primaryText(pText),
 	m_secondaryText(QString()),
@@ -163,7 +256,6 @@ SubtitleLine::SubtitleLine(const SString &pText, const Time &showTime, const Tim
 {}
 
 SubtitleLine::SubtitleLine(const SString &pText, const SString &sText, const Time &showTime, const Time &hideTime) :
-	QObject(),
 	m_subtitle(0),
 	m_primaryText(pText),
 	m_secondaryText(sText),
@@ -174,7 +266,6 @@ SubtitleLine::SubtitleLine(const SString &pText, const SString &sText, const Tim
 {}
 
 SubtitleLine::SubtitleLine(const SubtitleLine &line) :
-	QObject(),
 	m_subtitle(0),
 	m_primaryText(line.m_primaryText),
 	m_secondaryText(line.m_secondaryText),
@@ -386,7 +477,8 @@ SubtitleLine::breakText(const SString &t, int minLengthForBreak)
 	if(text.length() <= minLengthForBreak)
 		return text;
 
-	static const QRegExp spaceRegExp("[^ \t\n][ \t\n]");
+	// QRegExp keeps its match state, transformTexts() calls this from several threads
+	static thread_local const QRegExp spaceRegExp("[^ \t\n][ \t\n]");
 
 	// this is a fricking test case
 	// this is a fri|cking test case    IDEAL: 13
@@ -484,18 +576,37 @@ SubtitleLine::simplifyTextWhiteSpace(TextTarget target)
 void
 SubtitleLine::processShowTimeSort(const Time &showTime)
 {
-	if(!m_subtitle)
+	if(!m_subtitle || m_subtitle->deferShowTimeSort())
 		return;
 
+	// other lines are sorted by show time, binary search for the new position
 	const int curIndex = index();
 	const int maxIndex = m_subtitle->linesCount() - 1;
 	int newIndex = curIndex;
 
-	while(newIndex < maxIndex && m_subtitle->line(newIndex + 1)->m_showTime < showTime)
-		newIndex++;
-
-	while(newIndex > 0 && m_subtitle->line(newIndex - 1)->m_showTime > showTime)
-		newIndex--;
+	if(curIndex < maxIndex && m_subtitle->at(curIndex + 1)->m_showTime < showTime) {
+		// first line after this one that doesn't show earlier
+		int low = curIndex + 1, high = maxIndex + 1;
+		while(low < high) {
+			const int mid = (low + high) / 2;
+			if(m_subtitle->at(mid)->m_showTime < showTime)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		newIndex = low - 1;
+	} else if(curIndex > 0 && m_subtitle->at(curIndex - 1)->m_showTime > showTime) {
+		// first line before this one that shows later
+		int low = 0, high = curIndex - 1;
+		while(low < high) {
+			const int mid = (low + high) / 2;
+			if(m_subtitle->at(mid)->m_showTime > showTime)
+				high = mid;
+			else
+				low = mid + 1;
+		}
+		newIndex = low;
+	}
 
 	if(curIndex != newIndex)
 		processAction(new MoveLineAction(*m_subtitle, curIndex, newIndex));
@@ -587,6 +698,15 @@ SubtitleLine::setTimes(const Time &showTime, const Time &hideTime)
 		m_subtitle->endCompositeAction();
 }
 
+qint64
+SubtitleLine::memoryUsage() const
+{
+	qint64 bytes = sizeof(*this) + m_primaryText.memoryUsage() + m_secondaryText.memoryUsage();
+	if(m_formatData)
+		bytes += m_formatData->memoryUsage();
+	return bytes;
+}
+
 int
 SubtitleLine::primaryCharacters() const
 {
@@ -708,7 +828,7 @@ SubtitleLine::setErrorFlags(int errorFlags, bool value)
 bool
 SubtitleLine::checkEmptyPrimaryText(bool update)
 {
-	static const QRegExp emptyTextRegExp("^\\s*$");
+	static thread_local const QRegExp emptyTextRegExp("^\\s*$");
 
 	bool error = m_primaryText.isEmpty() || m_primaryText.indexOf(emptyTextRegExp) != -1;
 
@@ -721,7 +841,7 @@ SubtitleLine::checkEmptyPrimaryText(bool update)
 bool
 SubtitleLine::checkEmptySecondaryText(bool update)
 {
-	static const QRegExp emptyTextRegExp("^\\s*$");
+	static thread_local const QRegExp emptyTextRegExp("^\\s*$");
 
 	bool error = m_secondaryText.isEmpty() || m_secondaryText.indexOf(emptyTextRegExp) != -1;
 
@@ -891,7 +1011,7 @@ SubtitleLine::checkMaxSecondaryLines(int maxLines, bool update)
 bool
 SubtitleLine::checkPrimaryUnneededSpaces(bool update)
 {
-	static const QRegExp unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
+	static thread_local const QRegExp unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
 
 	bool error = m_primaryText.indexOf(unneededSpaceRegExp) != -1;
 
@@ -904,7 +1024,7 @@ SubtitleLine::checkPrimaryUnneededSpaces(bool update)
 bool
 SubtitleLine::checkSecondaryUnneededSpaces(bool update)
 {
-	static const QRegExp unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
+	static thread_local const QRegExp unneededSpaceRegExp("(^\\s|\\s$|¿\\s|¡\\s|\\s\\s|\\s!|\\s\\?|\\s:|\\s;|\\s,|\\s\\.)");
 
 	bool error = m_secondaryText.indexOf(unneededSpaceRegExp) != -1;
 
@@ -951,7 +1071,7 @@ SubtitleLine::checkSecondaryCapitalAfterEllipsis(bool update)
 bool
 SubtitleLine::checkPrimaryUnneededDash(bool update)
 {
-	static const QRegExp unneededDashRegExp("(^|\n)\\s*-[^-]");
+	static thread_local const QRegExp unneededDashRegExp("(^|\n)\\s*-[^-]");
 
 	bool error = m_primaryText.count(unneededDashRegExp) == 1;
 
@@ -964,7 +1084,7 @@ SubtitleLine::checkPrimaryUnneededDash(bool update)
 bool
 SubtitleLine::checkSecondaryUnneededDash(bool update)
 {
-	static const QRegExp unneededDashRegExp("(^|\n)\\s*-[^-]");
+	static thread_local const QRegExp unneededDashRegExp("(^|\n)\\s*-[^-]");
 
 	bool error = m_secondaryText.count(unneededDashRegExp) == 1;
 
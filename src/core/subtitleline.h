@@ -27,7 +27,6 @@
 #include "core/formatdata.h"
 #include "helpers/objectref.h"
 
-#include <QObject>
 #include <QString>
 
 class QUndoCommand;
@@ -35,13 +34,17 @@ class QUndoCommand;
 namespace SubtitleComposer {
 class Subtitle;
 
-class SubtitleLine : public QObject
+// Lines are plain objects allocated from a shared arena, change notifications are
+// sent by the owning Subtitle (see Subtitle::linesPrimaryTextChanged() etc.) and
+// scripts get their own QObject wrappers (Scripting::SubtitleLine).
+class SubtitleLine
 {
-	Q_OBJECT
-
 	friend class Subtitle;
 	friend class SubtitleAction;
 	friend class SwapLinesTextsAction;
+	friend class SetLinesTextAction;
+	friend class SwapLinesDataAction;
+	friend class SetLinesErrorsAction;
 	friend class SubtitleLineAction;
 	friend class SetLinePrimaryTextAction;
 	friend class SetLineSecondaryTextAction;
@@ -141,7 +144,10 @@ public:
 	SubtitleLine(const SString &pText, const SString &sText, const Time &showTime, const Time &hideTime);
 	SubtitleLine(const SubtitleLine &line);
 	SubtitleLine & operator=(const SubtitleLine &line);
-	virtual ~SubtitleLine();
+	~SubtitleLine();
+
+	static void * operator new(size_t size);
+	static void operator delete(void *ptr);
 
 	int number() const;
 	int index() const;
@@ -228,12 +234,8 @@ public:
 
 	bool isRightToLeft() const;
 
-signals:
-	void primaryTextChanged(const SString &text);
-	void secondaryTextChanged(const SString &text);
-	void showTimeChanged(const Time &showTime);
-	void hideTimeChanged(const Time &hideTime);
-	void errorFlagsChanged(int errorFlags);
+	/// approximate bytes held by the line, its texts and format data
+	qint64 memoryUsage() const;
 
 private:
 	FormatData * formatData() const;
@@ -252,6 +254,11 @@ private:
 
 	FormatData *m_formatData;
 
+	// anchors belong to the line object (copies are not anchored), see Subtitle::toggleLineAnchor()
+	mutable bool m_anchored = false;
+	// set when the line changed since errors were last rechecked, see Subtitle::rechecqCriticals()
+	bool m_errorsDirty = true;
+
 	mutable ObjectRef<SubtitleLine> *m_ref = nullptr;
 	const QVector<ObjectRef<SubtitleLine>> * refContainer();
 };
@@ -21,8 +21,6 @@
 #include "subtitlelineactions.h"
 #include "core/subtitle.h"
 
-#define PROPAGATE_LINE_SIGNALS
-
 #include <KLocalizedString>
 
 using namespace SubtitleComposer;
@@ -46,6 +44,12 @@ SetLinePrimaryTextAction::SetLinePrimaryTextAction(SubtitleLine &line, const SSt
 SetLinePrimaryTextAction::~SetLinePrimaryTextAction()
 {}
 
+qint64
+SetLinePrimaryTextAction::memoryUsage() const
+{
+	return sizeof(*this) + m_primaryText.memoryUsage();
+}
+
 bool
 SetLinePrimaryTextAction::mergeWith(const QUndoCommand *command)
 {
@@ -60,11 +64,8 @@ SetLinePrimaryTextAction::redo()
 	m_line.m_primaryText = m_primaryText;
 	m_primaryText = tmp;
 
-	emit m_line.primaryTextChanged(m_line.m_primaryText);
-#ifdef PROPAGATE_LINE_SIGNALS
 	if(m_line.m_subtitle)
-		emit m_line.m_subtitle->linePrimaryTextChanged(&m_line, m_line.m_primaryText);
-#endif
+		m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::PrimaryTextChange);
 }
 
 
@@ -77,6 +78,12 @@ SetLineSecondaryTextAction::SetLineSecondaryTextAction(SubtitleLine &line, const
 SetLineSecondaryTextAction::~SetLineSecondaryTextAction()
 {}
 
+qint64
+SetLineSecondaryTextAction::memoryUsage() const
+{
+	return sizeof(*this) + m_secondaryText.memoryUsage();
+}
+
 bool
 SetLineSecondaryTextAction::mergeWith(const QUndoCommand *command)
 {
@@ -91,11 +98,8 @@ SetLineSecondaryTextAction::redo()
 	m_line.m_secondaryText = m_secondaryText;
 	m_secondaryText = tmp;
 
-	emit m_line.secondaryTextChanged(m_line.m_secondaryText);
-#ifdef PROPAGATE_LINE_SIGNALS
 	if(m_line.m_subtitle)
-		emit m_line.m_subtitle->lineSecondaryTextChanged(&m_line, m_line.m_secondaryText);
-#endif
+		m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::SecondaryTextChange);
 }
 
 
@@ -109,6 +113,12 @@ SetLineTextsAction::SetLineTextsAction(SubtitleLine &line, const SString &primar
 SetLineTextsAction::~SetLineTextsAction()
 {}
 
+qint64
+SetLineTextsAction::memoryUsage() const
+{
+	return sizeof(*this) + m_primaryText.memoryUsage() + m_secondaryText.memoryUsage();
+}
+
 bool
 SetLineTextsAction::mergeWith(const QUndoCommand *command)
 {
@@ -124,11 +134,8 @@ SetLineTextsAction::redo()
 		m_line.m_primaryText = m_primaryText;
 		m_primaryText = tmp;
 
-		emit m_line.primaryTextChanged(m_line.m_primaryText);
-#ifdef PROPAGATE_LINE_SIGNALS
 		if(m_line.m_subtitle)
-			emit m_line.m_subtitle->linePrimaryTextChanged(&m_line, m_line.m_primaryText);
-#endif
+			m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::PrimaryTextChange);
 	}
 
 	if(m_line.m_secondaryText != m_secondaryText) {
@@ -136,11 +143,8 @@ SetLineTextsAction::redo()
 		m_line.m_secondaryText = m_secondaryText;
 		m_secondaryText = tmp;
 
-		emit m_line.secondaryTextChanged(m_line.m_secondaryText);
-#ifdef PROPAGATE_LINE_SIGNALS
 		if(m_line.m_subtitle)
-			emit m_line.m_subtitle->lineSecondaryTextChanged(&m_line, m_line.m_secondaryText);
-#endif
+			m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::SecondaryTextChange);
 	}
 }
 
@@ -168,11 +172,8 @@ SetLineShowTimeAction::redo()
 	m_line.m_showTime = m_showTime;
 	m_showTime = tmp;
 
-	emit m_line.showTimeChanged(m_line.m_showTime);
-#ifdef PROPAGATE_LINE_SIGNALS
 	if(m_line.m_subtitle)
-		emit m_line.m_subtitle->lineShowTimeChanged(&m_line, m_line.m_showTime);
-#endif
+		m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::TimesChange);
 }
 
 
@@ -199,11 +200,8 @@ SetLineHideTimeAction::redo()
 	m_line.m_hideTime = m_hideTime;
 	m_hideTime = tmp;
 
-	emit m_line.hideTimeChanged(m_line.m_hideTime);
-#ifdef PROPAGATE_LINE_SIGNALS
 	if(m_line.m_subtitle)
-		emit m_line.m_subtitle->lineHideTimeChanged(&m_line, m_line.m_hideTime);
-#endif
+		m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::TimesChange);
 }
 
 
@@ -232,11 +230,8 @@ SetLineTimesAction::redo()
 		m_line.m_showTime = m_showTime;
 		m_showTime = tmp;
 
-		emit m_line.showTimeChanged(m_line.m_showTime);
-#ifdef PROPAGATE_LINE_SIGNALS
 		if(m_line.m_subtitle)
-			emit m_line.m_subtitle->lineShowTimeChanged(&m_line, m_line.m_showTime);
-#endif
+			m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::TimesChange);
 	}
 
 	if(m_line.m_hideTime != m_hideTime) {
@@ -244,11 +239,8 @@ SetLineTimesAction::redo()
 		m_line.m_hideTime = m_hideTime;
 		m_hideTime = tmp;
 
-		emit m_line.hideTimeChanged(m_line.m_hideTime);
-#ifdef PROPAGATE_LINE_SIGNALS
 		if(m_line.m_subtitle)
-			emit m_line.m_subtitle->lineHideTimeChanged(&m_line, m_line.m_hideTime);
-#endif
+			m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::TimesChange);
 	}
 }
 
@@ -275,9 +267,6 @@ SetLineErrorsAction::redo()
 	m_line.m_errorFlags = m_errorFlags;
 	m_errorFlags = tmp;
 
-	emit m_line.errorFlagsChanged(m_line.m_errorFlags);
-#ifdef PROPAGATE_LINE_SIGNALS
 	if(m_line.m_subtitle)
-		emit m_line.m_subtitle->lineErrorFlagsChanged(&m_line, m_line.m_errorFlags);
-#endif
+		m_line.m_subtitle->lineChanged(m_line.index(), Subtitle::ErrorFlagsChange);
 }
@@ -56,6 +56,7 @@ public:
 	virtual ~SetLinePrimaryTextAction();
 
 	inline int id() const override { return UndoAction::SetLinePrimaryText; }
+	qint64 memoryUsage() const override;
 	bool mergeWith(const QUndoCommand *command) override;
 
 protected:
@@ -74,6 +75,7 @@ public:
 	virtual ~SetLineSecondaryTextAction();
 
 	inline int id() const override { return UndoAction::SetLineSecondaryText; }
+	qint64 memoryUsage() const override;
 	bool mergeWith(const QUndoCommand *command) override;
 
 protected:
@@ -91,6 +93,7 @@ public:
 	virtual ~SetLineTextsAction();
 
 	inline int id() const override { return UndoAction::SetLineTexts; }
+	qint64 memoryUsage() const override;
 	bool mergeWith(const QUndoCommand *command) override;
 
 protected:
@@ -0,0 +1,95 @@
+#ifndef SUBTITLELINESVIEW_H
+#define SUBTITLELINESVIEW_H
+
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "core/rangelist.h"
+#include "core/subtitle.h"
+
+namespace SubtitleComposer {
+// Lines of the subtitle that fall in ranges, for use in range-for loops:
+//   for(SubtitleLine *line : SubtitleLinesView(subtitle, ranges))
+// Walks the subtitle's lines array directly. Lines can be changed while iterating,
+// but lines must not be inserted, removed or moved - use SubtitleIterator for that.
+class SubtitleLinesView
+{
+public:
+	class Iterator
+	{
+		friend class SubtitleLinesView;
+
+	public:
+		inline SubtitleLine * operator*() const { return m_line->obj(); }
+		inline int index() const { return int(m_line - m_lines); }
+
+		inline Iterator & operator++()
+		{
+			if(++m_line == m_rangeEnd)
+				toRange(m_range + 1);
+			return *this;
+		}
+
+		inline bool operator==(const Iterator &other) const { return m_line == other.m_line; }
+		inline bool operator!=(const Iterator &other) const { return m_line != other.m_line; }
+
+	private:
+		Iterator(const ObjectRef<SubtitleLine> *lines, int count, RangeList::ConstIterator range, RangeList::ConstIterator rangesEnd)
+			: m_lines(lines), m_count(count), m_rangesEnd(rangesEnd)
+		{
+			toRange(range);
+		}
+
+		inline void toRange(RangeList::ConstIterator range)
+		{
+			// ranges are sorted, once one starts past the last line we are done
+			m_range = range;
+			if(m_range == m_rangesEnd || (*m_range).start() >= m_count) {
+				m_line = m_rangeEnd = m_lines + m_count;
+			} else {
+				m_line = m_lines + (*m_range).start();
+				m_rangeEnd = m_lines + qMin((*m_range).end(), m_count - 1) + 1;
+			}
+		}
+
+		const ObjectRef<SubtitleLine> *m_lines;
+		const ObjectRef<SubtitleLine> *m_line;
+		const ObjectRef<SubtitleLine> *m_rangeEnd;
+		int m_count;
+		RangeList::ConstIterator m_range;
+		RangeList::ConstIterator m_rangesEnd;
+	};
+
+	SubtitleLinesView(const Subtitle &subtitle, const RangeList &ranges = Range::full())
+		: m_lines(subtitle.m_lines.constData()), m_count(subtitle.m_lines.size()), m_ranges(ranges) {}
+
+	inline Iterator begin() const { return Iterator(m_lines, m_count, m_ranges.begin(), m_ranges.end()); }
+	inline Iterator end() const { return Iterator(m_lines, m_count, m_ranges.end(), m_ranges.end()); }
+
+	inline bool isEmpty() const { return begin() == end(); }
+	inline SubtitleLine * first() const { return *begin(); }
+
+private:
+	const ObjectRef<SubtitleLine> *m_lines;
+	const int m_count;
+	const RangeList m_ranges;
+};
+}
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "core/subtitletimeindex.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+
+#include <algorithm>
+
+using namespace SubtitleComposer;
+
+SubtitleTimeIndex::SubtitleTimeIndex(const Subtitle *subtitle)
+	: m_subtitle(subtitle),
+	  m_dirty(true)
+{}
+
+void
+SubtitleTimeIndex::rebuild()
+{
+	m_dirty = false;
+
+	const int n = m_subtitle->count();
+	m_entries.resize(n);
+	if(!n)
+		return;
+
+	Entry *entries = m_entries.data();
+	bool sorted = true;
+	for(int i = 0; i < n; i++) {
+		const SubtitleLine *line = m_subtitle->at(i);
+		entries[i].showTime = line->showTime().toMillis();
+		entries[i].hideTime = line->hideTime().toMillis();
+		entries[i].line = const_cast<SubtitleLine *>(line);
+		if(i && entries[i - 1].showTime > entries[i].showTime)
+			sorted = false;
+	}
+
+	// lines are normally kept sorted by show time, so this is rarely needed
+	if(!sorted) {
+		std::stable_sort(entries, entries + n, [](const Entry &a, const Entry &b) -> bool {
+			return a.showTime < b.showTime;
+		});
+	}
+
+	double maxHideTime = entries[0].hideTime;
+	for(int i = 0; i < n; i++) {
+		if(maxHideTime < entries[i].hideTime)
+			maxHideTime = entries[i].hideTime;
+		entries[i].maxHideTime = maxHideTime;
+	}
+}
+
+void
+SubtitleTimeIndex::updateLine(const SubtitleLine *line)
+{
+	if(m_dirty)
+		return;
+
+	// past this many entries a lazy rebuild is cheaper, e.g. when all lines are shifted one by one
+	const int maxUpdateSpan = 64;
+
+	// entries of a sorted subtitle are in line order
+	const int n = m_entries.size();
+	Entry *entries = m_entries.data();
+	int pos = line->index();
+	if(pos < 0 || pos >= n || entries[pos].line != line) {
+		m_dirty = true;
+		return;
+	}
+
+	Entry entry = entries[pos];
+	entry.showTime = line->showTime().toMillis();
+	entry.hideTime = line->hideTime().toMillis();
+
+	// move the entry to its new show time position
+	int first = pos;
+	int last = pos;
+	while(first > 0 && entries[first - 1].showTime > entry.showTime) {
+		if(pos - first == maxUpdateSpan) {
+			m_dirty = true;
+			return;
+		}
+		entries[first] = entries[first - 1];
+		first--;
+	}
+	while(last < n - 1 && entries[last + 1].showTime < entry.showTime) {
+		if(last - pos == maxUpdateSpan) {
+			m_dirty = true;
+			return;
+		}
+		entries[last] = entries[last + 1];
+		last++;
+	}
+	const int newPos = first == pos ? last : first;
+	entries[newPos] = entry;
+
+	// running maximum changes from the first moved entry on, past the last one it is
+	// the same as before once it matches the old value again
+	double maxHideTime = first ? entries[first - 1].maxHideTime : entries[0].hideTime;
+	for(int i = first; i < n; i++) {
+		if(maxHideTime < entries[i].hideTime)
+			maxHideTime = entries[i].hideTime;
+		if(i > last) {
+			if(entries[i].maxHideTime == maxHideTime)
+				break;
+			if(i - last > maxUpdateSpan) {
+				m_dirty = true;
+				return;
+			}
+		}
+		entries[i].maxHideTime = maxHideTime;
+	}
+}
+
+int
+SubtitleTimeIndex::firstEntryHiddenAfter(double millis) const
+{
+	// maxHideTime is non-decreasing - the first entry reaching millis is the first one hidden after it
+	const Entry *begin = m_entries.constData();
+	const Entry *end = begin + m_entries.size();
+	const Entry *it = std::lower_bound(begin, end, millis, [](const Entry &entry, double time) -> bool {
+		return entry.maxHideTime < time;
+	});
+	return it - begin;
+}
+
+QList<SubtitleLine *>
+SubtitleTimeIndex::linesInRange(double startMillis, double endMillis)
+{
+	if(m_dirty)
+		rebuild();
+
+	QList<SubtitleLine *> lines;
+
+	const Entry *begin = m_entries.constData();
+	const Entry *end = std::upper_bound(begin, begin + m_entries.size(), endMillis, [](double time, const Entry &entry) -> bool {
+		return time < entry.showTime;
+	});
+
+	for(const Entry *it = begin + firstEntryHiddenAfter(startMillis); it < end; ++it) {
+		if(it->hideTime >= startMillis)
+			lines.append(it->line);
+	}
+
+	return lines;
+}
+
+SubtitleLine *
+SubtitleTimeIndex::firstLineHiddenAfter(double millis)
+{
+	if(m_dirty)
+		rebuild();
+
+	const int index = firstEntryHiddenAfter(millis);
+	return index < m_entries.size() ? m_entries.at(index).line : nullptr;
+}
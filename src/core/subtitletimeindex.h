@@ -0,0 +1,65 @@
+#ifndef SUBTITLETIMEINDEX_H
+#define SUBTITLETIMEINDEX_H
+
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QVector>
+#include <QList>
+
+namespace SubtitleComposer {
+class Subtitle;
+class SubtitleLine;
+
+/**
+ * Lines of a subtitle sorted by show time, augmented with the running maximum of hide times.
+ * Answers "which lines overlap [start, end]" and "first line still shown at time" with binary
+ * searches. Index is rebuilt lazily after it was invalidated, a line whose times changed is
+ * moved in place unless that touches too many entries.
+ */
+class SubtitleTimeIndex
+{
+public:
+	explicit SubtitleTimeIndex(const Subtitle *subtitle);
+
+	inline void invalidate() { m_dirty = true; }
+	void updateLine(const SubtitleLine *line);
+	inline qint64 memoryUsage() const { return m_entries.capacity() * sizeof(Entry); }
+
+	QList<SubtitleLine *> linesInRange(double startMillis, double endMillis);
+	SubtitleLine * firstLineHiddenAfter(double millis);
+
+private:
+	void rebuild();
+	int firstEntryHiddenAfter(double millis) const;
+
+	struct Entry {
+		double showTime;
+		double hideTime;
+		double maxHideTime; // maximum hide time of this and all previous entries
+		SubtitleLine *line;
+	};
+
+	const Subtitle *m_subtitle;
+	QVector<Entry> m_entries;
+	bool m_dirty;
+};
+}
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "objectreftest.h"
+#include "helpers/objectref.h"
+#include "core/rangelist.h"
+
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+namespace {
+class RefItem
+{
+	friend class SubtitleComposer::ObjectRef<RefItem>;
+
+public:
+	RefItem(const QVector<ObjectRef<RefItem>> *container, int id)
+		: m_container(container),
+		  m_id(id)
+	{}
+
+	inline int id() const { return m_id; }
+	inline int index() const { return m_ref ? m_ref - m_container->constData() : -1; }
+
+private:
+	inline const QVector<ObjectRef<RefItem>> * refContainer() { return m_container; }
+
+private:
+	const QVector<ObjectRef<RefItem>> *m_container;
+	int m_id;
+	mutable ObjectRef<RefItem> *m_ref = nullptr;
+};
+
+QList<RefItem *>
+createItems(const QVector<ObjectRef<RefItem>> *container, int firstId, int count)
+{
+	QList<RefItem *> items;
+	items.reserve(count);
+	for(int i = 0; i < count; i++)
+		items.append(new RefItem(container, firstId + i));
+	return items;
+}
+
+bool
+verifyContainer(const QVector<ObjectRef<RefItem>> &container, const QList<int> &ids)
+{
+	if(container.size() != ids.size())
+		return false;
+	for(int i = 0, n = container.size(); i < n; i++) {
+		const RefItem *item = container.at(i).obj();
+		if(item->id() != ids.at(i) || item->index() != i)
+			return false;
+	}
+	return true;
+}
+}
+
+void
+ObjectRefTest::testInsert()
+{
+	QVector<ObjectRef<RefItem>> container;
+
+	ObjectRef<RefItem>::insert(container, 0, createItems(&container, 0, 3));
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 2));
+
+	ObjectRef<RefItem>::insert(container, 3, createItems(&container, 3, 2));
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 2 << 3 << 4));
+
+	ObjectRef<RefItem>::insert(container, 0, createItems(&container, 5, 2));
+	QVERIFY(verifyContainer(container, QList<int>() << 5 << 6 << 0 << 1 << 2 << 3 << 4));
+
+	ObjectRef<RefItem>::insert(container, 3, createItems(&container, 7, 3));
+	QVERIFY(verifyContainer(container, QList<int>() << 5 << 6 << 0 << 7 << 8 << 9 << 1 << 2 << 3 << 4));
+
+	ObjectRef<RefItem>::insert(container, 4, QList<RefItem *>());
+	QVERIFY(verifyContainer(container, QList<int>() << 5 << 6 << 0 << 7 << 8 << 9 << 1 << 2 << 3 << 4));
+
+	qDeleteAll(container);
+}
+
+void
+ObjectRefTest::testRemove()
+{
+	QVector<ObjectRef<RefItem>> container;
+	ObjectRef<RefItem>::insert(container, 0, createItems(&container, 0, 10));
+
+	QList<RefItem *> removed;
+	ObjectRef<RefItem>::remove(container, 3, 4, &removed);
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 2 << 7 << 8 << 9));
+	QVERIFY(removed.size() == 4);
+	for(int i = 0; i < removed.size(); i++)
+		QVERIFY(removed.at(i)->id() == 3 + i);
+
+	ObjectRef<RefItem>::insert(container, 3, removed);
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9));
+
+	removed.clear();
+	ObjectRef<RefItem>::remove(container, 8, 2, &removed);
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 2 << 3 << 4 << 5 << 6 << 7));
+	qDeleteAll(removed);
+
+	removed.clear();
+	ObjectRef<RefItem>::remove(container, 0, 8, &removed);
+	QVERIFY(container.isEmpty());
+	qDeleteAll(removed);
+}
+
+void
+ObjectRefTest::testPermute()
+{
+	QVector<ObjectRef<RefItem>> container;
+	ObjectRef<RefItem>::insert(container, 0, createItems(&container, 0, 8));
+
+	ObjectRef<RefItem>::permute(container, 2, QVector<int>() << 3 << 0 << 2 << 1);
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 5 << 2 << 4 << 3 << 6 << 7));
+
+	// inverse permutation restores the original order
+	ObjectRef<RefItem>::permute(container, 2, QVector<int>() << 1 << 3 << 2 << 0);
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 2 << 3 << 4 << 5 << 6 << 7));
+
+	ObjectRef<RefItem>::permute(container, 0, QVector<int>() << 7 << 6 << 5 << 4 << 3 << 2 << 1 << 0);
+	QVERIFY(verifyContainer(container, QList<int>() << 7 << 6 << 5 << 4 << 3 << 2 << 1 << 0));
+
+	qDeleteAll(container);
+}
+
+void
+ObjectRefTest::testRemoveRanges()
+{
+	QVector<ObjectRef<RefItem>> container;
+	ObjectRef<RefItem>::insert(container, 0, createItems(&container, 0, 10));
+
+	RangeList ranges;
+	ranges << Range(1);
+	ranges << Range(3, 4);
+	ranges << Range(9);
+
+	QList<RefItem *> removed;
+	ObjectRef<RefItem>::removeRanges(container, ranges, &removed);
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 2 << 5 << 6 << 7 << 8));
+	QVERIFY(removed.size() == 4);
+	QVERIFY(removed.at(0)->id() == 1 && removed.at(1)->id() == 3 && removed.at(2)->id() == 4 && removed.at(3)->id() == 9);
+
+	ObjectRef<RefItem>::insertRanges(container, ranges, removed);
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9));
+
+	// every other item
+	ranges.clear();
+	for(int i = 0; i < 10; i += 2)
+		ranges << Range(i);
+	removed.clear();
+	ObjectRef<RefItem>::removeRanges(container, ranges, &removed);
+	QVERIFY(verifyContainer(container, QList<int>() << 1 << 3 << 5 << 7 << 9));
+
+	ObjectRef<RefItem>::insertRanges(container, ranges, removed);
+	QVERIFY(verifyContainer(container, QList<int>() << 0 << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << 9));
+
+	qDeleteAll(container);
+}
+
+void
+ObjectRefTest::benchmarkSplice_data()
+{
+	QTest::addColumn<int>("existing");
+	QTest::addColumn<int>("inserted");
+
+	QTest::newRow("100k cues into empty") << 0 << 100000;
+	QTest::newRow("1M cues into empty") << 0 << 1000000;
+	QTest::newRow("100k cues into middle of 100k") << 100000 << 100000;
+	QTest::newRow("1M cues into middle of 1M") << 1000000 << 1000000;
+}
+
+void
+ObjectRefTest::benchmarkSplice()
+{
+	QFETCH(int, existing);
+	QFETCH(int, inserted);
+
+	QVector<ObjectRef<RefItem>> container;
+	ObjectRef<RefItem>::insert(container, 0, createItems(&container, 0, existing));
+
+	const int index = existing / 2;
+	QList<RefItem *> items = createItems(&container, existing, inserted);
+
+	// same as InsertLinesAction redo() followed by undo()
+	QBENCHMARK {
+		ObjectRef<RefItem>::insert(container, index, items);
+		items.clear();
+		ObjectRef<RefItem>::remove(container, index, inserted, &items);
+	}
+
+	QVERIFY(container.size() == existing);
+	qDeleteAll(items);
+	qDeleteAll(container);
+}
+
+QTEST_GUILESS_MAIN(ObjectRefTest);
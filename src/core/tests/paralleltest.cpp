@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "paralleltest.h"
+#include "helpers/parallel.h"
+
+#include <QAtomicInt>
+#include <QStringList>
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+namespace {
+// state passes through items divisible by passEvery, other items decide it by their parity
+int
+step(int item, int passEvery, bool *state)
+{
+	const int result = item * 2 + (*state ? 1 : 0);
+	if(item % passEvery)
+		*state = item & 1;
+	return result;
+}
+
+QVector<int>
+randomItems(int count, int seed)
+{
+	qsrand(seed);
+	QVector<int> items(count);
+	for(int i = 0; i < count; i++)
+		items[i] = qrand() % 10000;
+	return items;
+}
+
+QStringList
+sentences(int count)
+{
+	QStringList lines;
+	for(int i = 0; i < count; i++)
+		lines << QStringLiteral("this is line %1. and it goes on and on %2").arg(i).arg(i % 3 ? QStringLiteral("...") : QStringLiteral("!"));
+	return lines;
+}
+
+QString
+sentenceCase(const QString &text, bool *cont)
+{
+	QString ret = text.toLower();
+	bool startSentence = !*cont;
+	for(int i = 0, n = ret.length(); i < n; i++) {
+		const QChar chr = ret.at(i);
+		if(chr == QLatin1Char('.') || chr == QLatin1Char('!') || chr == QLatin1Char('?')) {
+			startSentence = true;
+		} else if(startSentence && chr.isLetterOrNumber()) {
+			ret[i] = chr.toUpper();
+			startSentence = false;
+		}
+	}
+	*cont = !startSentence;
+	return ret;
+}
+}
+
+void
+ParallelTest::testForEach_data()
+{
+	QTest::addColumn<int>("count");
+
+	QTest::newRow("empty") << 0;
+	QTest::newRow("single") << 1;
+	QTest::newRow("small") << 100;
+	QTest::newRow("large") << 100000;
+}
+
+void
+ParallelTest::testForEach()
+{
+	QFETCH(int, count);
+
+	QVector<QAtomicInt> visits(count);
+	QAtomicInt *visit = visits.data();
+	Parallel::forEach(count, [&](int i){ visit[i].ref(); });
+
+	for(int i = 0; i < count; i++)
+		QCOMPARE(visits.at(i).load(), 1);
+}
+
+void
+ParallelTest::testOrderedScan_data()
+{
+	QTest::addColumn<int>("count");
+	QTest::addColumn<int>("segmentSize");
+	QTest::addColumn<int>("passEvery");
+
+	QTest::newRow("empty") << 0 << 10 << 3;
+	QTest::newRow("single") << 1 << 10 << 3;
+	QTest::newRow("one segment") << 100000 << 100000 << 3;
+	QTest::newRow("many segments") << 100000 << 37 << 3;
+	QTest::newRow("long carries") << 100000 << 100000 << 1000;
+	QTest::newRow("state never decided") << 20000 << 5000 << 1;
+}
+
+void
+ParallelTest::testOrderedScan()
+{
+	QFETCH(int, count);
+	QFETCH(int, segmentSize);
+	QFETCH(int, passEvery);
+
+	const QVector<int> items = randomItems(count, count + segmentSize);
+	auto segmentStart = [&](int i, bool *state){
+		if(i % segmentSize)
+			return false;
+		*state = (i / segmentSize) & 1;
+		return true;
+	};
+
+	QVector<int> expected(count);
+	bool state = false;
+	for(int i = 0; i < count; i++) {
+		segmentStart(i, &state);
+		expected[i] = step(items.at(i), passEvery, &state);
+	}
+
+	QVector<int> results(count);
+	Parallel::orderedScan(count, results.data(), [&](int i, bool *state){ return step(items.at(i), passEvery, state); }, segmentStart);
+
+	QCOMPARE(results, expected);
+}
+
+void
+ParallelTest::benchmarkOrderedScan_data()
+{
+	QTest::addColumn<bool>("parallel");
+
+	QTest::newRow("serial") << false;
+	QTest::newRow("parallel") << true;
+}
+
+void
+ParallelTest::benchmarkOrderedScan()
+{
+	QFETCH(bool, parallel);
+
+	const QStringList lines = sentences(50000);
+	const int count = lines.size();
+	QVector<QString> results(count);
+
+	QBENCHMARK {
+		if(parallel) {
+			Parallel::orderedScan(count, results.data(), [&](int i, bool *cont){ return sentenceCase(lines.at(i), cont); },
+				[](int i, bool *cont){
+					if(i)
+						return false;
+					*cont = false;
+					return true;
+				});
+		} else {
+			bool cont = false;
+			for(int i = 0; i < count; i++)
+				results[i] = sentenceCase(lines.at(i), &cont);
+		}
+	}
+}
+
+QTEST_GUILESS_MAIN(ParallelTest);
@@ -25,6 +25,16 @@
 
 using namespace SubtitleComposer;
 
+// every other index selected, the worst case for a list of ranges
+static RangeList
+fragmentedRanges(int rangeCount, int offset = 0)
+{
+	RangeList ranges;
+	for(int i = 0; i < rangeCount; i++)
+		ranges << Range(offset + i * 2);
+	return ranges;
+}
+
 void
 RangeListTest::testConstructors()
 {
@@ -92,4 +102,145 @@ RangeListTest::testJoinAndTrim()
 	QVERIFY(ranges.rangesCount() == 1 && ranges.indexesCount() == 5);
 }
 
+void
+RangeListTest::testContains()
+{
+	RangeList ranges;
+	ranges << Range(20, 29);
+	ranges << Range(0, 4);   // lower than the first range
+	ranges << Range(10, 12);
+	QVERIFY(ranges.rangesCount() == 3);
+	QVERIFY(ranges.range(0) == Range(0, 4));
+	QVERIFY(ranges.range(1) == Range(10, 12));
+	QVERIFY(ranges.range(2) == Range(20, 29));
+
+	QVERIFY(ranges.contains(0));
+	QVERIFY(ranges.contains(4));
+	QVERIFY(!ranges.contains(5));
+	QVERIFY(!ranges.contains(9));
+	QVERIFY(ranges.contains(11));
+	QVERIFY(!ranges.contains(13));
+	QVERIFY(ranges.contains(29));
+	QVERIFY(!ranges.contains(30));
+	QVERIFY(!ranges.contains(Range::MaxIndex));
+
+	ranges << Range(5, 9);
+	QVERIFY(ranges.rangesCount() == 2);
+	QVERIFY(ranges.contains(7));
+
+	ranges << Range(Range::MaxIndex);
+	QVERIFY(ranges.contains(Range::MaxIndex));
+	QVERIFY(!ranges.contains(Range::MaxIndex - 1));
+}
+
+void
+RangeListTest::testSetOperations()
+{
+	RangeList ranges;
+	ranges << Range(0, 4);
+	ranges << Range(10, 14);
+
+	RangeList ranges2;
+	ranges2 << Range(3, 6);
+	ranges2 << Range(8, 9);
+	ranges2 << Range(20, 21);
+
+	RangeList united = ranges.united(ranges2);
+	QVERIFY(united.inspect() == QLatin1String("[0,6], [8,14], [20,21]"));
+	QVERIFY(united == ranges2.united(ranges));
+
+	RangeList intersected = ranges.intersected(ranges2);
+	QVERIFY(intersected.inspect() == QLatin1String("[3,4]"));
+	QVERIFY(intersected == ranges2.intersected(ranges));
+
+	QVERIFY(ranges.intersected(ranges.complement()).isEmpty());
+	QVERIFY(ranges.united(ranges.complement()).isFullRange());
+	QVERIFY(ranges.complement().complement() == ranges);
+}
+
+void
+RangeListTest::testShift()
+{
+	RangeList ranges;
+	ranges << Range(0, 4);
+	ranges << Range(10, 14);
+
+	RangeList split(ranges);
+	split.shiftIndexesForwards(2, 3, false);
+	QVERIFY(split.inspect() == QLatin1String("[0,1], [5,7], [13,17]"));
+
+	RangeList filled(ranges);
+	filled.shiftIndexesForwards(2, 3, true);
+	QVERIFY(filled.inspect() == QLatin1String("[0,7], [13,17]"));
+
+	ranges.shiftIndexesBackwards(5, 10);
+	QVERIFY(ranges.inspect() == QLatin1String("[0,4]"));
+}
+
+void
+RangeListTest::benchmarkContains_data()
+{
+	QTest::addColumn<int>("rangeCount");
+
+	QTest::newRow("1k ranges") << 1000;
+	QTest::newRow("100k ranges") << 100000;
+}
+
+void
+RangeListTest::benchmarkContains()
+{
+	QFETCH(int, rangeCount);
+
+	const RangeList ranges = fragmentedRanges(rangeCount);
+
+	int found = 0;
+	QBENCHMARK {
+		found = 0;
+		for(int i = 0, n = rangeCount * 2; i < n; i++) {
+			if(ranges.contains(i))
+				found++;
+		}
+	}
+	QCOMPARE(found, rangeCount);
+}
+
+void
+RangeListTest::benchmarkInsert_data()
+{
+	QTest::addColumn<int>("rangeCount");
+	QTest::addColumn<bool>("reversed");
+
+	QTest::newRow("100k ranges in order") << 100000 << false;
+	QTest::newRow("10k ranges reversed") << 10000 << true;
+}
+
+void
+RangeListTest::benchmarkInsert()
+{
+	QFETCH(int, rangeCount);
+	QFETCH(bool, reversed);
+
+	RangeList ranges;
+	QBENCHMARK {
+		ranges.clear();
+		for(int i = 0; i < rangeCount; i++)
+			ranges << Range((reversed ? rangeCount - i - 1 : i) * 2);
+	}
+	QCOMPARE(ranges.rangesCount(), rangeCount);
+}
+
+void
+RangeListTest::benchmarkUnited()
+{
+	const RangeList ranges = fragmentedRanges(100000);
+	const RangeList ranges2 = fragmentedRanges(100000, 1);
+
+	RangeList united;
+	QBENCHMARK {
+		united = ranges.united(ranges2);
+	}
+	QVERIFY(united.rangesCount() == 1);
+	QCOMPARE(united.indexesCount(), 200000);
+}
+
 QTEST_GUILESS_MAIN(RangeListTest);
@@ -29,6 +29,15 @@ class RangeListTest : public QObject
 private slots:
 	void testConstructors();
 	void testJoinAndTrim();
+	void testContains();
+	void testSetOperations();
+	void testShift();
+
+	void benchmarkContains_data();
+	void benchmarkContains();
+	void benchmarkInsert_data();
+	void benchmarkInsert();
+	void benchmarkUnited();
 };
 
 #endif
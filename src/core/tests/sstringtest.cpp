@@ -24,9 +24,122 @@
 #include <QTest>                               // krazy:exclude=c++/includes
 
 #include <QDebug>
+#include <QColor>
+#include <QRegExp>
+
+#include <new>
+#include <cstdlib>
 
 using namespace SubtitleComposer;
 
+// count heap allocations made through operator new, style storage is allocated that way
+static int s_allocations = 0;
+
+void *
+operator new(std::size_t size)
+{
+	s_allocations++;
+	if(void *ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void
+operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void
+operator delete(void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+
+static SString
+styledString(int length)
+{
+	SString sstring(QString(length, QChar('x')));
+	for(int i = 0; i < length; i += 7)
+		sstring.setStyleFlags(i, 3, SString::Italic);
+	return sstring;
+}
+
+// setRichString() implementation prior to the tag scanner, kept for comparison
+static SString
+setRichStringRegExp(const QString &string)
+{
+	QRegExp tagRegExp("<(/?([bBiIuUsS]|font))[^>]*(\\s+color=\"?([\\w#]+)\"?)?[^>]*>");
+
+	SString ret;
+
+	int currentStyle = 0;
+	QColor currentColor;
+	int offsetPos = 0, matchedPos;
+	while((matchedPos = tagRegExp.indexIn(string, offsetPos)) != -1) {
+		QString matched(tagRegExp.cap(1).toLower());
+
+		int newStyle = currentStyle;
+		QColor newColor(currentColor);
+
+		if(matched == QLatin1String("b")) {
+			newStyle |= SString::Bold;
+		} else if(matched == QLatin1String("i")) {
+			newStyle |= SString::Italic;
+		} else if(matched == QLatin1String("u")) {
+			newStyle |= SString::Underline;
+		} else if(matched == QLatin1String("s")) {
+			newStyle |= SString::StrikeThrough;
+		} else if(matched == QLatin1String("font")) {
+			const QString &color = tagRegExp.cap(4);
+			if(!color.isEmpty()) {
+				newStyle |= SString::Color;
+				newColor.setNamedColor(color.toLower());
+			}
+		} else if(matched == QLatin1String("/b")) {
+			newStyle &= ~SString::Bold;
+		} else if(matched == QLatin1String("/i")) {
+			newStyle &= ~SString::Italic;
+		} else if(matched == QLatin1String("/u")) {
+			newStyle &= ~SString::Underline;
+		} else if(matched == QLatin1String("/s")) {
+			newStyle &= ~SString::StrikeThrough;
+		} else if(matched == QLatin1String("/font")) {
+			newStyle &= ~SString::Color;
+			newColor.setNamedColor("-invalid-");
+		}
+
+		QString token(string.mid(offsetPos, matchedPos - offsetPos));
+		ret.append(SString(token, currentStyle, currentColor.isValid() ? currentColor.rgb() : 0));
+		currentStyle = newStyle;
+		currentColor = newColor;
+
+		offsetPos = matchedPos + tagRegExp.cap(0).length();
+	}
+
+	QString token(string.mid(offsetPos, matchedPos - offsetPos));
+	ret.append(SString(token, currentStyle, currentColor.isValid() ? currentColor.rgb() : 0));
+
+	return ret;
+}
+
+static QStringList
+richTextLines(int count)
+{
+	const QStringList samples = {
+		QStringLiteral("Plain line of dialogue without any markup"),
+		QStringLiteral("<i>Italic narration that spans\nmultiple lines</i>"),
+		QStringLiteral("- <b>Bold</b> and <u>underlined</u> words\n- <S>Struck</S> reply"),
+		QStringLiteral("<i>Nested <b>bold <u>and underlined</u></b> text</i>"),
+		QStringLiteral("Comparison a < b and b > c stays plain"),
+		QStringLiteral("Unterminated <b tag at the end"),
+	};
+	QStringList lines;
+	for(int i = 0; i < count; i++)
+		lines << samples.at(i % samples.size());
+	return lines;
+}
+
 void
 SStringTest::testStyleFlags()
 {
@@ -132,6 +245,16 @@ SStringTest::testInsert()
 	sstring.insert(5, 'i');
 	QVERIFY(sstring.richString() == QLatin1String("<i>abc</i><u>ghi</u><b>xyz</b>"));
 
+	const QString chars = QStringLiteral("jkl");
+	sstring.append(chars.constData(), 1, SString::Bold, 0);
+	QVERIFY(sstring.richString() == QLatin1String("<i>abc</i><u>ghi</u><b>xyzj</b>"));
+	sstring.append(chars.constData() + 1, 2, 0, 0);
+	QVERIFY(sstring.richString() == QLatin1String("<i>abc</i><u>ghi</u><b>xyzj</b>kl"));
+	const SString copy(sstring);
+	sstring.append(chars.constData(), 1, SString::Italic, 0);
+	QVERIFY(sstring.richString() == QLatin1String("<i>abc</i><u>ghi</u><b>xyzj</b>kl<i>j</i>"));
+	QVERIFY(copy.richString() == QLatin1String("<i>abc</i><u>ghi</u><b>xyzj</b>kl"));
+
 	sstring.clear();
 	QVERIFY(sstring == SString());
 }
@@ -297,4 +420,236 @@ SStringTest::testReplace()
 	QVERIFY(sstring.richString() == QLatin1String("b<b>a</b>b"));
 }
 
+void
+SStringTest::testSharedStyles()
+{
+	SString sstring;
+	sstring.setRichString("<b>012</b><i>345</i>6789");
+
+	SString copy(sstring);
+	copy.setStyleFlagsAt(0, SString::Underline);
+	QVERIFY(copy.richString() == QLatin1String("<u>0</u><b>12</b><i>345</i>6789"));
+	QVERIFY(sstring.richString() == QLatin1String("<b>012</b><i>345</i>6789"));
+
+	SString assigned;
+	assigned = sstring;
+	QVERIFY(!(assigned != sstring));
+	assigned.setStyleColor(6, 4, 0xff0000);
+	QVERIFY(assigned != sstring);
+	QVERIFY(sstring.richString() == QLatin1String("<b>012</b><i>345</i>6789"));
+
+	copy = sstring;
+	copy.insert(3, QStringLiteral("ab"));
+	QVERIFY(copy.richString() == QLatin1String("<b>012ab</b><i>345</i>6789"));
+	QVERIFY(sstring.richString() == QLatin1String("<b>012</b><i>345</i>6789"));
+
+	copy = sstring;
+	copy.setStyleFlags(0, -1, SString::Bold, false);
+	QVERIFY(copy.richString() == QLatin1String("012<i>345</i>6789"));
+	QVERIFY(sstring.richString() == QLatin1String("<b>012</b><i>345</i>6789"));
+
+	SString moved(std::move(copy));
+	QVERIFY(moved.richString() == QLatin1String("012<i>345</i>6789"));
+	QVERIFY(copy.isEmpty());
+
+	copy = std::move(moved);
+	QVERIFY(copy.richString() == QLatin1String("012<i>345</i>6789"));
+	copy.setStyleFlagsAt(9, SString::StrikeThrough);
+	QVERIFY(copy.richString() == QLatin1String("012<i>345</i>678<s>9</s>"));
+}
+
+void
+SStringTest::testDataStream()
+{
+	SString sstring;
+	sstring.setRichString("<b>012</b><i>3<font color=#ff0000>45</font></i>6789");
+
+	QByteArray data;
+	{
+		QDataStream stream(&data, QIODevice::WriteOnly);
+		stream << sstring;
+	}
+	QCOMPARE(data.size(), int(sizeof(quint32) + 10 * sizeof(QChar) + 10 * (sizeof(char) + sizeof(QRgb))));
+
+	SString read;
+	{
+		QDataStream stream(&data, QIODevice::ReadOnly);
+		stream >> read;
+	}
+	QVERIFY(read == sstring);
+	QVERIFY(read.richString() == sstring.richString());
+}
+
+void
+SStringTest::testSetRichString()
+{
+	SString sstring;
+
+	sstring.setRichString("<b>012</b><I>345</I><u>678</u><s>9</s>");
+	QVERIFY(sstring.richString() == QLatin1String("<b>012</b><i>345</i><u>678</u><s>9</s>"));
+
+	sstring.setRichString("<font color=\"#00ff00\">green</font> <font color=#f00>red</font> <font color='blue'>blue</font>");
+	QCOMPARE(sstring.styleColorAt(0), QColor(Qt::green).rgb());
+	QCOMPARE(sstring.styleColorAt(6), QColor(Qt::red).rgb());
+	QCOMPARE(sstring.styleColorAt(10), QColor(Qt::blue).rgb());
+	QCOMPARE(sstring.styleColorAt(5), QRgb(0));
+	QVERIFY(sstring.string() == QLatin1String("green red blue"));
+
+	sstring.setRichString("<font>plain</font><br>");
+	QVERIFY(sstring.richString() == QLatin1String("plain&lt;br&gt;"));
+
+	// part of a document
+	const QString document = QStringLiteral("1\n<i>first</i>\n\n2\n<b>second</b> line\n");
+	sstring.setRichString(document.constData() + 18, 18);
+	QVERIFY(sstring.richString() == QLatin1String("<b>second</b> line"));
+
+	for(const QString &line : richTextLines(6)) {
+		sstring.setRichString(line);
+		QVERIFY(sstring == setRichStringRegExp(line));
+	}
+}
+
+void
+SStringTest::benchmarkCopy_data()
+{
+	QTest::addColumn<int>("length");
+
+	QTest::newRow("64 chars") << 64;
+	QTest::newRow("4k chars") << 4096;
+}
+
+void
+SStringTest::benchmarkCopy()
+{
+	QFETCH(int, length);
+
+	const SString sstring = styledString(length);
+
+	int allocations = s_allocations;
+	for(int i = 0; i < 1000; i++) {
+		SString copy(sstring);
+		SString assigned;
+		assigned = copy;
+	}
+	QCOMPARE(s_allocations - allocations, 0);
+
+	QBENCHMARK {
+		SString copy(sstring);
+		SString assigned;
+		assigned = copy;
+	}
+}
+
+void
+SStringTest::benchmarkMove_data()
+{
+	benchmarkCopy_data();
+}
+
+void
+SStringTest::benchmarkMove()
+{
+	QFETCH(int, length);
+
+	SString sstring = styledString(length);
+
+	int allocations = s_allocations;
+	for(int i = 0; i < 1000; i++) {
+		SString moved(std::move(sstring));
+		sstring = std::move(moved);
+	}
+	QCOMPARE(s_allocations - allocations, 0);
+	QCOMPARE(sstring.length(), length);
+
+	QBENCHMARK {
+		SString moved(std::move(sstring));
+		sstring = std::move(moved);
+	}
+}
+
+void
+SStringTest::benchmarkDetach_data()
+{
+	benchmarkCopy_data();
+}
+
+void
+SStringTest::benchmarkDetach()
+{
+	QFETCH(int, length);
+
+	const SString sstring = styledString(length);
+
+	// only the first write to a copy allocates
+	int allocations = s_allocations;
+	SString copy(sstring);
+	copy.setStyleFlagsAt(0, SString::Bold);
+	copy.setStyleFlagsAt(1, SString::Bold);
+	copy.setStyleColorAt(2, 0xff0000);
+	QCOMPARE(s_allocations - allocations, 1);
+	QVERIFY(sstring.styleFlagsAt(0) == SString::Italic);
+
+	QBENCHMARK {
+		SString copy(sstring);
+		copy.setStyleFlagsAt(0, SString::Bold);
+	}
+}
+
+void
+SStringTest::benchmarkRichString_data()
+{
+	QTest::addColumn<int>("length");
+
+	QTest::newRow("64 chars") << 64;
+	QTest::newRow("4k chars") << 4096;
+	QTest::newRow("64k chars") << 65536;
+}
+
+void
+SStringTest::benchmarkRichString()
+{
+	QFETCH(int, length);
+
+	const SString sstring = styledString(length);
+
+	QString richString;
+	QBENCHMARK {
+		richString = sstring.richString();
+	}
+
+	SString parsed;
+	parsed.setRichString(richString);
+	QVERIFY(parsed == sstring);
+}
+
+void
+SStringTest::benchmarkSetRichString_data()
+{
+	QTest::addColumn<bool>("regExp");
+
+	QTest::newRow("1000 lines regexp") << true;
+	QTest::newRow("1000 lines scanner") << false;
+}
+
+void
+SStringTest::benchmarkSetRichString()
+{
+	QFETCH(bool, regExp);
+
+	const QStringList lines = richTextLines(1000);
+
+	SString sstring;
+	if(regExp) {
+		QBENCHMARK {
+			for(const QString &line : lines)
+				sstring = setRichStringRegExp(line);
+		}
+	} else {
+		QBENCHMARK {
+			for(const QString &line : lines)
+				sstring.setRichString(line);
+		}
+	}
+}
+
 QTEST_GUILESS_MAIN(SStringTest);
@@ -32,6 +32,20 @@ private slots:
 	void testLeftMidRight();
 	void testInsert();
 	void testReplace();
+	void testSharedStyles();
+	void testDataStream();
+	void testSetRichString();
+
+	void benchmarkCopy_data();
+	void benchmarkCopy();
+	void benchmarkMove_data();
+	void benchmarkMove();
+	void benchmarkDetach_data();
+	void benchmarkDetach();
+	void benchmarkRichString_data();
+	void benchmarkRichString();
+	void benchmarkSetRichString_data();
+	void benchmarkSetRichString();
 };
 
 #endif
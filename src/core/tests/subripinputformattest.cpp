@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "subripinputformattest.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "formats/subrip/subripinputformat.h"
+#include "formats/textreader.h"
+
+#include <QBuffer>
+#include <QTextCodec>
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+namespace {
+// format constructors are only accessible to FormatManager and to derived classes
+class SubRipInput : public SubRipInputFormat
+{
+public:
+	SubRipInput() {}
+};
+}
+
+void
+SubRipInputFormatTest::testLenientInput_data()
+{
+	QTest::addColumn<QString>("data");
+	QTest::addColumn<double>("showTime");
+	QTest::addColumn<double>("hideTime");
+	QTest::addColumn<QString>("text");
+
+	QTest::newRow("plain") << QStringLiteral("1\n00:00:01,000 --> 00:00:02,500\nText\n\n") << 1000. << 2500. << QStringLiteral("Text");
+	QTest::newRow("dot separator") << QStringLiteral("1\n00:00:01.000 --> 00:00:02.500\nText\n") << 1000. << 2500. << QStringLiteral("Text");
+	QTest::newRow("spaces") << QStringLiteral("1 \n 00:00:01,000  -->\t00:00:02,500 \nText\n") << 1000. << 2500. << QStringLiteral("Text");
+	QTest::newRow("coordinates") << QStringLiteral("1\n00:00:01,000 --> 00:00:02,500 X1:100 X2:200 Y1:10 Y2:20\nText\n") << 1000. << 2500. << QStringLiteral("Text");
+	QTest::newRow("misdecoded bom") << QString::fromLatin1("\xEF\xBB\xBF" "1\n00:00:01,000 --> 00:00:02,500\nText\n") << 1000. << 2500. << QStringLiteral("Text");
+	QTest::newRow("hour digits") << QStringLiteral("1\n001:02:03,000 --> 0001:02:04,500\nText\n") << 3723000. << 3724500. << QStringLiteral("Text");
+	QTest::newRow("multiline text") << QStringLiteral("1\n00:00:01,000 --> 00:00:02,500\n  First\nSecond  \n\n\n") << 1000. << 2500. << QStringLiteral("First\nSecond");
+	QTest::newRow("text at eof") << QStringLiteral("1\n00:00:01,000 --> 00:00:02,500\nText") << 1000. << 2500. << QStringLiteral("Text");
+	QTest::newRow("time line at eof") << QStringLiteral("1\n00:00:01,000 --> 00:00:02,500") << 1000. << 2500. << QString();
+}
+
+void
+SubRipInputFormatTest::testLenientInput()
+{
+	QFETCH(QString, data);
+	QFETCH(double, showTime);
+	QFETCH(double, hideTime);
+	QFETCH(QString, text);
+
+	Subtitle subtitle;
+	QVERIFY(SubRipInput().readSubtitle(subtitle, true, data));
+	QCOMPARE(subtitle.linesCount(), 1);
+	QCOMPARE(subtitle.at(0)->showTime().toMillis(), showTime);
+	QCOMPARE(subtitle.at(0)->hideTime().toMillis(), hideTime);
+	QCOMPARE(subtitle.at(0)->primaryText().string(), text);
+}
+
+void
+SubRipInputFormatTest::testNumberOverflow()
+{
+	// a cue whose hours don't fit an int is not a cue
+	const QString data = QStringLiteral(
+		"1\n99999999999999999999:00:01,000 --> 99999999999999999999:00:02,000\nFirst\n\n"
+		"2\n00:00:03,000 --> 00:00:04,000\nSecond\n");
+
+	Subtitle subtitle;
+	QVERIFY(SubRipInput().readSubtitle(subtitle, true, data));
+	QCOMPARE(subtitle.linesCount(), 1);
+	QCOMPARE(subtitle.at(0)->showTime().toMillis(), 3000.);
+	QCOMPARE(subtitle.at(0)->primaryText().string(), QStringLiteral("Second"));
+}
+
+void
+SubRipInputFormatTest::testChunks_data()
+{
+	QTest::addColumn<int>("chunkSize");
+
+	for(int chunkSize : { 1, 2, 3, 5, 8, 13, 64 })
+		QTest::newRow(qPrintable(QString::number(chunkSize))) << chunkSize;
+}
+
+void
+SubRipInputFormatTest::testChunks()
+{
+	QFETCH(int, chunkSize);
+
+	// the head FormatManager sniffs holds the first cue, the rest is decoded in chunks
+	QString data = QStringLiteral("1\n00:00:01,000 --> 00:00:02,000\nFirst\n\n");
+	QByteArray bytes = QByteArrayLiteral(
+		"2\r\n00:00:03,000 --> 00:00:04,000\r\nSecond\r\nrow\r\n\r\n"
+		"3\r\n00:00:05,000 --> 00:00:06,000\r\nL\xC3\xADnea \xE2\x80\x94 tres");
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	TextReader reader(&buffer, QTextCodec::codecForName("UTF-8"), chunkSize);
+
+	Subtitle subtitle;
+	QVERIFY(SubRipInput().readSubtitle(subtitle, true, reader, data));
+	QCOMPARE(subtitle.linesCount(), 3);
+	QCOMPARE(subtitle.at(0)->primaryText().string(), QStringLiteral("First"));
+	QCOMPARE(subtitle.at(1)->showTime().toMillis(), 3000.);
+	QCOMPARE(subtitle.at(1)->hideTime().toMillis(), 4000.);
+	QCOMPARE(subtitle.at(1)->primaryText().string(), QStringLiteral("Second\nrow"));
+	QCOMPARE(subtitle.at(2)->showTime().toMillis(), 5000.);
+	QCOMPARE(subtitle.at(2)->hideTime().toMillis(), 6000.);
+	QCOMPARE(subtitle.at(2)->primaryText().string(), QString::fromUtf8("L\xC3\xADnea \xE2\x80\x94 tres"));
+}
+
+QTEST_GUILESS_MAIN(SubRipInputFormatTest);
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "substationalphatexttest.h"
+#include "core/sstring.h"
+#include "formats/substationalpha/substationalphatext.h"
+
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+void
+SubStationAlphaTextTest::testOverrides_data()
+{
+	QTest::addColumn<QString>("data");
+	QTest::addColumn<QString>("text");
+	QTest::addColumn<QString>("styles");
+
+	// styles holds one character per character of text: 'i' italic, 'b' bold, '-' plain
+	QTest::newRow("italic") << QStringLiteral("{\\i1}a{\\i0}b") << QStringLiteral("ab") << QStringLiteral("i-");
+	QTest::newRow("reset") << QStringLiteral("{\\i1}a{\\r}b") << QStringLiteral("ab") << QStringLiteral("i-");
+	QTest::newRow("reset to style") << QStringLiteral("{\\i1}a{\\rDefault}b") << QStringLiteral("ab") << QStringLiteral("i-");
+	QTest::newRow("reset then tag") << QStringLiteral("{\\i1}a{\\rAlt\\b1}b") << QStringLiteral("ab") << QStringLiteral("ib");
+	QTest::newRow("line breaks") << QStringLiteral("{\\b1}a\\Nb\\hc") << QStringLiteral("a\nb c") << QStringLiteral("bbbbb");
+}
+
+void
+SubStationAlphaTextTest::testOverrides()
+{
+	QFETCH(QString, data);
+	QFETCH(QString, text);
+	QFETCH(QString, styles);
+
+	const SString string = SubStationAlphaText::toSString(data);
+	QCOMPARE(string.string(), text);
+	for(int i = 0; i < text.length(); i++) {
+		const int flags = string.styleFlagsAt(i);
+		const QChar style = flags & SString::Italic ? 'i' : (flags & SString::Bold ? 'b' : '-');
+		QCOMPARE(style, styles.at(i));
+	}
+}
+
+QTEST_GUILESS_MAIN(SubStationAlphaTextTest)
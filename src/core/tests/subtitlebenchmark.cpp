@@ -0,0 +1,618 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "subtitlebenchmark.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "formats/microdvd/microdvdinputformat.h"
+#include "formats/microdvd/microdvdoutputformat.h"
+#include "formats/mplayer/mplayerinputformat.h"
+#include "formats/mplayer/mplayeroutputformat.h"
+#include "formats/mplayer2/mplayer2inputformat.h"
+#include "formats/mplayer2/mplayer2outputformat.h"
+#include "formats/subrip/subripinputformat.h"
+#include "formats/subrip/subripoutputformat.h"
+#include "formats/substationalpha/substationalphainputformat.h"
+#include "formats/substationalpha/substationalphaoutputformat.h"
+#include "formats/subviewer1/subviewer1inputformat.h"
+#include "formats/subviewer1/subviewer1outputformat.h"
+#include "formats/subviewer2/subviewer2inputformat.h"
+#include "formats/subviewer2/subviewer2outputformat.h"
+#include "formats/tmplayer/tmplayerinputformat.h"
+#include "formats/tmplayer/tmplayeroutputformat.h"
+#include "formats/youtubecaptions/youtubecaptionsinputformat.h"
+#include "formats/youtubecaptions/youtubecaptionsoutputformat.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QTextCodec>
+#include <QTest>                               // krazy:exclude=c++/includes
+#include <QUndoStack>
+
+using namespace SubtitleComposer;
+
+// Sizes of the generated subtitles can be set with SUBTITLECOMPOSER_BENCHMARK_LINES, e.g.
+//   SUBTITLECOMPOSER_BENCHMARK_LINES=1000,10000,100000,1000000 ./core-subtitlebenchmark -o results.xml,xml
+
+namespace {
+// format constructors are only accessible to FormatManager and to derived classes
+template<class T>
+class FormatInstance : public T
+{
+public:
+	FormatInstance() {}
+};
+
+struct FormatPair {
+	QSharedPointer<InputFormat> input;
+	QSharedPointer<OutputFormat> output;
+};
+
+template<class Input, class Output>
+FormatPair
+formatPair()
+{
+	FormatPair format;
+	format.input.reset(new FormatInstance<Input>());
+	format.output.reset(new FormatInstance<Output>());
+	return format;
+}
+
+const QVector<FormatPair> &
+formats()
+{
+	static const QVector<FormatPair> formats = {
+		formatPair<MicroDVDInputFormat, MicroDVDOutputFormat>(),
+		formatPair<MPlayerInputFormat, MPlayerOutputFormat>(),
+		formatPair<MPlayer2InputFormat, MPlayer2OutputFormat>(),
+		formatPair<SubRipInputFormat, SubRipOutputFormat>(),
+		formatPair<SubStationAlphaInputFormat, SubStationAlphaOutputFormat>(),
+		formatPair<AdvancedSubStationAlphaInputFormat, AdvancedSubStationAlphaOutputFormat>(),
+		formatPair<SubViewer1InputFormat, SubViewer1OutputFormat>(),
+		formatPair<SubViewer2InputFormat, SubViewer2OutputFormat>(),
+		formatPair<TMPlayerInputFormat, TMPlayerOutputFormat>(),
+		formatPair<TMPlayerPlusInputFormat, TMPlayerPlusOutputFormat>(),
+		formatPair<YouTubeCaptionsInputFormat, YouTubeCaptionsOutputFormat>(),
+	};
+	return formats;
+}
+
+QVector<int>
+lineCounts()
+{
+	QVector<int> counts;
+	const QStringList values = QString::fromLocal8Bit(qgetenv("SUBTITLECOMPOSER_BENCHMARK_LINES")).split(QLatin1Char(','), QString::SkipEmptyParts);
+	foreach(const QString &value, values) {
+		bool ok;
+		const int count = value.trimmed().toInt(&ok);
+		if(ok && count > 0)
+			counts.append(count);
+	}
+	if(counts.isEmpty())
+		counts << 1000 << 10000;
+	return counts;
+}
+
+void
+generateSubtitle(Subtitle &subtitle, int count, bool styled, bool translated, bool shuffled = false)
+{
+	QList<SubtitleLine *> lines;
+	lines.reserve(count);
+	for(int i = 0; i < count; i++) {
+		// shuffled subtitles get their show times permuted
+		const int slot = shuffled ? int(qint64(i) * 7919 % count) : i;
+		const Time showTime(slot * 2000.);
+		// every 7th line overlaps with the next one
+		const Time hideTime(slot * 2000. + 1500. + (i % 7) * 100.);
+
+		SString primaryText(QStringLiteral("line %1 -  with some text to work on ...\nand a second row , that says \"i am here\"").arg(i));
+		if(styled) {
+			primaryText.setStyleFlags(0, 4, SString::Italic);
+			primaryText.setStyleFlags(15, 4, SString::Bold | SString::Underline);
+		}
+
+		SString secondaryText;
+		if(translated)
+			secondaryText = SString(QStringLiteral("línea %1 - con algo de texto...\ny una segunda fila").arg(i));
+
+		lines.append(new SubtitleLine(primaryText, secondaryText, showTime, hideTime));
+	}
+	subtitle.insertLines(lines);
+}
+
+void
+addSubtitleRows()
+{
+	QTest::addColumn<int>("lines");
+	QTest::addColumn<bool>("styled");
+	QTest::addColumn<bool>("translated");
+
+	foreach(int count, lineCounts()) {
+		QTest::newRow(qPrintable(QStringLiteral("%1 plain").arg(count))) << count << false << false;
+		QTest::newRow(qPrintable(QStringLiteral("%1 styled").arg(count))) << count << true << false;
+		QTest::newRow(qPrintable(QStringLiteral("%1 translated").arg(count))) << count << true << true;
+	}
+}
+
+void
+addFormatRows()
+{
+	QTest::addColumn<int>("format");
+	QTest::addColumn<int>("lines");
+	QTest::addColumn<bool>("styled");
+
+	for(int format = 0, n = formats().size(); format < n; format++) {
+		const QString name = formats().at(format).output->name();
+		foreach(int count, lineCounts()) {
+			QTest::newRow(qPrintable(QStringLiteral("%1 %2 plain").arg(name).arg(count))) << format << count << false;
+			QTest::newRow(qPrintable(QStringLiteral("%1 %2 styled").arg(name).arg(count))) << format << count << true;
+		}
+	}
+}
+
+// SubRip parser as it was before the hand-written scanner, kept as a baseline
+void
+parseSubRipRegExp(Subtitle &subtitle, const QString &data)
+{
+	static QRegExp regExp(QStringLiteral("[\\d]+\n([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+) --> ([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+)\n"));
+
+	int offset = regExp.indexIn(data, 0);
+	while(offset != -1) {
+		const Time showTime(regExp.cap(1).toInt(), regExp.cap(2).toInt(), regExp.cap(3).toInt(), regExp.cap(4).toInt());
+		const Time hideTime(regExp.cap(5).toInt(), regExp.cap(6).toInt(), regExp.cap(7).toInt(), regExp.cap(8).toInt());
+
+		const int textOffset = offset + regExp.matchedLength();
+		const int nextOffset = regExp.indexIn(data, textOffset);
+
+		SString stext;
+		stext.setRichString(data.mid(textOffset, (nextOffset == -1 ? data.length() : nextOffset) - textOffset).trimmed());
+
+		subtitle.insertLine(new SubtitleLine(stext, showTime, hideTime));
+
+		offset = nextOffset;
+	}
+}
+
+const int errorFlags = SubtitleLine::AllErrors & ~SubtitleLine::UserMark;
+}
+
+void
+SubtitleBenchmark::benchmarkReadFormat_data()
+{
+	addFormatRows();
+}
+
+void
+SubtitleBenchmark::benchmarkReadFormat()
+{
+	QFETCH(int, format);
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+
+	const FormatPair &formatPair = formats().at(format);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, false);
+	const QString data = formatPair.output->writeSubtitle(subtitle, true);
+
+	QBENCHMARK {
+		Subtitle readSubtitle;
+		formatPair.input->readSubtitle(readSubtitle, true, data);
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkWriteFormat_data()
+{
+	addFormatRows();
+}
+
+void
+SubtitleBenchmark::benchmarkWriteFormat()
+{
+	QFETCH(int, format);
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+
+	const FormatPair &formatPair = formats().at(format);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, false);
+
+	QString data;
+	QBENCHMARK {
+		data = formatPair.output->writeSubtitle(subtitle, true);
+	}
+	QVERIFY(!data.isEmpty());
+}
+
+void
+SubtitleBenchmark::benchmarkEncodeFormat_data()
+{
+	addFormatRows();
+}
+
+void
+SubtitleBenchmark::benchmarkEncodeFormat()
+{
+	QFETCH(int, format);
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+
+	const FormatPair &formatPair = formats().at(format);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, false);
+
+	// formatted and encoded in chunks, like when saving a file
+	QBuffer device;
+	QBENCHMARK {
+		device.open(QIODevice::WriteOnly | QIODevice::Truncate);
+		TextWriter writer(&device, QTextCodec::codecForName("UTF-8"));
+		QVERIFY(formatPair.output->writeSubtitle(subtitle, true, writer));
+		device.close();
+	}
+	QVERIFY(!device.data().isEmpty());
+}
+
+void
+SubtitleBenchmark::benchmarkParseSubRip_data()
+{
+	QTest::addColumn<bool>("regExp");
+	QTest::addColumn<int>("lines");
+	QTest::addColumn<bool>("styled");
+
+	foreach(int count, lineCounts()) {
+		QTest::newRow(qPrintable(QStringLiteral("regexp %1 plain").arg(count))) << true << count << false;
+		QTest::newRow(qPrintable(QStringLiteral("regexp %1 styled").arg(count))) << true << count << true;
+		QTest::newRow(qPrintable(QStringLiteral("scanner %1 plain").arg(count))) << false << count << false;
+		QTest::newRow(qPrintable(QStringLiteral("scanner %1 styled").arg(count))) << false << count << true;
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkParseSubRip()
+{
+	QFETCH(bool, regExp);
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, false);
+	const QString data = FormatInstance<SubRipOutputFormat>().writeSubtitle(subtitle, true);
+	const qint64 bytes = data.toUtf8().size();
+
+	const FormatInstance<SubRipInputFormat> input;
+
+	// throughput is reported as bytes of UTF-8 text parsed per second
+	int iterations = 0;
+	QElapsedTimer timer;
+	timer.start();
+	do {
+		Subtitle readSubtitle;
+		if(regExp)
+			parseSubRipRegExp(readSubtitle, data);
+		else
+			input.readSubtitle(readSubtitle, true, data);
+		QCOMPARE(readSubtitle.linesCount(), lines);
+		iterations++;
+	} while(timer.elapsed() < 1000);
+
+	QTest::setBenchmarkResult(qreal(bytes) * iterations * 1e9 / timer.nsecsElapsed(), QTest::BytesPerSecond);
+}
+
+void
+SubtitleBenchmark::benchmarkShiftLines_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkShiftLines()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	QBENCHMARK {
+		subtitle.shiftLines(Range::full(), 1000);
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkSortLines_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkSortLines()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated, true);
+
+	// sorting is done once, after that the lines are in order already
+	QBENCHMARK_ONCE {
+		subtitle.sortLines(Range::full());
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkJoinLines_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkJoinLines()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	// two of every three lines are joined, adjacent ranges would be merged into one
+	RangeList ranges;
+	for(int i = 0; i + 1 < lines; i += 3)
+		ranges << Range(i, i + 1);
+
+	QBENCHMARK_ONCE {
+		subtitle.joinLines(ranges);
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkSplitLines_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkSplitLines()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	// every line has two rows of text
+	QBENCHMARK_ONCE {
+		subtitle.splitLines(Range::full());
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkChangeCase_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkChangeCase()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	QBENCHMARK {
+		subtitle.upperCase(Range::full(), Subtitle::Both);
+		subtitle.sentenceCase(Range::full(), true, Subtitle::Both);
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkFixPunctuation_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkFixPunctuation()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	QBENCHMARK {
+		subtitle.fixPunctuation(Range::full(), true, true, true, true, Subtitle::Both);
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkDurations_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkDurations()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	QBENCHMARK {
+		subtitle.setAutoDurations(Range::full(), 60, 50, 100, false, Subtitle::Primary);
+		subtitle.applyDurationLimits(Range::full(), Time(1000.), Time(2500.), false);
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkCheckErrors_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkCheckErrors()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	QBENCHMARK {
+		subtitle.checqCriticals(Range::full(), errorFlags, 700, 6000, 50, 150, 40, 2);
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkRecheckErrors_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkRecheckErrors()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+	subtitle.checqCriticals(Range::full(), errorFlags, 700, 6000, 50, 150, 40, 2);
+	subtitle.rechecqCriticals(Range::full(), 700, 6000, 50, 150, 40, 2);
+
+	// a tenth of the lines changes between rechecks
+	RangeList ranges;
+	for(int i = 0; i < lines; i += 20)
+		ranges << Range(i);
+
+	QBENCHMARK {
+		subtitle.shiftLines(ranges, 1);
+		subtitle.rechecqCriticals(Range::full(), 700, 6000, 50, 150, 40, 2);
+	}
+}
+
+void
+SubtitleBenchmark::benchmarkRichString_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkRichString()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	int length = 0;
+	QBENCHMARK {
+		for(int i = 0; i < lines; i++) {
+			const SubtitleLine *line = subtitle.at(i);
+			length += line->primaryText().richString().length();
+			length += line->secondaryText().richString().length();
+		}
+	}
+	QVERIFY(length > 0);
+}
+
+void
+SubtitleBenchmark::benchmarkSetRichString_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkSetRichString()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	QStringList richTexts;
+	for(int i = 0; i < lines; i++) {
+		richTexts.append(subtitle.at(i)->primaryText().richString());
+		richTexts.append(subtitle.at(i)->secondaryText().richString());
+	}
+
+	int length = 0;
+	QBENCHMARK {
+		SString text;
+		foreach(const QString &richText, richTexts)
+			length += text.setRichString(richText).length();
+	}
+	QVERIFY(length > 0);
+}
+
+void
+SubtitleBenchmark::benchmarkUndoRedo_data()
+{
+	addSubtitleRows();
+}
+
+void
+SubtitleBenchmark::benchmarkUndoRedo()
+{
+	QFETCH(int, lines);
+	QFETCH(bool, styled);
+	QFETCH(bool, translated);
+
+	Subtitle subtitle;
+	generateSubtitle(subtitle, lines, styled, translated);
+
+	// destroyed before the subtitle, the actions reference its lines
+	QUndoStack undoStack;
+	subtitle.setUndoStack(&undoStack);
+	subtitle.shiftLines(Range::full(), 1000);
+	subtitle.upperCase(Range::full(), Subtitle::Both);
+	QCOMPARE(undoStack.count(), 2);
+
+	QBENCHMARK {
+		undoStack.undo();
+		undoStack.undo();
+		undoStack.redo();
+		undoStack.redo();
+	}
+}
+
+QTEST_GUILESS_MAIN(SubtitleBenchmark);
@@ -0,0 +1,67 @@
+#ifndef SUBTITLEBENCHMARK_H
+#define SUBTITLEBENCHMARK_H
+
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QObject>
+
+class SubtitleBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void benchmarkReadFormat_data();
+	void benchmarkReadFormat();
+	void benchmarkWriteFormat_data();
+	void benchmarkWriteFormat();
+	void benchmarkEncodeFormat_data();
+	void benchmarkEncodeFormat();
+	void benchmarkParseSubRip_data();
+	void benchmarkParseSubRip();
+
+	void benchmarkShiftLines_data();
+	void benchmarkShiftLines();
+	void benchmarkSortLines_data();
+	void benchmarkSortLines();
+	void benchmarkJoinLines_data();
+	void benchmarkJoinLines();
+	void benchmarkSplitLines_data();
+	void benchmarkSplitLines();
+	void benchmarkChangeCase_data();
+	void benchmarkChangeCase();
+	void benchmarkFixPunctuation_data();
+	void benchmarkFixPunctuation();
+	void benchmarkDurations_data();
+	void benchmarkDurations();
+	void benchmarkCheckErrors_data();
+	void benchmarkCheckErrors();
+	void benchmarkRecheckErrors_data();
+	void benchmarkRecheckErrors();
+
+	void benchmarkRichString_data();
+	void benchmarkRichString();
+	void benchmarkSetRichString_data();
+	void benchmarkSetRichString();
+
+	void benchmarkUndoRedo_data();
+	void benchmarkUndoRedo();
+};
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "subtitletest.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+
+#include <QTest>                               // krazy:exclude=c++/includes
+#include <QUndoStack>
+
+using namespace SubtitleComposer;
+
+void
+SubtitleTest::testRemoveAnchoredLine()
+{
+	QUndoStack undoStack;
+	Subtitle subtitle;
+	subtitle.setUndoStack(&undoStack);
+
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 4; i++)
+		lines.append(new SubtitleLine(QString::number(i), Time(i * 2000), Time(i * 2000 + 1000)));
+	subtitle.insertLines(lines);
+
+	subtitle.toggleLineAnchor(1);
+	subtitle.toggleLineAnchor(2);
+	QVERIFY(subtitle.isLineAnchored(1));
+	QVERIFY(subtitle.isLineAnchored(2));
+
+	subtitle.removeLines(RangeList(Range(1)), Subtitle::Both);
+	QCOMPARE(subtitle.linesCount(), 3);
+	QVERIFY(subtitle.hasAnchors());
+	QVERIFY(subtitle.isLineAnchored(1));
+
+	// undo brings the removed anchor back
+	undoStack.undo();
+	QCOMPARE(subtitle.linesCount(), 4);
+	QVERIFY(subtitle.isLineAnchored(1));
+	QVERIFY(subtitle.isLineAnchored(2));
+
+	undoStack.redo();
+	QCOMPARE(subtitle.linesCount(), 3);
+
+	// dropping the history deletes the removed line, the anchors must not reference it
+	undoStack.clear();
+	subtitle.shiftLines(Range::full(), 1000);
+	QCOMPARE(subtitle.at(1)->showTime().toMillis(), 5000.);
+	QVERIFY(subtitle.isLineAnchored(1));
+
+	subtitle.removeLines(RangeList(Range(1)), Subtitle::Both);
+	undoStack.clear();
+	QVERIFY(!subtitle.hasAnchors());
+	subtitle.shiftLines(Range::full(), 1000);
+	QCOMPARE(subtitle.at(1)->showTime().toMillis(), 8000.);
+}
+
+void
+SubtitleTest::testUndoCoalescesChanges()
+{
+	QUndoStack undoStack;
+	Subtitle subtitle;
+	subtitle.setUndoStack(&undoStack);
+
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 10; i++)
+		lines.append(new SubtitleLine(QString::number(i), Time(i * 2000), Time(i * 2000 + 1000)));
+	subtitle.insertLines(lines);
+
+	int signalCount = 0;
+	int changedCount = 0;
+	connect(&subtitle, &Subtitle::linesTimesChanged, [&](const RangeList &ranges){
+		signalCount++;
+		changedCount = ranges.indexesCount();
+	});
+
+	subtitle.shiftLines(Range::full(), 500);
+	QCOMPARE(signalCount, 1);
+
+	// the stack replays every line action of the composite action on its own
+	undoStack.undo();
+	QCOMPARE(signalCount, 2);
+	QCOMPARE(changedCount, 10);
+	QCOMPARE(subtitle.at(9)->showTime().toMillis(), 18000.);
+
+	undoStack.redo();
+	QCOMPARE(signalCount, 3);
+	QCOMPARE(subtitle.at(9)->showTime().toMillis(), 18500.);
+}
+
+void
+SubtitleTest::testSetPrimaryDataSortsLines()
+{
+	QUndoStack undoStack;
+	Subtitle subtitle;
+	subtitle.setUndoStack(&undoStack);
+
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 4; i++)
+		lines.append(new SubtitleLine(QString::number(i), Time(i * 2000), Time(i * 2000 + 1000)));
+	subtitle.insertLines(lines);
+
+	// the new data is not sorted by show time
+	Subtitle from;
+	const int showTimes[] = { 3000, 1000, 7000, 5000 };
+	QList<SubtitleLine *> fromLines;
+	for(int showTime : showTimes)
+		fromLines.append(new SubtitleLine(QString::number(showTime), Time(showTime), Time(showTime + 500)));
+	from.insertLines(fromLines);
+
+	subtitle.setPrimaryData(from, true);
+	QCOMPARE(subtitle.linesCount(), 4);
+	for(int i = 0; i < 4; i++) {
+		QCOMPARE(subtitle.at(i)->showTime().toMillis(), i * 2000. + 1000.);
+		QCOMPARE(subtitle.at(i)->primaryText().string(), QString::number(i * 2000 + 1000));
+	}
+
+	undoStack.undo();
+	for(int i = 0; i < 4; i++) {
+		QCOMPARE(subtitle.at(i)->showTime().toMillis(), i * 2000.);
+		QCOMPARE(subtitle.at(i)->primaryText().string(), QString::number(i));
+	}
+}
+
+void
+SubtitleTest::testTimeIndexFollowsLineTimes()
+{
+	Subtitle subtitle;
+
+	QList<SubtitleLine *> lines;
+	for(int i = 0; i < 5; i++)
+		lines.append(new SubtitleLine(QString::number(i), Time(i * 2000), Time(i * 2000 + 1000)));
+	subtitle.insertLines(lines);
+
+	QCOMPARE(subtitle.linesInTimeRange(Time(0), Time(10000)).count(), 5);
+
+	// a longer hide time raises the running maximum of the following entries
+	lines.at(1)->setHideTime(Time(8500));
+	QCOMPARE(subtitle.linesInTimeRange(Time(7500), Time(7600)), QList<SubtitleLine *>() << lines.at(1));
+	QCOMPARE(subtitle.firstLineHiddenAfter(Time(5500)), lines.at(1));
+
+	lines.at(1)->setHideTime(Time(3000));
+	QVERIFY(subtitle.linesInTimeRange(Time(7500), Time(7600)).isEmpty());
+	QCOMPARE(subtitle.firstLineHiddenAfter(Time(5500)), lines.at(3));
+
+	// the line moves past the others
+	lines.at(0)->setTimes(Time(8500), Time(8800));
+	QCOMPARE(subtitle.at(4), lines.at(0));
+	QCOMPARE(subtitle.linesInTimeRange(Time(8600), Time(8700)), QList<SubtitleLine *>() << lines.at(4) << lines.at(0));
+	QVERIFY(subtitle.linesInTimeRange(Time(0), Time(1500)).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(SubtitleTest)
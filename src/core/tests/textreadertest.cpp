@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "textreadertest.h"
+#include "core/subtitle.h"
+#include "core/subtitleline.h"
+#include "formats/subviewer1/subviewer1inputformat.h"
+#include "formats/textreader.h"
+
+#include <QBuffer>
+#include <QTextCodec>
+#include <QTest>                               // krazy:exclude=c++/includes
+
+using namespace SubtitleComposer;
+
+namespace {
+// format constructors are only accessible to FormatManager and to derived classes
+class SubViewer1Input : public SubViewer1InputFormat
+{
+public:
+	SubViewer1Input() {}
+};
+
+QString
+readAll(QByteArray bytes, int chunkSize)
+{
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	TextReader reader(&buffer, QTextCodec::codecForName("UTF-8"), chunkSize);
+
+	QString text;
+	while(reader.readChunk(text))
+		;
+	return text;
+}
+
+void
+addChunkSizeColumn()
+{
+	QTest::addColumn<int>("chunkSize");
+
+	for(int chunkSize : { 1, 2, 3, 4, 5, 7, 1024 })
+		QTest::newRow(qPrintable(QString::number(chunkSize))) << chunkSize;
+}
+}
+
+void
+TextReaderTest::testLineBreaks_data()
+{
+	addChunkSizeColumn();
+}
+
+void
+TextReaderTest::testLineBreaks()
+{
+	QFETCH(int, chunkSize);
+
+	// "\r\n" pairs end up split at every possible position
+	QCOMPARE(readAll(QByteArrayLiteral("a\r\nb\rc\n\r\n\r\rd\r\n"), chunkSize), QStringLiteral("a\nb\nc\n\n\n\nd\n"));
+	QCOMPARE(readAll(QByteArrayLiteral("a\r"), chunkSize), QStringLiteral("a\n"));
+	QCOMPARE(readAll(QByteArrayLiteral("\r\n\r\n"), chunkSize), QStringLiteral("\n\n"));
+}
+
+void
+TextReaderTest::testMultibyte_data()
+{
+	addChunkSizeColumn();
+}
+
+void
+TextReaderTest::testMultibyte()
+{
+	QFETCH(int, chunkSize);
+
+	// two, three and four byte sequences end up split at every possible position
+	const QByteArray bytes = QByteArrayLiteral("a\xC3\xB1" "b\xE2\x82\xAC\r\n\xF0\x9D\x84\x9E" "c\xC3\xB1");
+	QCOMPARE(readAll(bytes, chunkSize), QString::fromUtf8("a\xC3\xB1" "b\xE2\x82\xAC\n\xF0\x9D\x84\x9E" "c\xC3\xB1"));
+}
+
+void
+TextReaderTest::testSplitEntry_data()
+{
+	addChunkSizeColumn();
+}
+
+void
+TextReaderTest::testSplitEntry()
+{
+	QFETCH(int, chunkSize);
+
+	// the head FormatManager sniffs holds the first entry, the rest is decoded in chunks
+	QString data = QStringLiteral("[00:00:01]\nFirst\n[00:00:02]\n\n");
+	QByteArray bytes = QByteArrayLiteral(
+		"not an entry\r\nnor this\r\n"
+		"[00:00:03]\r\nSecond|row\r\n[00:00:04]\r\n\r\n"
+		"[00:00:05]\r\nT\xC3\xBA\r\n[00:00:06]\r\n\r\n");
+	QBuffer buffer(&bytes);
+	buffer.open(QIODevice::ReadOnly);
+	TextReader reader(&buffer, QTextCodec::codecForName("UTF-8"), chunkSize);
+
+	Subtitle subtitle;
+	QVERIFY(SubViewer1Input().readSubtitle(subtitle, true, reader, data));
+	QCOMPARE(subtitle.linesCount(), 3);
+	QCOMPARE(subtitle.at(0)->primaryText().string(), QStringLiteral("First"));
+	QCOMPARE(subtitle.at(1)->showTime().toMillis(), 3000.);
+	QCOMPARE(subtitle.at(1)->hideTime().toMillis(), 4000.);
+	QCOMPARE(subtitle.at(1)->primaryText().string(), QStringLiteral("Second\nrow"));
+	QCOMPARE(subtitle.at(2)->showTime().toMillis(), 5000.);
+	QCOMPARE(subtitle.at(2)->hideTime().toMillis(), 6000.);
+	QCOMPARE(subtitle.at(2)->primaryText().string(), QString::fromUtf8("T\xC3\xBA"));
+}
+
+QTEST_GUILESS_MAIN(TextReaderTest);
@@ -38,3 +38,9 @@ UndoAction::undo()
 {
 	redo();
 }
+
+qint64
+UndoAction::memoryUsage() const
+{
+	return sizeof(*this);
+}
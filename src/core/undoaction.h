@@ -43,8 +43,13 @@ public:
 		SetFramesPerSecond = 1,
 		InsertLines,
 		RemoveLines,
+		RemoveLineRanges,
 		MoveLine,
+		PermuteLines,
 		SwapLinesTexts,
+		SetLinesText,
+		SwapLinesData,
+		SetLinesErrors,
 
 		// subtitle line actions
 		SetLinePrimaryText,
@@ -63,6 +68,9 @@ public:
 	void redo() override = 0;
 	void undo() override;
 
+	/// approximate bytes held by the action
+	virtual qint64 memoryUsage() const;
+
 private:
 	const DirtyMode m_dirtyMode;
 	Subtitle *m_subtitle;
@@ -197,36 +197,30 @@ CurrentLineWidget::saveConfig()
 void
 CurrentLineWidget::setSubtitle(Subtitle *subtitle)
 {
-	if(m_subtitle)
+	if(m_subtitle) {
 		disconnect(m_subtitle, SIGNAL(lineAnchorChanged(const SubtitleLine*,bool)), this, SLOT(onLineAnchorChanged(const SubtitleLine*,bool)));
+		disconnect(m_subtitle, &Subtitle::linesPrimaryTextChanged, this, &CurrentLineWidget::onLinesPrimaryTextChanged);
+		disconnect(m_subtitle, &Subtitle::linesSecondaryTextChanged, this, &CurrentLineWidget::onLinesSecondaryTextChanged);
+		disconnect(m_subtitle, &Subtitle::linesTimesChanged, this, &CurrentLineWidget::onLinesTimesChanged);
+	}
 
 	m_subtitle = subtitle;
 
-	if(subtitle)
+	if(subtitle) {
 		connect(m_subtitle, SIGNAL(lineAnchorChanged(const SubtitleLine*,bool)), this, SLOT(onLineAnchorChanged(const SubtitleLine*,bool)));
-	else
+		connect(m_subtitle, &Subtitle::linesPrimaryTextChanged, this, &CurrentLineWidget::onLinesPrimaryTextChanged);
+		connect(m_subtitle, &Subtitle::linesSecondaryTextChanged, this, &CurrentLineWidget::onLinesSecondaryTextChanged);
+		connect(m_subtitle, &Subtitle::linesTimesChanged, this, &CurrentLineWidget::onLinesTimesChanged);
+	} else {
 		setCurrentLine(NULL);
+	}
 }
 
 void
 CurrentLineWidget::setCurrentLine(SubtitleLine *line)
 {
-	if(m_currentLine) {
-		disconnect(m_currentLine, SIGNAL(primaryTextChanged(const SString &)), this, SLOT(onLinePrimaryTextChanged(const SString &)));
-		disconnect(m_currentLine, SIGNAL(secondaryTextChanged(const SString &)), this, SLOT(onLineSecondaryTextChanged(const SString &)));
-		disconnect(m_currentLine, SIGNAL(showTimeChanged(const Time &)), this, SLOT(onLineShowTimeChanged(const Time &)));
-		disconnect(m_currentLine, SIGNAL(hideTimeChanged(const Time &)), this, SLOT(onLineHideTimeChanged(const Time &)));
-	}
-
 	m_currentLine = line;
 
-	if(m_currentLine) {
-		connect(m_currentLine, SIGNAL(primaryTextChanged(const SString &)), this, SLOT(onLinePrimaryTextChanged(const SString &)));
-		connect(m_currentLine, SIGNAL(secondaryTextChanged(const SString &)), this, SLOT(onLineSecondaryTextChanged(const SString &)));
-		connect(m_currentLine, SIGNAL(showTimeChanged(const Time &)), this, SLOT(onLineShowTimeChanged(const Time &)));
-		connect(m_currentLine, SIGNAL(hideTimeChanged(const Time &)), this, SLOT(onLineHideTimeChanged(const Time &)));
-	}
-
 	onLineShowTimeChanged(m_currentLine ? m_currentLine->showTime() : Time());
 	onLineHideTimeChanged(m_currentLine ? m_currentLine->hideTime() : Time());
 
@@ -455,6 +449,29 @@ CurrentLineWidget::onLineHideTimeChanged(const Time &hideTime)
 	}
 }
 
+void
+CurrentLineWidget::onLinesPrimaryTextChanged(const RangeList &ranges)
+{
+	if(m_currentLine && ranges.contains(m_currentLine->index()))
+		onLinePrimaryTextChanged(m_currentLine->primaryText());
+}
+
+void
+CurrentLineWidget::onLinesSecondaryTextChanged(const RangeList &ranges)
+{
+	if(m_currentLine && ranges.contains(m_currentLine->index()))
+		onLineSecondaryTextChanged(m_currentLine->secondaryText());
+}
+
+void
+CurrentLineWidget::onLinesTimesChanged(const RangeList &ranges)
+{
+	if(m_currentLine && ranges.contains(m_currentLine->index())) {
+		onLineShowTimeChanged(m_currentLine->showTime());
+		onLineHideTimeChanged(m_currentLine->hideTime());
+	}
+}
+
 void
 CurrentLineWidget::highlightPrimary(int startIndex, int endIndex)
 {
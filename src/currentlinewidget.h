@@ -77,6 +77,10 @@ protected slots:
 	void onLineShowTimeChanged(const Time &showTime);
 	void onLineHideTimeChanged(const Time &hideTime);
 
+	void onLinesPrimaryTextChanged(const RangeList &ranges);
+	void onLinesSecondaryTextChanged(const RangeList &ranges);
+	void onLinesTimesChanged(const RangeList &ranges);
+
 	void onConfigChanged();
 
 	void markUpdateShortcuts();
@@ -85,7 +85,7 @@ ActionWithErrorTargetsDialog::createErrorsButtons(bool showUserMarks, bool showM
 			m_errorsCheckBox[errorId] = 0;
 		else {
 			m_errorsCheckBox[errorId] = new QCheckBox(m_errorsGroupBox);
-			m_errorsCheckBox[errorId]->setText(SubtitleLine::simpleErrorText((SubtitleLine::ErrorID)errorId));
+			m_errorsCheckBox[errorId]->setText(errorText(errorId));
 			m_errorsCheckBox[errorId]->setChecked(true);
 			errorCount++;
 		}
@@ -118,6 +118,43 @@ ActionWithErrorTargetsDialog::createErrorsButtons(bool showUserMarks, bool showM
 	m_errorsLayout->addLayout(buttonsLayout, errorCount / 2 + 1, 0, 1, 2);
 }
 
+QString
+ActionWithErrorTargetsDialog::errorText(int errorId) const
+{
+	const QString text = SubtitleLine::simpleErrorText((SubtitleLine::ErrorID)errorId);
+	if(m_errorCounts.isEmpty())
+		return text;
+
+	// in translation mode primary errors checkboxes also select their secondary counterparts
+	const int count = translationMode() ? m_translationErrorCounts.at(errorId) : m_errorCounts.at(errorId);
+	return i18nc("@option:check error name (lines count)", "%1 (%2)", text, count);
+}
+
+void
+ActionWithErrorTargetsDialog::setErrorCounts(const Subtitle *subtitle)
+{
+	m_errorCounts.clear();
+	m_translationErrorCounts.clear();
+	if(subtitle) {
+		m_errorCounts.reserve(SubtitleLine::ErrorSIZE);
+		m_translationErrorCounts.reserve(SubtitleLine::ErrorSIZE);
+		for(int errorId = 0; errorId < SubtitleLine::ErrorSIZE; ++errorId) {
+			const int errorCount = subtitle->errorCount((SubtitleLine::ErrorID)errorId);
+			m_errorCounts.append(errorCount);
+			if((0x1 << errorId) & SubtitleLine::PrimaryOnlyErrors)
+				m_translationErrorCounts.append(subtitle->errorLinesCount(0x3 << errorId));
+			else
+				m_translationErrorCounts.append(errorCount);
+		}
+	}
+
+	if(!m_errorsCheckBox)
+		return;
+	for(int errorId = 0; errorId < SubtitleLine::ErrorSIZE; ++errorId)
+		if(m_errorsCheckBox[errorId])
+			m_errorsCheckBox[errorId]->setText(errorText(errorId));
+}
+
 void
 ActionWithErrorTargetsDialog::selectAllErrorFlags()
 {
@@ -38,12 +38,18 @@ public:
 
 	int selectedErrorFlags() const;
 
+	/// shows how many lines of the subtitle have each error next to its checkbox
+	void setErrorCounts(const Subtitle *subtitle);
+
 protected:
 	explicit ActionWithErrorTargetsDialog(const QString &title, QWidget *parent = 0);
 
 	QGroupBox * createErrorsGroupBox(const QString &title);
 	void createErrorsButtons(bool showUserMarks, bool showMissingTranslation);
 
+private:
+	QString errorText(int errorId) const;
+
 private slots:
 	void selectAllErrorFlags();
 	void deselectAllErrorFlags();
@@ -52,6 +58,8 @@ private:
 	QGroupBox *m_errorsGroupBox;
 	QCheckBox **m_errorsCheckBox;
 	QGridLayout *m_errorsLayout;
+	QVector<int> m_errorCounts;
+	QVector<int> m_translationErrorCounts;
 };
 }
 #endif
@@ -20,11 +20,14 @@
 
 #include "formatmanager.h"
 #include "inputformat.h"
+#include "textreader.h"
+#include "textwriter.h"
 #include "outputformat.h"
 #include "lineswidget.h"
 #include "application.h"
 #include "helpers/fileloadhelper.h"
 #include "helpers/filesavehelper.h"
+#include "helpers/profiler.h"
 #include "dialogs/encodingdetectdialog.h"
 
 #include "microdvd/microdvdinputformat.h"
@@ -50,11 +53,13 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QTextCodec>
-#include <QTextStream>
+#include <QVector>
 
 #include <KCharsets>
 #include <QUrl>
 
+#include <algorithm>
+
 #ifdef HAVE_CONFIG_H
 # include <config.h>
 # ifdef HAVE_ICU
@@ -64,6 +69,9 @@
 
 using namespace SubtitleComposer;
 
+// characters at the start of a text file that input formats are scored on
+static const int sniffLength = 4 * 1024;
+
 FormatManager &
 FormatManager::instance()
 {
@@ -166,6 +174,8 @@ FormatManager::Status
 FormatManager::readBinary(Subtitle &subtitle, const QUrl &url, bool primary,
 						  QTextCodec **codec, QString *formatName) const
 {
+	PROFILE();
+
 	foreach(InputFormat *format, m_inputFormats) {
 		Subtitle newSubtitle;
 		Status res = format->readBinary(newSubtitle, url);
@@ -176,9 +186,9 @@ FormatManager::readBinary(Subtitle &subtitle, const QUrl &url, bool primary,
 				*formatName = format->name();
 			*codec = KCharsets::charsets()->codecForName(SCConfig::defaultSubtitlesEncoding());
 			if(primary)
-				subtitle.setPrimaryData(newSubtitle, true);
+				subtitle.takePrimaryData(newSubtitle, true);
 			else
-				subtitle.setSecondaryData(newSubtitle, true);
+				subtitle.takeSecondaryData(newSubtitle, true);
 		}
 		return res;
 	}
@@ -187,68 +197,84 @@ FormatManager::readBinary(Subtitle &subtitle, const QUrl &url, bool primary,
 
 FormatManager::Status
 FormatManager::readText(Subtitle &subtitle, const QUrl &url, bool primary,
-						QTextCodec **codec, QString *formatName) const
+						QTextCodec **codec, QString *formatName, const QString &formatHint) const
 {
+	PROFILE();
+
 	FileLoadHelper fileLoadHelper(url);
 	if(!fileLoadHelper.open())
 		return ERROR;
-	// WARNING: only 1MB of text subtitle is being read here
-	QByteArray byteData = fileLoadHelper.file()->read(1024 * 1024);
-	fileLoadHelper.close();
 
-	QString stringData;
 	if(!*codec) {
-		QTextCodec *c = detectEncoding(byteData);
-		if(!c)
+		QTextCodec *c = detectEncoding(fileLoadHelper.file()->peek(1024 * 1024));
+		if(!c) {
+			fileLoadHelper.close();
 			return CANCEL;
+		}
 		*codec = c;
 	}
-	if(*codec) {
-		QTextStream textStream(byteData);
-		textStream.setCodec(*codec);
-		textStream.setAutoDetectUnicode(false);
-		stringData = textStream.readAll();
-	}
-
-	stringData.replace(QLatin1String("\r\n"), QLatin1String("\n"));
-	stringData.replace('\r', '\n');
 
-	const QString extension = QFileInfo(url.path()).suffix();
-
-	// attempt to parse subtitles based on extension information first
-	for(QMap<QString, InputFormat *>::ConstIterator it = m_inputFormats.begin(), end = m_inputFormats.end(); it != end; ++it) {
-		if(it.value()->knowsExtension(extension)) {
-			if(it.value()->readSubtitle(subtitle, primary, stringData)) {
-				if(formatName)
-					*formatName = it.value()->name();
-				return SUCCESS;
-			}
+	// formats are tried on the first chunk, the one that recognizes it reads the rest
+	TextReader reader(fileLoadHelper.file(), *codec);
+	QString stringData;
+	reader.readChunk(stringData);
+
+	const InputFormat *inputFormat = nullptr;
+
+	// format detected when the file was opened before
+	const InputFormat *hintFormat = input(formatHint);
+	if(hintFormat && hintFormat->readSubtitle(subtitle, primary, reader, stringData))
+		inputFormat = hintFormat;
+
+	// data is cleared when a format recognized the file but failed to read it
+	if(!inputFormat && !stringData.isEmpty()) {
+		const QString extension = QFileInfo(url.path()).suffix();
+		const QString head = stringData.left(sniffLength);
+
+		// the head of the file only decides the order formats are tried in - formats that
+		// recognize it go first, best score first, then formats knowing the extension, then
+		// the rest, as a sniffer can miss a file its parser would still read
+		QVector<QPair<int, const InputFormat *>> candidates;
+		for(QMap<QString, InputFormat *>::ConstIterator it = m_inputFormats.begin(), end = m_inputFormats.end(); it != end; ++it) {
+			if(it.value() == hintFormat)
+				continue;
+			const int score = it.value()->sniff(head);
+			const int extensionScore = it.value()->knowsExtension(extension) ? 1 : 0;
+			candidates.append(qMakePair(score ? score * 2 + extensionScore + 2 : extensionScore, it.value()));
 		}
-	}
+		std::stable_sort(candidates.begin(), candidates.end(), [](const QPair<int, const InputFormat *> &a, const QPair<int, const InputFormat *> &b){
+			return a.first > b.first;
+		});
 
-	// attempt to parse subtitles based on content
-	for(QMap<QString, InputFormat *>::ConstIterator it = m_inputFormats.begin(), end = m_inputFormats.end(); it != end; ++it) {
-		if(!it.value()->knowsExtension(extension)) {
-			if(it.value()->readSubtitle(subtitle, primary, stringData)) {
-				if(formatName)
-					*formatName = it.value()->name();
-				return SUCCESS;
+		for(const QPair<int, const InputFormat *> &candidate : candidates) {
+			if(candidate.second->readSubtitle(subtitle, primary, reader, stringData)) {
+				inputFormat = candidate.second;
+				break;
 			}
+			if(stringData.isEmpty())
+				break;
 		}
 	}
 
-	return ERROR;
+	fileLoadHelper.close();
+
+	if(!inputFormat)
+		return ERROR;
+
+	if(formatName)
+		*formatName = inputFormat->name();
+	return SUCCESS;
 }
 
 FormatManager::Status
 FormatManager::readSubtitle(Subtitle &subtitle, bool primary, const QUrl &url,
-							QTextCodec **codec, QString *formatName) const
+							QTextCodec **codec, QString *formatName, const QString &formatHint) const
 {
 	Status res = readBinary(subtitle, url, primary, codec, formatName);
 	if(res != ERROR) // when SUCCESS or CANCEL no need to try text formats
 		return res;
 
-	return readText(subtitle, url, primary, codec, formatName);
+	return readText(subtitle, url, primary, codec, formatName, formatHint);
 }
 
 bool
@@ -279,6 +305,8 @@ bool
 FormatManager::writeSubtitle(const Subtitle &subtitle, bool primary, const QUrl &url,
 							 QTextCodec *codec, const QString &formatName, bool overwrite) const
 {
+	PROFILE();
+
 	const OutputFormat *format = output(formatName);
 	if(format == nullptr) {
 		QString extension = QFileInfo(url.path()).suffix();
@@ -297,11 +325,12 @@ FormatManager::writeSubtitle(const Subtitle &subtitle, bool primary, const QUrl
 	if(!fileSaveHelper.open())
 		return false;
 
-	const QString data = format->writeSubtitle(subtitle, primary);
-	QTextStream stream(fileSaveHelper.file());
-	stream.setCodec(codec);
-	stream.setGenerateByteOrderMark(true);
-	stream << data;
+	// cues are encoded to the file in chunks as they are formatted
+	TextWriter writer(fileSaveHelper.file(), codec);
+	if(!format->writeSubtitle(subtitle, primary, writer)) {
+		fileSaveHelper.abort();
+		return false;
+	}
 
 	return fileSaveHelper.close();
 }
@@ -48,8 +48,9 @@ public:
 	const InputFormat * input(const QString &name) const;
 	QStringList inputNames() const;
 
+	/// formatHint is tried first when set, e.g. the format detected when the file was opened before
 	Status readSubtitle(Subtitle &subtitle, bool primary, const QUrl &url,
-						QTextCodec **codec, QString *format = nullptr) const;
+						QTextCodec **codec, QString *format = nullptr, const QString &formatHint = QString()) const;
 
 	bool hasOutput(const QString &name) const;
 	const OutputFormat * output(const QString &name) const;
@@ -66,7 +67,7 @@ protected:
 	Status readBinary(Subtitle &subtitle, const QUrl &url, bool primary,
 					  QTextCodec **codec, QString *format) const;
 	Status readText(Subtitle &subtitle, const QUrl &url, bool primary,
-					QTextCodec **codec, QString *formatName) const;
+					QTextCodec **codec, QString *formatName, const QString &formatHint) const;
 
 	QMap<QString, InputFormat *> m_inputFormats;
 	QMap<QString, OutputFormat *> m_outputFormats;
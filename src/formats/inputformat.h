@@ -23,6 +23,7 @@
 
 #include "format.h"
 #include "formatmanager.h"
+#include "textreader.h"
 
 namespace SubtitleComposer {
 class InputFormat : public Format
@@ -32,22 +33,100 @@ public:
 	{
 		Subtitle newSubtitle;
 
-		if(!parseSubtitles(newSubtitle, data))
+		if(parseChunk(newSubtitle, data, true, true) < 0 || newSubtitle.isEmpty())
 			return false;
 
 		if(primary)
-			subtitle.setPrimaryData(newSubtitle, true);
+			subtitle.takePrimaryData(newSubtitle, true);
 		else
-			subtitle.setSecondaryData(newSubtitle, true);
+			subtitle.takeSecondaryData(newSubtitle, true);
 
 		return true;
 	}
 
+	/// Reads subtitle as it is decoded by reader. data holds text that was already read,
+	/// it is kept if the format is not recognized so other formats can be tried. If the
+	/// format was recognized but the rest of the file can't be read data is cleared.
+	bool readSubtitle(Subtitle &subtitle, bool primary, TextReader &reader, QString &data) const
+	{
+		Subtitle newSubtitle;
+
+		// some entries can only be recognized with more data (e.g. a long header)
+		int consumed;
+		for(;;) {
+			const bool atEnd = reader.atEnd();
+			consumed = parseChunk(newSubtitle, data, true, atEnd);
+			if(consumed < 0)
+				return false;
+			if(!newSubtitle.isEmpty() || atEnd)
+				break;
+			reader.readChunk(data);
+		}
+		if(newSubtitle.isEmpty())
+			return false;
+
+		while(!reader.atEnd()) {
+			data.remove(0, consumed);
+			reader.readChunk(data);
+			consumed = qMax(0, parseChunk(newSubtitle, data, false, reader.atEnd()));
+			// no entry is that long, the file is broken - fail instead of dropping text
+			if(data.length() - consumed > maxPendingLength) {
+				data.clear();
+				return false;
+			}
+		}
+		data.clear();
+
+		if(primary)
+			subtitle.takePrimaryData(newSubtitle, true);
+		else
+			subtitle.takeSecondaryData(newSubtitle, true);
+
+		return true;
+	}
+
+	/// Scores how likely head, the start of a file, is in this format: from 0 (not at all)
+	/// to 100. It must be cheap, it only decides the order the formats are fully parsed in.
+	virtual int sniff(const QString &head) const
+	{
+		// formats without a signature are recognized by parsing the head
+		Subtitle subtitle;
+		return parseChunk(subtitle, head, true, false) >= 0 && !subtitle.isEmpty() ? 50 : 0;
+	}
+
 	virtual bool isBinary() const { return false; }
 	virtual FormatManager::Status readBinary(Subtitle &, const QUrl &) { return FormatManager::ERROR; }
 
 protected:
-	virtual bool parseSubtitles(Subtitle &subtitle, const QString &data) const = 0;
+	/// Parses entries from the start of data and returns the number of characters consumed.
+	/// Text is fed in chunks: data holds what was left unconsumed by the previous call followed
+	/// by the next chunk, it can end in the middle of a line. Unless atEnd is set, the last
+	/// entry must be left unconsumed if it could continue in the next chunk. If no entry
+	/// starts in data, everything before the lines an entry could start with must be
+	/// consumed (see unmatchedLength()) so it is not scanned again with the next chunk.
+	/// Returns -1 if atStart is set and data is not in this format.
+	virtual int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const = 0;
+
+	/// length of data up to its last line break, text after it may continue in the next chunk
+	static inline int completeLength(const QString &data, bool atEnd)
+	{
+		return atEnd ? data.length() : data.lastIndexOf(QChar('\n')) + 1;
+	}
+
+	/// length of data without entries, up to the last headerLines lines (the last one can be
+	/// incomplete) that could still be the start of an entry header continuing in the next chunk
+	static inline int unmatchedLength(const QString &data, bool atEnd, int headerLines)
+	{
+		if(atEnd)
+			return data.length();
+		int pos = data.length();
+		for(int i = 0; i < headerLines && pos > 0; i++)
+			pos = data.lastIndexOf(QChar('\n'), pos - 1);
+		return pos + 1;
+	}
+
+	/// reading fails when the format leaves more data than this unconsumed
+	static const int maxPendingLength = 1024 * 1024;
 
 	InputFormat(const QString &name, const QStringList &extensions) : Format(name, extensions) {}
 };
@@ -32,32 +32,32 @@ class MicroDVDInputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		if(m_lineRegExp.indexIn(data, 0) == -1)
-			return false; // couldn't find first line (content or FPS)
+		const QString lines = data.left(completeLength(data, atEnd));
+
+		if(m_lineRegExp.indexIn(lines, 0) == -1)
+			return atStart ? -1 : lines.length(); // couldn't find first line (content or FPS)
 
 		int offset = 0;
 
+		double framesPerSecond = subtitle.framesPerSecond();
+
 		// if present, the FPS must by indicated by the first entry with both initial and final frames at 1
 		bool ok;
-		double framesPerSecond = m_lineRegExp.cap(3).toDouble(&ok);
-		if(ok && m_lineRegExp.cap(1) == QLatin1String("1") && m_lineRegExp.cap(2) == QLatin1String("1")) {
+		const double fileFramesPerSecond = m_lineRegExp.cap(3).toDouble(&ok);
+		if(atStart && ok && m_lineRegExp.cap(1) == QLatin1String("1") && m_lineRegExp.cap(2) == QLatin1String("1")) {
 			// first line contained the frames per second
+			framesPerSecond = fileFramesPerSecond;
 			subtitle.setFramesPerSecond(framesPerSecond);
 
-			offset += m_lineRegExp.matchedLength();
-			if(m_lineRegExp.indexIn(data, offset) == -1)
-				return false; // couldn't find first line with content
-		} else {
-			// first line doesn't contain the FPS, use the value loaded by default
-			framesPerSecond = subtitle.framesPerSecond();
+			offset = m_lineRegExp.pos() + m_lineRegExp.matchedLength();
+			if(m_lineRegExp.indexIn(lines, offset) == -1)
+				return atEnd ? -1 : 0; // couldn't find first line with content
 		}
 
-		unsigned readLines = 0;
-
 		do {
-			offset += m_lineRegExp.matchedLength();
+			offset = m_lineRegExp.pos() + m_lineRegExp.matchedLength();
 
 			Time showTime(static_cast<long>((m_lineRegExp.cap(1).toLong() / framesPerSecond) * 1000));
 			Time hideTime(static_cast<long>((m_lineRegExp.cap(2).toLong() / framesPerSecond) * 1000));
@@ -122,11 +122,14 @@ protected:
 			}
 
 			subtitle.insertLine(new SubtitleLine(richText.replace('|', '\n'), showTime, hideTime));
+		} while(m_lineRegExp.indexIn(lines, offset) != -1);
 
-			readLines++;
-		} while(m_lineRegExp.indexIn(data, offset) != -1);
+		return lines.length();
+	}
 
-		return readLines > 0;
+	int sniff(const QString &head) const override
+	{
+		return m_lineRegExp.indexIn(head) != -1 ? 90 : 0;
 	}
 
 	MicroDVDInputFormat() :
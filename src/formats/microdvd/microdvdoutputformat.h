@@ -22,7 +22,7 @@
  */
 
 #include "formats/outputformat.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 
 namespace SubtitleComposer {
 class MicroDVDOutputFormat : public OutputFormat
@@ -44,8 +44,7 @@ protected:
 				.arg(1)
 				.arg(QString::number(framesPerSecond, 'f', 3));
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		for(const SubtitleLine *line : SubtitleLinesView(subtitle)) {
 
 			const SString &text = primary ? line->primaryText() : line->secondaryText();
 			QString subtitle;
@@ -31,27 +31,33 @@ class MPlayerInputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		double framesPerSecond = subtitle.framesPerSecond();
+		const QString lines = data.left(completeLength(data, atEnd));
 
-		unsigned readLines = 0;
+		double framesPerSecond = subtitle.framesPerSecond();
 
-		for(int offset = 0; m_lineRegExp.indexIn(data, offset) != -1; offset += m_lineRegExp.matchedLength()) {
-			Time showTime(static_cast<long>((m_lineRegExp.cap(1).toLong() / framesPerSecond) * 1000));
-			Time hideTime(static_cast<long>((m_lineRegExp.cap(2).toLong() / framesPerSecond) * 1000));
-			QString text(m_lineRegExp.cap(3).replace("|", "\n"));
+		int offset = 0;
+		for(; m_lineRegExp.indexIn(lines, offset) != -1; offset = m_lineRegExp.pos() + m_lineRegExp.matchedLength()) {
+			Time showTime(static_cast<long>((m_lineRegExp.cap(2).toLong() / framesPerSecond) * 1000));
+			Time hideTime(static_cast<long>((m_lineRegExp.cap(3).toLong() / framesPerSecond) * 1000));
+			QString text(m_lineRegExp.cap(4).replace("|", "\n"));
 
 			subtitle.insertLine(new SubtitleLine(text, showTime, hideTime));
-
-			readLines++;
 		}
-		return readLines > 0;
+
+		return atStart && offset == 0 ? -1 : lines.length();
+	}
+
+	int sniff(const QString &head) const override
+	{
+		// frame numbers separated by commas are a weak signature
+		return m_lineRegExp.indexIn(head) != -1 ? 60 : 0;
 	}
 
 	MPlayerInputFormat() :
 		InputFormat(QStringLiteral("MPlayer"), QStringList(QStringLiteral("mpl"))),
-		m_lineRegExp(QStringLiteral("(^|\n)(\\d+),(\\d+),0,([^\n]+)[^\n]"))
+		m_lineRegExp(QStringLiteral("(^|\n)(\\d+),(\\d+),0,([^\n]+)"))
 	{}
 
 	mutable QRegExp m_lineRegExp;
@@ -22,7 +22,7 @@
  */
 
 #include "formats/outputformat.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 
 namespace SubtitleComposer {
 class MPlayerOutputFormat : public OutputFormat
@@ -36,8 +36,7 @@ protected:
 
 		double framesPerSecond = subtitle.framesPerSecond();
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		for(const SubtitleLine *line : SubtitleLinesView(subtitle)) {
 
 			const SString &text = primary ? line->primaryText() : line->secondaryText();
 
@@ -31,20 +31,25 @@ class MPlayer2InputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		unsigned readLines = 0;
+		const QString lines = data.left(completeLength(data, atEnd));
 
-		for(int offset = 0; m_lineRegExp.indexIn(data, offset) != -1; offset += m_lineRegExp.matchedLength()) {
+		int offset = 0;
+		for(; m_lineRegExp.indexIn(lines, offset) != -1; offset = m_lineRegExp.pos() + m_lineRegExp.matchedLength()) {
 			Time showTime(m_lineRegExp.cap(1).toInt() * 100);
 			Time hideTime(m_lineRegExp.cap(2).toInt() * 100);
 			QString text(m_lineRegExp.cap(3).replace('|', '\n'));
 
 			subtitle.insertLine(new SubtitleLine(text, showTime, hideTime));
-
-			readLines++;
 		}
-		return readLines > 0;
+
+		return atStart && offset == 0 ? -1 : lines.length();
+	}
+
+	int sniff(const QString &head) const override
+	{
+		return m_lineRegExp.indexIn(head) != -1 ? 90 : 0;
 	}
 
 	MPlayer2InputFormat() :
@@ -22,7 +22,7 @@
  */
 
 #include "formats/outputformat.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 
 namespace SubtitleComposer {
 class MPlayer2OutputFormat : public OutputFormat
@@ -34,8 +34,7 @@ protected:
 	{
 		QString ret;
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		for(const SubtitleLine *line : SubtitleLinesView(subtitle)) {
 
 			const SString &text = primary ? line->primaryText() : line->secondaryText();
 
@@ -22,6 +22,7 @@
  */
 
 #include "format.h"
+#include "textwriter.h"
 
 namespace SubtitleComposer {
 class OutputFormat : public Format
@@ -33,8 +34,40 @@ public:
 		return dumpSubtitles(subtitle, primary);
 	}
 
+	/// Formats subtitle into writer cue by cue, writer encodes it to its device in chunks.
+	bool writeSubtitle(const Subtitle &subtitle, bool primary, TextWriter &writer) const
+	{
+		beginDocument(writer, subtitle, primary);
+		for(int i = 0, n = subtitle.count(); i < n; i++) {
+			writeCue(writer, subtitle.at(i), i, primary);
+			if(!writer.commit())
+				return false;
+		}
+		endDocument(writer, subtitle, primary);
+		return writer.flush();
+	}
+
 protected:
-	virtual QString dumpSubtitles(const Subtitle &subtitle, bool primary) const = 0;
+	/// Formats implement either dumpSubtitles() or the beginDocument(), writeCue() and
+	/// endDocument() sink. Each default is implemented with the other one.
+	virtual QString dumpSubtitles(const Subtitle &subtitle, bool primary) const
+	{
+		TextWriter writer;
+		writeSubtitle(subtitle, primary, writer);
+		return writer.buffer();
+	}
+
+	/// appends text preceding the cues (e.g. a header) to writer.buffer()
+	virtual void beginDocument(TextWriter &writer, const Subtitle &subtitle, bool primary) const
+	{
+		writer.buffer() += dumpSubtitles(subtitle, primary);
+	}
+
+	/// appends line, which is at index in subtitle, to writer.buffer()
+	virtual void writeCue(TextWriter &/*writer*/, const SubtitleLine */*line*/, int /*index*/, bool /*primary*/) const {}
+
+	/// appends text following the cues to writer.buffer()
+	virtual void endDocument(TextWriter &/*writer*/, const Subtitle &/*subtitle*/, bool /*primary*/) const {}
 
 	OutputFormat(const QString &name, const QStringList &extensions) : Format(name, extensions) {}
 };
@@ -23,49 +23,146 @@
 
 #include "formats/inputformat.h"
 
-#include <QRegExp>
-
 namespace SubtitleComposer {
 class SubRipInputFormat : public InputFormat
 {
 	friend class FormatManager;
 
 protected:
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		if(m_regExp.indexIn(data, 0) == -1)
-			return false; // couldn't find first line
+		const QChar *begin = data.constData();
+		const QChar *end = begin + data.length();
+
+		Time showTime, hideTime;
+		const QChar *text = nullptr;
+		const QChar *cue = findCue(begin, end, atEnd, &showTime, &hideTime, &text);
+		if(!cue)
+			return atStart ? -1 : unmatchedLength(data, atEnd, 2); // couldn't find first line
+
+		for(;;) {
+			// text ends where the next cue starts, the last one could continue in next chunk
+			Time nextShowTime, nextHideTime;
+			const QChar *nextText = nullptr;
+			const QChar *nextCue = findCue(text, end, atEnd, &nextShowTime, &nextHideTime, &nextText);
+			if(!nextCue && !atEnd)
+				return int(cue - begin);
+
+			const QChar *textEnd = nextCue ? nextCue : end;
+			while(text < textEnd && text->isSpace())
+				text++;
+			while(textEnd > text && textEnd[-1].isSpace())
+				textEnd--;
 
-		unsigned readLines = 0;
+			SString stext;
+			stext.setRichString(text, int(textEnd - text));
 
-		int offset = 0;
-		do {
-			Time showTime(m_regExp.cap(1).toInt(), m_regExp.cap(2).toInt(), m_regExp.cap(3).toInt(), m_regExp.cap(4).toInt());
-			Time hideTime(m_regExp.cap(5).toInt(), m_regExp.cap(6).toInt(), m_regExp.cap(7).toInt(), m_regExp.cap(8).toInt());
+			subtitle.insertLine(new SubtitleLine(stext, showTime, hideTime));
 
-			offset += m_regExp.matchedLength();
+			if(!nextCue)
+				return data.length();
 
-			QString text(data.mid(offset, m_regExp.indexIn(data, offset) - offset));
+			cue = nextCue;
+			showTime = nextShowTime;
+			hideTime = nextHideTime;
+			text = nextText;
+		}
+	}
 
-			offset += text.length();
+	int sniff(const QString &head) const override
+	{
+		Time showTime, hideTime;
+		const QChar *text;
+		return findCue(head.constData(), head.constData() + head.length(), true, &showTime, &hideTime, &text) ? 100 : 0;
+	}
 
-			SString stext;
-			stext.setRichString(text.trimmed());
+	SubRipInputFormat() :
+		InputFormat(QStringLiteral("SubRip"), QStringList(QStringLiteral("srt")))
+	{}
 
-			subtitle.insertLine(new SubtitleLine(stext, showTime, hideTime));
+private:
+	static inline const QChar * skipSpaces(const QChar *pos, const QChar *end)
+	{
+		while(pos < end && (*pos == QChar(' ') || *pos == QChar('\t')))
+			pos++;
+		return pos;
+	}
 
-			readLines++;
-		} while(m_regExp.matchedLength() != -1);
+	// parses digits into value, returns nullptr if there are none or too many to fit an int
+	static inline const QChar * parseNumber(const QChar *pos, const QChar *end, int *value)
+	{
+		const int maxDigits = 9;
+		const QChar *start = pos;
+		int number = 0;
+		for(; pos < end && pos->unicode() >= '0' && pos->unicode() <= '9'; pos++) {
+			if(pos - start == maxDigits)
+				return nullptr;
+			number = number * 10 + (pos->unicode() - '0');
+		}
+		*value = number;
+		return pos == start ? nullptr : pos;
+	}
 
-		return readLines > 0;
+	// parses "hh:mm:ss,zzz" (or with a '.' before milliseconds)
+	static const QChar * parseTime(const QChar *pos, const QChar *end, Time *time)
+	{
+		int hours, minutes, seconds, mseconds;
+		if(!(pos = parseNumber(pos, end, &hours)) || pos == end || *pos++ != QChar(':'))
+			return nullptr;
+		if(!(pos = parseNumber(pos, end, &minutes)) || pos == end || *pos++ != QChar(':'))
+			return nullptr;
+		if(!(pos = parseNumber(pos, end, &seconds)) || pos == end || (*pos != QChar(',') && *pos != QChar('.')))
+			return nullptr;
+		if(!(pos = parseNumber(pos + 1, end, &mseconds)))
+			return nullptr;
+		*time = Time(hours, minutes, seconds, mseconds);
+		return pos;
 	}
 
-	SubRipInputFormat() :
-		InputFormat(QStringLiteral("SubRip"), QStringList(QStringLiteral("srt"))),
-		m_regExp(QStringLiteral("[\\d]+\n([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+) --> ([0-2][0-9]):([0-5][0-9]):([0-5][0-9])[,\\.]([0-9]+)\n"))
-	{}
+	// parses cue header - a counter line (line to lineEnd) and a "show --> hide" line,
+	// returns the start of cue text or nullptr if there is no complete header at line.
+	// The time line can only end without a line break when data is atEnd.
+	static const QChar * parseCueHeader(const QChar *line, const QChar *lineEnd, const QChar *end, bool atEnd, Time *showTime, Time *hideTime)
+	{
+		// counter line must end with a number, whatever precedes it (e.g. a misdecoded BOM)
+		const QChar *digits = lineEnd;
+		while(digits > line && (digits[-1] == QChar(' ') || digits[-1] == QChar('\t')))
+			digits--;
+		if(digits == line || digits[-1].unicode() < '0' || digits[-1].unicode() > '9')
+			return nullptr;
+
+		const QChar *pos = lineEnd + 1;
+		if(!(pos = parseTime(skipSpaces(pos, end), end, showTime)))
+			return nullptr;
+		pos = skipSpaces(pos, end);
+		if(end - pos < 3 || pos[0] != QChar('-') || pos[1] != QChar('-') || pos[2] != QChar('>'))
+			return nullptr;
+		if(!(pos = parseTime(skipSpaces(pos + 3, end), end, hideTime)))
+			return nullptr;
+
+		// ignore anything after hide time, e.g. position coordinates
+		while(pos < end && *pos != QChar('\n'))
+			pos++;
+		if(pos == end)
+			return atEnd ? end : nullptr;
+		return pos + 1;
+	}
 
-	mutable QRegExp m_regExp;
+	// finds the first line between begin and end starting a cue header
+	static const QChar * findCue(const QChar *begin, const QChar *end, bool atEnd, Time *showTime, Time *hideTime, const QChar **text)
+	{
+		for(const QChar *line = begin; line < end; ) {
+			const QChar *lineEnd = line;
+			while(lineEnd < end && *lineEnd != QChar('\n'))
+				lineEnd++;
+			if(lineEnd == end)
+				break;
+			if((*text = parseCueHeader(line, lineEnd, end, atEnd, showTime, hideTime)))
+				return line;
+			line = lineEnd + 1;
+		}
+		return nullptr;
+	}
 };
 }
 
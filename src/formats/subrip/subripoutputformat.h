@@ -22,7 +22,7 @@
  */
 
 #include "formats/outputformat.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitle.h"
 
 namespace SubtitleComposer {
 class SubRipOutputFormat : public OutputFormat
@@ -30,24 +30,19 @@ class SubRipOutputFormat : public OutputFormat
 	friend class FormatManager;
 
 protected:
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void writeCue(TextWriter &writer, const SubtitleLine *line, int index, bool primary) const override
 	{
-		QString ret;
+		QString &buffer = writer.buffer();
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		const Time showTime = line->showTime();
+		const Time hideTime = line->hideTime();
+		buffer += m_timeBuilder.sprintf("%d\n%02d:%02d:%02d,%03d --> %02d:%02d:%02d,%03d\n", index + 1, showTime.hours(), showTime.minutes(), showTime.seconds(), showTime.mseconds(), hideTime.hours(), hideTime.minutes(), hideTime.seconds(), hideTime.mseconds());
 
-			Time showTime = line->showTime();
-			Time hideTime = line->hideTime();
-			ret += m_timeBuilder.sprintf("%d\n%02d:%02d:%02d,%03d --> %02d:%02d:%02d,%03d\n", it.index() + 1, showTime.hours(), showTime.minutes(), showTime.seconds(), showTime.mseconds(), hideTime.hours(), hideTime.minutes(), hideTime.seconds(), hideTime.mseconds());
+		const SString &text = primary ? line->primaryText() : line->secondaryText();
 
-			const SString &text = primary ? line->primaryText() : line->secondaryText();
+		buffer += text.richString().replace(QLatin1String("&lt;"), QLatin1String("<")).replace(QLatin1String("&gt;"), QLatin1String(">")).replace(QLatin1String("&amp;"), QLatin1String("&"));
 
-			ret += text.richString().replace(QLatin1String("&amp;"), QLatin1String(">")).replace(QLatin1String("&lt;"), QLatin1String("<")).replace(QLatin1String("&gt;"), QLatin1String(">"));
-
-			ret += QStringLiteral("\n\n");
-		}
-		return ret;
+		buffer += QStringLiteral("\n\n");
 	}
 
 	SubRipOutputFormat() :
@@ -22,9 +22,9 @@
  */
 
 #include "formats/inputformat.h"
+#include "formats/substationalpha/substationalphatext.h"
 
 #include <QRegExp>
-#include <QStringBuilder>
 
 namespace SubtitleComposer {
 class SubStationAlphaInputFormat : public InputFormat
@@ -33,93 +33,35 @@ class SubStationAlphaInputFormat : public InputFormat
 	friend class AdvancedSubStationAlphaInputFormat;
 
 protected:
-	SString toSString(QString string) const
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		static const QRegExp cmdRegExp(QStringLiteral("\\{([^\\}]+)\\}"));
-
-		SString ret;
-
-		string.replace(QLatin1String("\\N"), QLatin1String("\n"));
-		string.replace(QLatin1String("\\n"), QLatin1String("\n"));
-
-		int currentStyle = 0;
-		QRgb currentColor = 0;
-
-		int offsetPos = 0, matchedPos;
-		while((matchedPos = cmdRegExp.indexIn(string, offsetPos)) != -1) {
-			int newStyleFlags = currentStyle;
-			QRgb newColor = currentColor;
-
-			QString commands(cmdRegExp.cap(1));
-			QStringList commandsList(commands.split('\\'));
-			for(QStringList::ConstIterator it = commandsList.begin(), end = commandsList.end(); it != end; ++it) {
-				if(it->isEmpty()) {
-					continue;
-				} else if(*it == QLatin1String("i0")) {
-					newStyleFlags &= ~SString::Italic;
-				} else if(*it == QLatin1String("b0")) {
-					newStyleFlags &= ~SString::Bold;
-				} else if(*it == QLatin1String("u0")) {
-					newStyleFlags &= ~SString::Underline;
-				} else if(*it == QLatin1String("i1")) {
-					newStyleFlags |= SString::Italic;
-				} else if(it->at(0) == 'b') {
-					// it's usually followed 1, but can be weight of the font: 400, 700, ...
-					newStyleFlags |= SString::Bold;
-				} else if(*it == QLatin1String("u1")) {
-					newStyleFlags |= SString::Underline;
-				} else if(it->at(0) == 'c') {
-					QString val = (QStringLiteral("000000") + it->mid(3, -2)).right(6);
-					if(val == QLatin1String("000000")) {
-						newStyleFlags &= ~SString::Color;
-						newColor = 0;
-					} else {
-						newStyleFlags |= SString::Color;
-						newColor = QColor(QChar('#') % val.mid(4, 2) % val.mid(2, 2) % val.mid(0, 2)).rgb();
-					}
-				}
-			}
-
-			ret.append(SString(string.mid(offsetPos, matchedPos - offsetPos), currentStyle, currentColor));
-
-			currentStyle = newStyleFlags;
-			currentColor = newColor;
-			offsetPos = matchedPos + cmdRegExp.matchedLength();
+		int offset = 0;
+
+		// header is parsed only with the first chunk, a long one could need more data
+		if(atStart) {
+			if(m_scriptInfoRegExp.indexIn(data) == -1)
+				return -1;
+
+			int stylesStart = m_stylesRegExp.indexIn(data);
+			int eventsStart = m_eventsRegExp.indexIn(data, qMax(0, stylesStart));
+			if(stylesStart == -1)
+				return atEnd || eventsStart != -1 ? -1 : 0;
+			if(eventsStart == -1 || m_formatRegExp.indexIn(data, eventsStart) == -1)
+				return atEnd ? -1 : 0;
+
+			FormatData formatData = createFormatData();
+			formatData.setValue(QStringLiteral("ScriptInfo"), data.mid(0, stylesStart));
+			formatData.setValue(QStringLiteral("Styles"), data.mid(stylesStart, eventsStart - stylesStart));
+			setFormatData(subtitle, formatData);
+
+			offset = m_formatRegExp.pos() + m_formatRegExp.matchedLength();
 		}
-		ret.append(SString(string.mid(offsetPos, matchedPos - offsetPos), currentStyle, currentColor));
 
-		return ret;
-	}
-
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
-	{
-		if(m_scriptInfoRegExp.indexIn(data) == -1)
-			return false;
-
-		int stylesStart = m_stylesRegExp.indexIn(data);
-		if(stylesStart == -1)
-			return false;
+		const QString lines = data.left(completeLength(data, atEnd));
 
 		FormatData formatData = createFormatData();
 
-		formatData.setValue(QStringLiteral("ScriptInfo"), data.mid(0, stylesStart));
-
-		int eventsStart = m_eventsRegExp.indexIn(data, stylesStart);
-		if(eventsStart == -1)
-			return false;
-
-		formatData.setValue(QStringLiteral("Styles"), data.mid(stylesStart, eventsStart - stylesStart));
-
-		if(m_formatRegExp.indexIn(data, eventsStart) == -1)
-			return false;
-
-		setFormatData(subtitle, formatData);
-		formatData.clear();
-
-		unsigned readLines = 0;
-
-		int offset = m_formatRegExp.pos() + m_formatRegExp.matchedLength();
-		for(; m_dialogueRegExp.indexIn(data, offset) != -1; offset += m_dialogueRegExp.matchedLength()) {
+		for(; m_dialogueRegExp.indexIn(lines, offset) != -1; offset = m_dialogueRegExp.pos() + m_dialogueRegExp.matchedLength()) {
 			if(m_timeRegExp.indexIn(m_dialogueRegExp.cap(1)) == -1)
 				continue;
 			Time showTime(m_timeRegExp.cap(1).toInt(), m_timeRegExp.cap(2).toInt(), m_timeRegExp.cap(3).toInt(), m_timeRegExp.cap(4).toInt() * 10);
@@ -128,16 +70,23 @@ protected:
 				continue;
 			Time hideTime(m_timeRegExp.cap(1).toInt(), m_timeRegExp.cap(2).toInt(), m_timeRegExp.cap(3).toInt(), m_timeRegExp.cap(4).toInt() * 10);
 
-			SubtitleLine *line = new SubtitleLine(toSString(m_dialogueRegExp.cap(3)), showTime, hideTime);
+			SubtitleLine *line = new SubtitleLine(SubStationAlphaText::toSString(m_dialogueRegExp.cap(3)), showTime, hideTime);
 
 			formatData.setValue(QStringLiteral("Dialogue"), m_dialogueRegExp.cap(0).replace(m_dialogueDataRegExp, QStringLiteral("\\1%1\\2%2\\3%3\n")));
 			setFormatData(line, formatData);
 
 			subtitle.insertLine(line);
-
-			readLines++;
 		}
-		return readLines;
+
+		return qMax(offset, lines.length());
+	}
+
+	int sniff(const QString &head) const override
+	{
+		if(m_scriptInfoRegExp.indexIn(head) == -1)
+			return 0;
+		// SSA and ASS differ by their styles section, which could be past a long header
+		return m_stylesRegExp.indexIn(head) != -1 ? 100 : 50;
 	}
 
 	SubStationAlphaInputFormat(
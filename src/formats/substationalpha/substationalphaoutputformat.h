@@ -23,7 +23,6 @@
 
 #include "formats/outputformat.h"
 #include "core/formatdata.h"
-#include "core/subtitleiterator.h"
 
 namespace SubtitleComposer {
 class SubStationAlphaOutputFormat : public OutputFormat
@@ -102,40 +101,39 @@ protected:
 		return data.mid(begin, end - begin + 1) + QStringLiteral("\n\n");
 	}
 
-	QString dumpSubtitles(const Subtitle &subtitle, bool primary) const override
+	void beginDocument(TextWriter &writer, const Subtitle &subtitle, bool /*primary*/) const override
 	{
 		FormatData *formatData = this->formatData(subtitle);
 
-		QString ret = normalizeBlock(formatData ? formatData->value(QStringLiteral("ScriptInfo")) : m_defaultScriptInfo)
+		writer.buffer() += normalizeBlock(formatData ? formatData->value(QStringLiteral("ScriptInfo")) : m_defaultScriptInfo)
 				+ normalizeBlock(formatData ? formatData->value(QStringLiteral("Styles")) : m_defaultStyles)
 				+ normalizeBlock(m_events);
+	}
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
-			QString showTimeArg, hideTimeArg;
-
-			Time showTime = line->showTime();
-			showTimeArg.sprintf("%01d:%02d:%02d.%02d",
-												  showTime.hours(),
-												  showTime.minutes(),
-												  showTime.seconds(),
-												  (showTime.mseconds() + 5) / 10);
-
-			Time hideTime = line->hideTime();
-			hideTimeArg.sprintf("%01d:%02d:%02d.%02d",
-												  hideTime.hours(),
-												  hideTime.minutes(),
-												  hideTime.seconds(),
-												  (hideTime.mseconds() + 5) / 10);
-
-			formatData = this->formatData(line);
-
-			ret += QString(formatData ? formatData->value(QStringLiteral("Dialogue")) : m_dialogueBuilder)
-					.arg(showTimeArg)
-					.arg(hideTimeArg)
-					.arg(fromSString(primary ? line->primaryText() : line->secondaryText()));
-		}
-		return ret;
+	void writeCue(TextWriter &writer, const SubtitleLine *line, int /*index*/, bool primary) const override
+	{
+		QString showTimeArg, hideTimeArg;
+
+		Time showTime = line->showTime();
+		showTimeArg.sprintf("%01d:%02d:%02d.%02d",
+											  showTime.hours(),
+											  showTime.minutes(),
+											  showTime.seconds(),
+											  (showTime.mseconds() + 5) / 10);
+
+		Time hideTime = line->hideTime();
+		hideTimeArg.sprintf("%01d:%02d:%02d.%02d",
+											  hideTime.hours(),
+											  hideTime.minutes(),
+											  hideTime.seconds(),
+											  (hideTime.mseconds() + 5) / 10);
+
+		FormatData *formatData = this->formatData(line);
+
+		writer.buffer() += QString(formatData ? formatData->value(QStringLiteral("Dialogue")) : m_dialogueBuilder)
+				.arg(showTimeArg)
+				.arg(hideTimeArg)
+				.arg(fromSString(primary ? line->primaryText() : line->secondaryText()));
 	}
 
 	SubStationAlphaOutputFormat(
@@ -0,0 +1,175 @@
+#ifndef SUBSTATIONALPHATEXT_H
+#define SUBSTATIONALPHATEXT_H
+
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "core/sstring.h"
+
+#include <QColor>
+
+namespace SubtitleComposer {
+// Text of SubStationAlpha/ASS dialogue events. Shared by .ssa/.ass files and
+// ASS subtitle streams demuxed from media files.
+class SubStationAlphaText
+{
+public:
+	/// Converts dialogue text to a styled string in a single pass over data. Override
+	/// blocks ("{\b1\c&H0000FF&}") set styles of the text that follows them, \N and \n
+	/// become line breaks and \h a space. Unsupported tags and comments are dropped.
+	static SString toSString(const QChar *data, int size)
+	{
+		SString text;
+		text.reserve(size);
+
+		int style = 0;
+		QRgb color = 0;
+		int tokenStart = 0;
+		for(int pos = 0; pos < size; pos++) {
+			if(data[pos] == QChar('\\') && pos + 1 < size) {
+				const QChar escape = data[pos + 1];
+				if(escape != QChar('N') && escape != QChar('n') && escape != QChar('h'))
+					continue;
+				text.append(data + tokenStart, pos - tokenStart, style, color);
+				const QChar replacement(escape == QChar('h') ? ' ' : '\n');
+				text.append(&replacement, 1, style, color);
+				tokenStart = ++pos + 1;
+				continue;
+			}
+
+			if(data[pos] != QChar('{'))
+				continue;
+
+			int blockEnd = pos + 1;
+			while(blockEnd < size && data[blockEnd] != QChar('}'))
+				blockEnd++;
+			if(blockEnd == size) // unterminated block is just text
+				break;
+
+			text.append(data + tokenStart, pos - tokenStart, style, color);
+			parseOverrides(data + pos + 1, data + blockEnd, &style, &color);
+			pos = blockEnd;
+			tokenStart = blockEnd + 1;
+		}
+		text.append(data + tokenStart, size - tokenStart, style, color);
+
+		return text;
+	}
+
+	static inline SString toSString(const QString &string) { return toSString(string.constData(), string.length()); }
+
+private:
+	// applies tags of an override block (between '{' and '}') to style and color
+	static void parseOverrides(const QChar *pos, const QChar *end, int *style, QRgb *color)
+	{
+		while(pos < end) {
+			// anything up to a backslash is a comment
+			while(pos < end && *pos != QChar('\\'))
+				pos++;
+			if(pos == end)
+				break;
+			pos++;
+
+			// tag name, color tags can be prefixed by their index ("\1c")
+			const QChar *name = pos;
+			if(pos < end && pos->isDigit())
+				pos++;
+			while(pos < end && pos->isLetter())
+				pos++;
+			const int nameLen = int(pos - name);
+
+			// argument, parenthesized ones can contain nested tags ("\t(\i1)")
+			const QChar *arg = pos;
+			if(pos < end && *pos == QChar('(')) {
+				while(pos < end && *pos != QChar(')'))
+					pos++;
+			} else {
+				while(pos < end && *pos != QChar('\\'))
+					pos++;
+			}
+			const QChar *argEnd = pos;
+
+			if(nameLen && *name == QChar('r')) {
+				// \r resets to the line style, \rName to another style (e.g. "\rDefault")
+				*style = 0;
+				*color = 0;
+			} else if(nameLen == 1) {
+				const char tag = name->toLatin1();
+				if(tag == 'b') {
+					setFlag(style, SString::Bold, arg, argEnd);
+				} else if(tag == 'i') {
+					setFlag(style, SString::Italic, arg, argEnd);
+				} else if(tag == 'u') {
+					setFlag(style, SString::Underline, arg, argEnd);
+				} else if(tag == 's') {
+					setFlag(style, SString::StrikeThrough, arg, argEnd);
+				} else if(tag == 'c') {
+					setColor(style, color, arg, argEnd);
+				}
+			} else if(nameLen == 2 && name[0] == QChar('1') && name[1] == QChar('c')) {
+				setColor(style, color, arg, argEnd);
+			}
+		}
+	}
+
+	// "0" or no value clears the flag, anything else (e.g. 1 or bold font weight) sets it
+	static inline void setFlag(int *style, int flag, const QChar *arg, const QChar *argEnd)
+	{
+		bool set = false;
+		for(; arg < argEnd && arg->isDigit(); arg++) {
+			if(*arg != QChar('0'))
+				set = true;
+		}
+		if(set)
+			*style |= flag;
+		else
+			*style &= ~flag;
+	}
+
+	// "&HBBGGRR&", black or no value resets the color
+	static inline void setColor(int *style, QRgb *color, const QChar *arg, const QChar *argEnd)
+	{
+		if(arg < argEnd && *arg == QChar('&'))
+			arg++;
+		if(arg < argEnd && (*arg == QChar('H') || *arg == QChar('h')))
+			arg++;
+
+		uint bgr = 0;
+		for(; arg < argEnd; arg++) {
+			const ushort ch = arg->unicode();
+			if(ch >= '0' && ch <= '9')
+				bgr = (bgr << 4) | (ch - '0');
+			else if((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f')
+				bgr = (bgr << 4) | ((ch | 0x20) - 'a' + 10);
+			else
+				break;
+		}
+
+		if(bgr & 0xFFFFFF) {
+			*style |= SString::Color;
+			*color = qRgb(bgr & 0xFF, (bgr >> 8) & 0xFF, (bgr >> 16) & 0xFF);
+		} else {
+			*style &= ~SString::Color;
+			*color = 0;
+		}
+	}
+};
+}
+
+#endif
@@ -31,35 +31,41 @@ class SubViewer1InputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		if(m_regExp.indexIn(data, 0) == -1)
-			return false; // couldn't find first line
+		const QString lines = data.left(completeLength(data, atEnd));
 
-		unsigned readLines = 0;
+		if(m_regExp.indexIn(lines, 0) == -1)
+			return atStart ? -1 : unmatchedLength(data, atEnd, 2); // couldn't find first line
+
+		int consumed = 0;
 
 		int offset = m_regExp.pos();
 		do {
-			offset += m_regExp.matchedLength();
+			offset = m_regExp.pos() + m_regExp.matchedLength();
 
 			Time showTime(m_regExp.cap(1).toInt(), m_regExp.cap(2).toInt(), m_regExp.cap(3).toInt(), 0);
 
 			QString text(m_regExp.cap(4).replace('|', '\n').trimmed());
 
 			// search hideTime
-			if(m_regExp.indexIn(data, offset) == -1)
+			if(m_regExp.indexIn(lines, offset) == -1)
 				break;
 
 			Time hideTime(m_regExp.cap(1).toInt(), m_regExp.cap(2).toInt(), m_regExp.cap(3).toInt(), 0);
 
 			subtitle.insertLine(new SubtitleLine(text, showTime, hideTime));
 
-			offset += m_regExp.matchedLength();
+			offset = consumed = m_regExp.pos() + m_regExp.matchedLength();
+		} while(m_regExp.indexIn(lines, offset) != -1); // search next line's showTime
 
-			readLines++;
-		} while(m_regExp.indexIn(data, offset) != -1); // search next line's showTime
+		// a line without its hideTime is read again with the next chunk
+		return atEnd ? data.length() : consumed;
+	}
 
-		return readLines > 0;
+	int sniff(const QString &head) const override
+	{
+		return m_regExp.indexIn(head) != -1 ? 80 : 0;
 	}
 
 	SubViewer1InputFormat() :
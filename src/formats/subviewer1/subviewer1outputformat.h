@@ -22,7 +22,7 @@
  */
 
 #include "formats/outputformat.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 
 namespace SubtitleComposer {
 class SubViewer1OutputFormat : public OutputFormat
@@ -34,8 +34,7 @@ protected:
 	{
 		QString ret(QStringLiteral("[TITLE]\n\n[AUTHOR]\n\n[SOURCE]\n\n[PRG]\n\n[FILEPATH]\n\n[DELAY]\n0\n[CD TRACK]\n0\n[BEGIN]\n" "******** START SCRIPT ********\n"));
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		for(const SubtitleLine *line : SubtitleLinesView(subtitle)) {
 
 			Time showTime = line->showTime();
 			ret += m_builder.sprintf("[%02d:%02d:%02d]\n", showTime.hours(), showTime.minutes(), showTime.seconds());
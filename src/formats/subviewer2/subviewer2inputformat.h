@@ -31,11 +31,12 @@ class SubViewer2InputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		unsigned readLines = 0;
+		const QString lines = data.left(completeLength(data, atEnd));
 
-		for(int offset = 0; m_lineRegExp.indexIn(data, offset) != -1; offset = m_lineRegExp.pos() + m_lineRegExp.matchedLength()) {
+		int offset = 0;
+		for(; m_lineRegExp.indexIn(lines, offset) != -1; offset = m_lineRegExp.pos() + m_lineRegExp.matchedLength()) {
 			Time showTime(m_lineRegExp.cap(1).toInt(), m_lineRegExp.cap(2).toInt(), m_lineRegExp.cap(3).toInt(), m_lineRegExp.cap(4).toInt() * 10);
 
 			Time hideTime(m_lineRegExp.cap(5).toInt(), m_lineRegExp.cap(6).toInt(), m_lineRegExp.cap(7).toInt(), m_lineRegExp.cap(8).toInt() * 10);
@@ -55,10 +56,18 @@ protected:
 			}
 
 			subtitle.insertLine(new SubtitleLine(SString(text, styleFlags), showTime, hideTime));
-
-			readLines++;
 		}
-		return readLines > 0;
+
+		if(atStart && offset == 0)
+			return -1;
+
+		// entries span several lines, anything after the last one is read again with the next chunk
+		return atEnd ? data.length() : offset;
+	}
+
+	int sniff(const QString &head) const override
+	{
+		return m_lineRegExp.indexIn(head) != -1 ? 90 : 0;
 	}
 
 	SubViewer2InputFormat() :
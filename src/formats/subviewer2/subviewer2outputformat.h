@@ -22,7 +22,7 @@
  */
 
 #include "formats/outputformat.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 
 namespace SubtitleComposer {
 class SubViewer2OutputFormat : public OutputFormat
@@ -34,8 +34,7 @@ protected:
 	{
 		QString ret(QStringLiteral("[INFORMATION]\n[TITLE]\n[AUTHOR]\n[SOURCE]\n[PRG]\n[FILEPATH]\n[DELAY]0\n[CD TRACK]0\n" "[COMMENT]\n[END INFORMATION]\n[SUBTITLE]\n[COLF]&HFFFFFF,[STYLE]bd,[SIZE]24,[FONT]Tahoma\n"));
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		for(const SubtitleLine *line : SubtitleLinesView(subtitle)) {
 
 			Time showTime = line->showTime();
 			Time hideTime = line->hideTime();
@@ -20,6 +20,7 @@
 #include "textdemux.h"
 
 #include "core/subtitle.h"
+#include "formats/substationalpha/substationalphatext.h"
 #include "streamprocessor/streamprocessor.h"
 
 #include <KLocalizedString>
@@ -78,8 +79,7 @@ TextDemux::demuxFile(Subtitle *subtitle, const QString filename, int textStreamI
 void
 TextDemux::onStreamData(const QString &text, quint64 msecStart, quint64 msecDuration)
 {
-	SString stxt;
-	stxt.setRichString(text);
+	const SString stxt = SubStationAlphaText::toSString(text);
 
 	m_subtitleTemp->insertLine(new SubtitleLine(stxt, Time(double(msecStart)), Time(double(msecStart) + double(msecDuration))));
 }
@@ -106,7 +106,7 @@ TextDemux::onStreamError(int code, const QString &message, const QString &debug)
 void
 TextDemux::onStreamFinished()
 {
-	m_subtitle->setPrimaryData(*m_subtitleTemp, true);
+	m_subtitle->takePrimaryData(*m_subtitleTemp, true);
 	delete m_subtitleTemp;
 	m_subtitleTemp = nullptr;
 
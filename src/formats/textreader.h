@@ -0,0 +1,104 @@
+#ifndef TEXTREADER_H
+#define TEXTREADER_H
+
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QIODevice>
+#include <QScopedPointer>
+#include <QString>
+#include <QTextCodec>
+#include <QTextDecoder>
+
+namespace SubtitleComposer {
+// Reads text from device in chunks, decoding it incrementally. Line endings are
+// normalized to '\n' while decoding.
+class TextReader
+{
+public:
+	TextReader(QIODevice *device, QTextCodec *codec, int chunkSize = 64 * 1024)
+		: m_device(device),
+		  m_decoder(codec->makeDecoder()),
+		  m_chunkSize(chunkSize),
+		  m_pendingCR(false),
+		  m_atEnd(device->atEnd())
+	{}
+
+	/// true when everything was read
+	inline bool atEnd() const { return m_atEnd; }
+
+	/// appends next chunk of text to buffer, returns false if there was nothing left to read
+	bool readChunk(QString &buffer)
+	{
+		if(m_atEnd)
+			return false;
+
+		const QByteArray bytes = m_device->read(m_chunkSize);
+		m_atEnd = bytes.isEmpty() || m_device->atEnd();
+		const QString text = m_decoder->toUnicode(bytes);
+
+		const QChar *data = text.constData();
+		const int length = text.length();
+		buffer.reserve(buffer.length() + length + 1);
+
+		int from = 0;
+		if(m_pendingCR) {
+			// "\r" ended the previous chunk
+			buffer.append(QChar('\n'));
+			if(length && data[0] == QChar('\n'))
+				from = 1;
+			m_pendingCR = false;
+		}
+		for(int i = from; i < length; i++) {
+			if(data[i] != QChar('\r'))
+				continue;
+			buffer.append(data + from, i - from);
+			if(i + 1 == length) {
+				// could be followed by '\n' in the next chunk
+				m_pendingCR = !m_atEnd;
+				if(m_atEnd)
+					buffer.append(QChar('\n'));
+				from = length;
+				break;
+			}
+			buffer.append(QChar('\n'));
+			if(data[i + 1] == QChar('\n'))
+				i++;
+			from = i + 1;
+		}
+		buffer.append(data + from, length - from);
+
+		if(m_atEnd && m_pendingCR) {
+			buffer.append(QChar('\n'));
+			m_pendingCR = false;
+		}
+
+		return !bytes.isEmpty();
+	}
+
+private:
+	QIODevice *m_device;
+	QScopedPointer<QTextDecoder> m_decoder;
+	const int m_chunkSize;
+	bool m_pendingCR;
+	bool m_atEnd;
+};
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef TEXTWRITER_H
+#define TEXTWRITER_H
+
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QIODevice>
+#include <QScopedPointer>
+#include <QString>
+#include <QTextCodec>
+#include <QTextEncoder>
+
+namespace SubtitleComposer {
+// Collects text in a buffer and encodes it to device in chunks. Unicode codecs
+// start the output with a byte order mark. Without a device the text is only
+// collected in the buffer.
+class TextWriter
+{
+public:
+	TextWriter(QIODevice *device = nullptr, QTextCodec *codec = nullptr, int chunkSize = 64 * 1024)
+		: m_device(device),
+		  m_encoder(device && codec ? codec->makeEncoder() : nullptr),
+		  m_chunkSize(chunkSize),
+		  m_failed(false)
+	{
+		if(m_device)
+			m_buffer.reserve(chunkSize + chunkSize / 4);
+	}
+
+	/// text is appended here, the buffer is reused for all chunks
+	inline QString & buffer() { return m_buffer; }
+
+	/// encodes the buffer to device once it holds a whole chunk
+	inline bool commit() { return m_buffer.length() < m_chunkSize || flush(); }
+
+	/// encodes everything in the buffer to device, returns false if writing failed
+	bool flush()
+	{
+		if(!m_device || m_failed)
+			return !m_failed;
+
+		const QByteArray bytes = m_encoder->fromUnicode(m_buffer);
+		m_failed = m_device->write(bytes) != bytes.size();
+		m_buffer.resize(0); // keeps the capacity
+
+		return !m_failed;
+	}
+
+private:
+	QIODevice *m_device;
+	QScopedPointer<QTextEncoder> m_encoder;
+	const int m_chunkSize;
+	bool m_failed;
+	QString m_buffer;
+};
+}
+
+#endif
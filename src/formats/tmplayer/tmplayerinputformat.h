@@ -33,39 +33,46 @@ class TMPlayerInputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		unsigned readLines = 0;
+		const QString lines = data.left(completeLength(data, atEnd));
 
-		if(m_regExp.indexIn(data, 0) == -1)
-			return false;
+		int previousOffset = m_regExp.indexIn(lines, 0);
+		if(previousOffset == -1)
+			return atStart ? -1 : lines.length();
 
 		Time previousShowTime(m_regExp.cap(1).toInt(), m_regExp.cap(2).toInt(), m_regExp.cap(3).toInt(), 0);
 		QString previousText(m_regExp.cap(4).replace('|', '\n').trimmed());
 
-		int offset = m_regExp.matchedLength();
-		for(; m_regExp.indexIn(data, offset) != -1; offset += m_regExp.matchedLength()) {
+		int offset = previousOffset + m_regExp.matchedLength();
+		for(; m_regExp.indexIn(lines, offset) != -1; offset = m_regExp.pos() + m_regExp.matchedLength()) {
 			Time showTime(m_regExp.cap(1).toInt(), m_regExp.cap(2).toInt(), m_regExp.cap(3).toInt(), 0);
 			QString text(m_regExp.cap(4).replace('|', '\n').trimmed());
 
 			// To compensate for the format deficiencies, Subtitle Composer writes empty lines
 			// indicating that way the line hide time. We do the same.
-			if(!previousText.isEmpty()) {
+			if(!previousText.isEmpty())
 				subtitle.insertLine(new SubtitleLine(previousText, previousShowTime, showTime));
 
-				readLines++;
-			}
-
+			previousOffset = m_regExp.pos();
 			previousText = text;
 			previousShowTime = showTime;
 		}
-		if(!previousText.isEmpty()) {
+
+		// hide time of the last line is the show time of a line in the next chunk
+		if(!atEnd)
+			return previousOffset;
+
+		if(!previousText.isEmpty())
 			subtitle.insertLine(new SubtitleLine(previousText, previousShowTime, previousShowTime + 2000));
 
-			readLines++;
-		}
+		return data.length();
+	}
 
-		return true;
+	int sniff(const QString &head) const override
+	{
+		// a time followed by text is a weak signature
+		return m_regExp.indexIn(head) != -1 ? 50 : 0;
 	}
 
 	TMPlayerInputFormat() :
@@ -22,7 +22,7 @@
  */
 
 #include "formats/outputformat.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitlelinesview.h"
 
 namespace SubtitleComposer {
 class TMPlayerOutputFormat : public OutputFormat
@@ -35,8 +35,7 @@ protected:
 		QString builder;
 		QString ret;
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		for(const SubtitleLine *line : SubtitleLinesView(subtitle)) {
 
 			Time showTime = line->showTime();
 			ret += builder.sprintf(m_timeFormat, showTime.hours(), showTime.minutes(), showTime.seconds());
@@ -167,9 +167,9 @@ public:
 	}
 
 protected:
-	bool parseSubtitles(Subtitle &, const QString &) const override
+	int parseChunk(Subtitle &, const QString &, bool, bool) const override
 	{
-		return false;
+		return -1;
 	}
 
 	VobSubInputFormat()
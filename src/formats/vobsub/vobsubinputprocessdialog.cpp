@@ -19,6 +19,8 @@
 
 #include "vobsubinputprocessdialog.h"
 #include "ui_vobsubinputprocessdialog.h"
+#include "helpers/memoryusage.h"
+#include "helpers/profiler.h"
 
 #include <functional>
 
@@ -130,6 +132,8 @@ QMap<qint32, qint32> VobSubInputProcessDialog::Frame::spaceStats;
 bool
 VobSubInputProcessDialog::Frame::processPieces()
 {
+	PROFILE();
+
 	QImage pieceBitmap = subImage;
 	const int width = pieceBitmap.width();
 	const int height = pieceBitmap.height();
@@ -403,10 +407,25 @@ VobSubInputProcessDialog::VobSubInputProcessDialog(Subtitle *subtitle, QWidget *
 
 	ui->lineEdit->installEventFilter(this);
 	ui->lineEdit->setFocus();
+
+	MemoryUsage::addReporter(this, [this](MemoryUsage::Report &report){
+		qint64 frameBytes = 0;
+		qint64 pieceBytes = 0;
+		foreach(const FramePtr &frame, m_frames) {
+			frameBytes += sizeof(Frame) + frame->subImage.bytesPerLine() * frame->subImage.height();
+			foreach(const PiecePtr &piece, frame->pieces)
+				pieceBytes += sizeof(Piece) + piece->pixels.capacity() * sizeof(QPoint) + piece->text.memoryUsage();
+		}
+		for(QHash<Piece, SString>::ConstIterator it = m_recognizedPieces.begin(), end = m_recognizedPieces.end(); it != end; ++it)
+			pieceBytes += sizeof(Piece) + it.key().pixels.capacity() * sizeof(QPoint) + it.value().memoryUsage();
+		report[QStringLiteral("vobsub frames")] += frameBytes;
+		report[QStringLiteral("vobsub pieces")] += pieceBytes;
+	});
 }
 
 VobSubInputProcessDialog::~VobSubInputProcessDialog()
 {
+	MemoryUsage::removeReporters(this);
 	delete ui;
 }
 
@@ -587,6 +606,7 @@ VobSubInputProcessDialog::onStreamData(const QImage &image, quint64 msecStart, q
 	QCoreApplication::processEvents();
 
 	if(frame->processPieces()) {
+		PROFILE_COUNTER("OCR pieces", frame->pieces.size());
 		frame->index = m_frames.length();
 		ui->progressBar->setMaximum(m_frames.length());
 		m_frames.append(frame);
@@ -31,24 +31,24 @@ class YouTubeCaptionsInputFormat : public InputFormat
 	friend class FormatManager;
 
 protected:
-	bool parseSubtitles(Subtitle &subtitle, const QString &data) const override
+	int parseChunk(Subtitle &subtitle, const QString &data, bool atStart, bool atEnd) const override
 	{
-		if(m_regExp.indexIn(data, 0) == -1)
-			return false; // couldn't find first line
+		int offset = m_regExp.indexIn(data, 0);
+		if(offset == -1)
+			return atStart ? -1 : unmatchedLength(data, atEnd, 2); // couldn't find first line
 
-		unsigned readLines = 0;
+		while(offset != -1) {
+			const Time showTime(m_regExp.cap(1).toInt(), m_regExp.cap(2).toInt(), m_regExp.cap(3).toInt(), m_regExp.cap(4).toInt());
+			const Time hideTime(m_regExp.cap(5).toInt(), m_regExp.cap(6).toInt(), m_regExp.cap(7).toInt(), m_regExp.cap(8).toInt());
 
-		int offset = 0;
-		do {
-			Time showTime(m_regExp.cap(1).toInt(), m_regExp.cap(2).toInt(), m_regExp.cap(3).toInt(), m_regExp.cap(4).toInt());
+			const int textOffset = offset + m_regExp.matchedLength();
 
-			Time hideTime(m_regExp.cap(5).toInt(), m_regExp.cap(6).toInt(), m_regExp.cap(7).toInt(), m_regExp.cap(8).toInt());
+			// text ends where the next line starts, the last one could continue in next chunk
+			const int nextOffset = m_regExp.indexIn(data, textOffset);
+			if(nextOffset == -1 && !atEnd)
+				return offset;
 
-			offset += m_regExp.matchedLength();
-
-			QStringRef text(data.midRef(offset, m_regExp.indexIn(data, offset) - offset));
-
-			offset += text.length();
+			QStringRef text(data.midRef(textOffset, (nextOffset == -1 ? data.length() : nextOffset) - textOffset));
 
 			// TODO does the format actually support styled text?
 			// if so, does it use standard HTML style tags?
@@ -57,10 +57,15 @@ protected:
 
 			subtitle.insertLine(new SubtitleLine(stext, showTime, hideTime));
 
-			readLines++;
-		} while(m_regExp.matchedLength() != -1);
+			offset = nextOffset;
+		}
 
-		return readLines > 0;
+		return data.length();
+	}
+
+	int sniff(const QString &head) const override
+	{
+		return m_regExp.indexIn(head) != -1 ? 100 : 0;
 	}
 
 	YouTubeCaptionsInputFormat() :
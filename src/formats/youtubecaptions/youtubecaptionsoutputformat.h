@@ -22,7 +22,7 @@
  */
 
 #include "formats/outputformat.h"
-#include "core/subtitleiterator.h"
+#include "core/subtitle.h"
 
 namespace SubtitleComposer {
 class YouTubeCaptionsOutputFormat : public OutputFormat
@@ -34,13 +34,13 @@ protected:
 	{
 		QString ret;
 
-		for(SubtitleIterator it(subtitle); it.current(); ++it) {
-			const SubtitleLine *line = it.current();
+		for(int i = 0, n = subtitle.count(); i < n; i++) {
+			const SubtitleLine *line = subtitle.at(i);
 
 			Time showTime = line->showTime();
 			Time hideTime = line->hideTime();
 			ret += m_timeBuilder.sprintf("%d\n%02d:%02d:%02d,%03d,%02d:%02d:%02d,%03d\n",
-										 it.index() + 1, showTime.hours(),
+										 i + 1, showTime.hours(),
 										 showTime.minutes(),
 										 showTime.seconds(),
 										 showTime.mseconds(),
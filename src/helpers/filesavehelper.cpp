@@ -94,10 +94,10 @@ FileSaveHelper::close()
 		return false;
 
 	if(m_url.isLocalFile()) {
-		static_cast<QSaveFile*>(m_file)->commit();
+		bool success = static_cast<QSaveFile*>(m_file)->commit();
 		delete m_file;
 		m_file = nullptr;
-		return true;
+		return success;
 	} else {
 		m_file->close();
 		KIO::Job *job = KIO::file_copy(QUrl::fromLocalFile(m_file->fileName()), m_url, -1, m_overwrite ? KIO::Overwrite : KIO::DefaultFlags);
@@ -109,6 +109,19 @@ FileSaveHelper::close()
 	}
 }
 
+void
+FileSaveHelper::abort()
+{
+	if(!m_file)
+		return;
+
+	// the target is left untouched, the save file or the temporary file is discarded
+	if(m_url.isLocalFile())
+		static_cast<QSaveFile*>(m_file)->cancelWriting();
+	delete m_file;
+	m_file = nullptr;
+}
+
 bool
 FileSaveHelper::exists(const QUrl &url)
 {
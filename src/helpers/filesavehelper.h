@@ -37,6 +37,7 @@ public:
 
 	bool open();
 	bool close();
+	void abort();
 
 	static bool exists(const QUrl &url);
 
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "memoryusage.h"
+
+#include <QLocale>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QVector>
+
+using namespace SubtitleComposer;
+
+namespace {
+QMutex reportersMutex;
+QVector<QPair<const void *, MemoryUsage::Reporter>> reporters;
+}
+
+/*static*/ void
+MemoryUsage::addReporter(const void *owner, Reporter reporter)
+{
+	QMutexLocker locker(&reportersMutex);
+	reporters.append(qMakePair(owner, reporter));
+}
+
+/*static*/ void
+MemoryUsage::removeReporters(const void *owner)
+{
+	QMutexLocker locker(&reportersMutex);
+	for(int i = reporters.size() - 1; i >= 0; i--) {
+		if(reporters.at(i).first == owner)
+			reporters.remove(i);
+	}
+}
+
+/*static*/ MemoryUsage::Report
+MemoryUsage::report()
+{
+	Report report;
+	QMutexLocker locker(&reportersMutex);
+	for(int i = 0, n = reporters.size(); i < n; i++)
+		reporters.at(i).second(report);
+	return report;
+}
+
+/*static*/ QString
+MemoryUsage::reportText(const Report &report)
+{
+	const QLocale locale;
+	int nameWidth = 5;
+	for(Report::ConstIterator it = report.begin(), end = report.end(); it != end; ++it)
+		nameWidth = qMax(nameWidth, it.key().length());
+
+	QString text;
+	qint64 total = 0;
+	for(Report::ConstIterator it = report.begin(), end = report.end(); it != end; ++it) {
+		text += it.key().leftJustified(nameWidth + 2) + locale.toString(it.value()).rightJustified(16) + QLatin1Char('\n');
+		total += it.value();
+	}
+	text += QStringLiteral("total").leftJustified(nameWidth + 2) + locale.toString(total).rightJustified(16) + QLatin1Char('\n');
+	return text;
+}
@@ -0,0 +1,46 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QMap>
+#include <QString>
+
+#include <functional>
+
+namespace SubtitleComposer {
+// Live memory of subsystems. Subsystems register a reporter that adds their bytes to
+// the report, reporters are only called when a report is taken.
+class MemoryUsage
+{
+public:
+	/// bytes by subsystem name, entries with the same name are summed up
+	typedef QMap<QString, qint64> Report;
+	typedef std::function<void(Report &)> Reporter;
+
+	static void addReporter(const void *owner, Reporter reporter);
+	/// removes all reporters of owner, must be called before owner is destroyed
+	static void removeReporters(const void *owner);
+
+	static Report report();
+	static QString reportText(const Report &report);
+};
+}
+
+#endif // MEMORYUSAGE_H
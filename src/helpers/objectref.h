@@ -21,6 +21,7 @@
 
 #include <QObject>
 #include <QVector>
+#include <QList>
 #include <QDebug>
 #include <utility>
 
@@ -86,6 +87,158 @@ private:
 		return this >= data && this < data + vec->capacity();
 	}
 
+public:
+	// Inserts objs into container at index. The container is grown only once and its tail is moved
+	// only once, every moved and inserted object gets its m_ref rebound in the same pass.
+	static void insert(QVector<ObjectRef<T>> &container, int index, const QList<T *> &objs)
+	{
+		const int count = objs.size();
+		if(!count)
+			return;
+
+		const int oldSize = container.size();
+		Q_ASSERT(index >= 0 && index <= oldSize);
+
+		const ObjectRef<T> *oldData = container.constData();
+		container.resize(oldSize + count);
+		ObjectRef<T> *data = container.data();
+
+		if(data != oldData) {
+			// storage got reallocated - make sure the head points to its new location too
+			for(int i = 0; i < index; i++)
+				data[i].bind(data[i].m_obj);
+		}
+		for(int i = oldSize - 1; i >= index; i--)
+			data[i + count].bind(data[i].m_obj);
+		for(int i = 0; i < count; i++)
+			data[index + i].bind(objs.at(i));
+	}
+
+	// Removes count objects starting at index from container and appends them to removed (if provided).
+	// The tail is moved only once and rebound in the same pass.
+	static void remove(QVector<ObjectRef<T>> &container, int index, int count, QList<T *> *removed = nullptr)
+	{
+		if(count <= 0)
+			return;
+
+		const int oldSize = container.size();
+		Q_ASSERT(index >= 0 && index + count <= oldSize);
+
+		ObjectRef<T> *data = container.data();
+
+		if(removed) {
+			removed->reserve(removed->size() + count);
+			for(int i = index; i < index + count; i++)
+				removed->append(data[i].m_obj);
+		}
+
+		for(int i = index + count; i < oldSize; i++)
+			data[i - count].bind(data[i].m_obj);
+		for(int i = oldSize - count; i < oldSize; i++)
+			data[i].m_obj = nullptr;
+
+		container.resize(oldSize - count);
+	}
+
+	// Removes every index of ranges (sorted, disjoint and inside container) from container in one
+	// stable pass and appends the removed objects to removed (if provided) in index order.
+	template<class Ranges>
+	static void removeRanges(QVector<ObjectRef<T>> &container, const Ranges &ranges, QList<T *> *removed = nullptr)
+	{
+		auto it = ranges.begin();
+		const auto end = ranges.end();
+		if(it == end)
+			return;
+
+		const int oldSize = container.size();
+		ObjectRef<T> *data = container.data();
+
+		int src = (*it).start();
+		int dst = src;
+		for(; it != end; ++it) {
+			const int rangeStart = (*it).start();
+			const int rangeEnd = (*it).end();
+			Q_ASSERT(rangeStart >= src && rangeEnd < oldSize);
+
+			for(; src < rangeStart; src++)
+				data[dst++].bind(data[src].m_obj);
+			if(removed) {
+				for(; src <= rangeEnd; src++)
+					removed->append(data[src].m_obj);
+			}
+			src = rangeEnd + 1;
+		}
+		for(; src < oldSize; src++)
+			data[dst++].bind(data[src].m_obj);
+		for(int i = dst; i < oldSize; i++)
+			data[i].m_obj = nullptr;
+
+		container.resize(dst);
+	}
+
+	// Inverse of removeRanges() - objs are put at the indexes of ranges (as they will be after
+	// the insertion), the rest of the container keeps its order and is moved only once.
+	template<class Ranges>
+	static void insertRanges(QVector<ObjectRef<T>> &container, const Ranges &ranges, const QList<T *> &objs)
+	{
+		const int count = objs.size();
+		if(!count)
+			return;
+
+		const int oldSize = container.size();
+		const int firstIndex = (*ranges.begin()).start();
+		Q_ASSERT(firstIndex >= 0 && firstIndex <= oldSize);
+
+		QVector<T *> tail(oldSize - firstIndex);
+		for(int i = firstIndex; i < oldSize; i++)
+			tail[i - firstIndex] = container.at(i).m_obj;
+
+		const ObjectRef<T> *oldData = container.constData();
+		container.resize(oldSize + count);
+		ObjectRef<T> *data = container.data();
+
+		if(data != oldData) {
+			// storage got reallocated - make sure the head points to its new location too
+			for(int i = 0; i < firstIndex; i++)
+				data[i].bind(data[i].m_obj);
+		}
+
+		int src = 0;
+		int obj = 0;
+		int dst = firstIndex;
+		for(auto it = ranges.begin(), end = ranges.end(); it != end; ++it) {
+			for(const int rangeStart = (*it).start(); dst < rangeStart; dst++)
+				data[dst].bind(tail.at(src++));
+			for(const int rangeEnd = (*it).end(); dst <= rangeEnd; dst++)
+				data[dst].bind(objs.at(obj++));
+		}
+		Q_ASSERT(obj == count);
+		for(; dst < oldSize + count; dst++)
+			data[dst].bind(tail.at(src++));
+	}
+
+	// Reorders count = permutation.size() objects starting at index, so that the object at
+	// index + i is the one that was at index + permutation[i]. Every object is rebound once.
+	static void permute(QVector<ObjectRef<T>> &container, int index, const QVector<int> &permutation)
+	{
+		const int count = permutation.size();
+		Q_ASSERT(index >= 0 && index + count <= container.size());
+
+		QVector<T *> objs(count);
+		ObjectRef<T> *data = container.data() + index;
+		for(int i = 0; i < count; i++)
+			objs[i] = data[permutation.at(i)].m_obj;
+		for(int i = 0; i < count; i++)
+			data[i].bind(objs.at(i));
+	}
+
+private:
+	inline void bind(T *obj)
+	{
+		m_obj = obj;
+		m_obj->m_ref = this;
+	}
+
 public:
 	// helpers
 	inline T * operator->() const { Q_ASSERT(m_obj != nullptr); return m_obj; }
@@ -0,0 +1,141 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+namespace SubtitleComposer {
+namespace Parallel {
+
+// chunks smaller than this are not worth handing to another thread
+static const int MinChunkSize = 256;
+
+inline int
+chunkCount(int count, int minChunkSize = MinChunkSize)
+{
+	return qBound(1, count / minChunkSize, QThread::idealThreadCount());
+}
+
+inline int
+chunkBegin(int count, int chunks, int chunk)
+{
+	return int(qint64(count) * chunk / chunks);
+}
+
+template<class Fn>
+class ChunkRunnable : public QRunnable
+{
+public:
+	ChunkRunnable(Fn &fn, int chunk, int begin, int end, QSemaphore &done)
+		: m_fn(fn), m_chunk(chunk), m_begin(begin), m_end(end), m_done(done) {}
+
+	void run() override
+	{
+		m_fn(m_chunk, m_begin, m_end);
+		m_done.release();
+	}
+
+private:
+	Fn &m_fn;
+	const int m_chunk;
+	const int m_begin;
+	const int m_end;
+	QSemaphore &m_done;
+};
+
+// Splits [0, count) into chunks and calls fn(chunk, begin, end) for each of them on the
+// global thread pool. The calling thread processes the first chunk and returns once all
+// chunks are done.
+template<class Fn>
+void
+forChunks(int count, int chunks, Fn fn)
+{
+	if(count <= 0)
+		return;
+
+	QSemaphore done;
+	for(int chunk = 1; chunk < chunks; chunk++)
+		QThreadPool::globalInstance()->start(new ChunkRunnable<Fn>(fn, chunk, chunkBegin(count, chunks, chunk), chunkBegin(count, chunks, chunk + 1), done));
+
+	fn(0, 0, chunkBegin(count, chunks, 1));
+
+	done.acquire(chunks - 1);
+}
+
+template<class Fn>
+void
+forEach(int count, Fn fn)
+{
+	forChunks(count, chunkCount(count), [&](int, int begin, int end){
+		for(int i = begin; i < end; i++)
+			fn(i);
+	});
+}
+
+// Ordered scan where a boolean state is carried from one item to the next:
+//   results[i] = fn(i, &state)
+// segmentStart(i, &state) returns true and sets the state when a new segment starts
+// at item i (it must do so for item 0).
+// Every chunk but the first starts speculatively with state = false, then chunk
+// boundaries are fixed up in order - items are recomputed only until the real state
+// matches the speculated one again (usually right at the first item).
+template<class T, class Fn, class SegmentFn>
+void
+orderedScan(int count, T *results, Fn fn, SegmentFn segmentStart)
+{
+	if(count <= 0)
+		return;
+
+	const int chunks = chunkCount(count);
+	QVector<char> states(count);
+	char *stateOut = states.data();
+
+	forChunks(count, chunks, [&](int, int begin, int end){
+		bool state = false;
+		for(int i = begin; i < end; i++) {
+			segmentStart(i, &state);
+			results[i] = fn(i, &state);
+			stateOut[i] = state;
+		}
+	});
+
+	for(int chunk = 1; chunk < chunks; chunk++) {
+		const int begin = chunkBegin(count, chunks, chunk);
+		const int end = chunkBegin(count, chunks, chunk + 1);
+		bool state = stateOut[begin - 1];
+		bool speculated = false;
+		for(int i = begin; i < end; i++) {
+			if(segmentStart(i, &state) || state == speculated)
+				break;
+			speculated = stateOut[i];
+			results[i] = fn(i, &state);
+			stateOut[i] = state;
+		}
+	}
+}
+
+}
+}
+
+#endif // PARALLEL_H
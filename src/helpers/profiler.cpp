@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "profiler.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+using namespace SubtitleComposer;
+
+std::atomic<bool> Profiler::s_enabled(false);
+
+namespace {
+// events recorded per thread, further events are dropped
+const int maxThreadEvents = 1024 * 1024;
+
+struct Event {
+	const char *name;
+	qint64 time;
+	qint64 value; // duration of zone or value of counter
+	bool isCounter;
+};
+
+// every thread records into its own buffer, its lock is only contended while exporting
+struct ThreadBuffer {
+	int id;
+	QByteArray name;
+	QMutex mutex;
+	QVector<Event> events;
+};
+
+struct Trace {
+	QMutex mutex;
+	QElapsedTimer timer;
+	// buffers are never freed - they are few and hold events of finished threads
+	QVector<ThreadBuffer *> buffers;
+};
+
+Trace &
+trace()
+{
+	static Trace trace;
+	return trace;
+}
+
+QByteArray
+threadName()
+{
+	const QThread *thread = QThread::currentThread();
+	if(QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+		return QByteArrayLiteral("main");
+	if(!thread->objectName().isEmpty())
+		return thread->objectName().toUtf8();
+	return QByteArray(thread->metaObject()->className());
+}
+
+ThreadBuffer *
+threadBuffer()
+{
+	static thread_local ThreadBuffer *buffer = nullptr;
+	if(!buffer) {
+		Trace &t = trace();
+		QMutexLocker locker(&t.mutex);
+		buffer = new ThreadBuffer();
+		buffer->id = t.buffers.size() + 1;
+		buffer->name = threadName();
+		t.buffers.append(buffer);
+	}
+	return buffer;
+}
+
+void
+addEvent(const Event &event)
+{
+	ThreadBuffer *buffer = threadBuffer();
+	QMutexLocker locker(&buffer->mutex);
+	if(buffer->events.size() < maxThreadEvents)
+		buffer->events.append(event);
+}
+
+QByteArray
+jsonString(const char *str)
+{
+	QByteArray json("\"");
+	for(; *str; str++) {
+		const char ch = *str;
+		if(ch == '"' || ch == '\\')
+			json.append('\\').append(ch);
+		else if(uchar(ch) < 0x20)
+			json.append("\\u00").append(QByteArray::number(int(ch), 16).rightJustified(2, '0'));
+		else
+			json.append(ch);
+	}
+	return json.append('"');
+}
+
+inline QByteArray
+micros(qint64 nsecs)
+{
+	return QByteArray::number(double(nsecs) / 1000., 'f', 3);
+}
+}
+
+/*static*/ void
+Profiler::setEnabled(bool enabled)
+{
+	Trace &t = trace();
+	QMutexLocker locker(&t.mutex);
+	if(enabled && !t.timer.isValid())
+		t.timer.start();
+	s_enabled.store(enabled, std::memory_order_release);
+}
+
+/*static*/ qint64
+Profiler::timestamp()
+{
+	return trace().timer.nsecsElapsed();
+}
+
+/*static*/ void
+Profiler::addZone(const char *name, qint64 start, qint64 end)
+{
+	addEvent(Event{name, start, end - start, false});
+}
+
+/*static*/ void
+Profiler::addCounter(const char *name, qint64 value)
+{
+	addEvent(Event{name, timestamp(), value, true});
+}
+
+/*static*/ void
+Profiler::clear()
+{
+	Trace &t = trace();
+	QMutexLocker locker(&t.mutex);
+	for(ThreadBuffer *buffer : t.buffers) {
+		QMutexLocker bufferLocker(&buffer->mutex);
+		buffer->events.clear();
+	}
+}
+
+/*static*/ bool
+Profiler::exportTrace(const QString &fileName)
+{
+	QFile file(fileName);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		qWarning() << "Failed to write trace file" << fileName << file.errorString();
+		return false;
+	}
+
+	const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+	QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	const char *separator = "";
+
+	Trace &t = trace();
+	QMutexLocker locker(&t.mutex);
+	for(ThreadBuffer *buffer : t.buffers) {
+		QMutexLocker bufferLocker(&buffer->mutex);
+		const QByteArray tid = QByteArray::number(buffer->id);
+
+		json.append(separator)
+			.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":").append(pid)
+			.append(",\"tid\":").append(tid)
+			.append(",\"args\":{\"name\":").append(jsonString(buffer->name.constData())).append("}}");
+		separator = ",\n";
+
+		for(const Event &event : buffer->events) {
+			json.append(separator)
+				.append("{\"name\":").append(jsonString(event.name))
+				.append(",\"ph\":").append(event.isCounter ? "\"C\"" : "\"X\"")
+				.append(",\"ts\":").append(micros(event.time));
+			if(event.isCounter)
+				json.append(",\"args\":{\"value\":").append(QByteArray::number(event.value)).append('}');
+			else
+				json.append(",\"dur\":").append(micros(event.value));
+			json.append(",\"pid\":").append(pid)
+				.append(",\"tid\":").append(tid).append('}');
+
+			if(json.size() > 64 * 1024) {
+				file.write(json);
+				json.clear();
+			}
+		}
+	}
+	json.append("\n]}\n");
+	file.write(json);
+
+	return file.error() == QFileDevice::NoError;
+}
@@ -0,0 +1,81 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/*
+ * Copyright (C) 2007-2009 Sergio Pistone <sergio_pistone@yahoo.com.ar>
+ * Copyright (C) 2010-2019 Mladen Milinkovic <max@smoothware.net>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QtGlobal>
+
+#include <atomic>
+
+QT_FORWARD_DECLARE_CLASS(QString)
+
+namespace SubtitleComposer {
+// Scoped trace zone, records how long the enclosing scope took on the current thread.
+// Zones and counters are only recorded while tracing is enabled, otherwise they cost
+// a single atomic load. Recorded events are exported in Chrome trace event format,
+// which can be opened in chrome://tracing or ui.perfetto.dev.
+class Profiler
+{
+public:
+	/// name is stored as is - use string literals or Q_FUNC_INFO
+	explicit inline Profiler(const char *name)
+		: m_name(isEnabled() ? name : nullptr),
+		  m_start(m_name ? timestamp() : 0)
+	{}
+
+	inline ~Profiler()
+	{
+		if(m_name)
+			addZone(m_name, m_start, timestamp());
+	}
+
+	static inline bool isEnabled() { return s_enabled.load(std::memory_order_acquire); }
+	static void setEnabled(bool enabled);
+
+	/// records current value of the named counter
+	static inline void counter(const char *name, qint64 value)
+	{
+		if(isEnabled())
+			addCounter(name, value);
+	}
+
+	static void clear();
+	static bool exportTrace(const QString &fileName);
+
+private:
+	static qint64 timestamp();
+	static void addZone(const char *name, qint64 start, qint64 end);
+	static void addCounter(const char *name, qint64 value);
+
+	static std::atomic<bool> s_enabled;
+
+	const char *m_name;
+	const qint64 m_start;
+
+	Q_DISABLE_COPY(Profiler)
+};
+}
+
+#define PROFILE() SubtitleComposer::Profiler _p_r_o_f_i_l_e_r_(Q_FUNC_INFO)
+#define PROFILE2(x) SubtitleComposer::Profiler _p_r_o_f_i_l_e_r_(x)
+#define PROFILE_COUNTER(name, value) SubtitleComposer::Profiler::counter(name, qint64(value))
+
+#endif
@@ -22,7 +22,7 @@
 #include "application.h"
 #include "actions/useractionnames.h"
 #include "dialogs/actionwithtargetdialog.h"
-#include "profiler.h"
+#include "helpers/profiler.h"
 
 #ifdef HAVE_CONFIG_H
 # include "config.h"
@@ -86,13 +86,18 @@ LinesModel::setSubtitle(Subtitle *subtitle)
 		if(m_subtitle) {
 			disconnect(m_subtitle, SIGNAL(linesInserted(int, int)), this, SLOT(onLinesInserted(int, int)));
 			disconnect(m_subtitle, SIGNAL(linesRemoved(int, int)), this, SLOT(onLinesRemoved(int, int)));
+			disconnect(m_subtitle, &Subtitle::lineRangesAboutToBeInserted, this, &LinesModel::onLineRangesAboutToBeChanged);
+			disconnect(m_subtitle, &Subtitle::lineRangesInserted, this, &LinesModel::onLineRangesChanged);
+			disconnect(m_subtitle, &Subtitle::lineRangesAboutToBeRemoved, this, &LinesModel::onLineRangesAboutToBeChanged);
+			disconnect(m_subtitle, &Subtitle::lineRangesRemoved, this, &LinesModel::onLineRangesChanged);
+			disconnect(m_subtitle, &Subtitle::linesAboutToBeReordered, this, &LinesModel::onLinesAboutToBeReordered);
+			disconnect(m_subtitle, &Subtitle::linesReordered, this, &LinesModel::onLinesReordered);
 
 			disconnect(m_subtitle, &Subtitle::lineAnchorChanged, this, &LinesModel::onLineChanged);
-			disconnect(m_subtitle, &Subtitle::lineErrorFlagsChanged, this, &LinesModel::onLineChanged);
-			disconnect(m_subtitle, &Subtitle::linePrimaryTextChanged, this, &LinesModel::onLineChanged);
-			disconnect(m_subtitle, &Subtitle::lineSecondaryTextChanged, this, &LinesModel::onLineChanged);
-			disconnect(m_subtitle, &Subtitle::lineShowTimeChanged, this, &LinesModel::onLineChanged);
-			disconnect(m_subtitle, &Subtitle::lineHideTimeChanged, this, &LinesModel::onLineChanged);
+			disconnect(m_subtitle, &Subtitle::linesErrorFlagsChanged, this, &LinesModel::onLinesChanged);
+			disconnect(m_subtitle, &Subtitle::linesPrimaryTextChanged, this, &LinesModel::onLinesChanged);
+			disconnect(m_subtitle, &Subtitle::linesSecondaryTextChanged, this, &LinesModel::onLinesChanged);
+			disconnect(m_subtitle, &Subtitle::linesTimesChanged, this, &LinesModel::onLinesChanged);
 
 			if(m_subtitle->linesCount()) {
 				onLinesRemoved(0, m_subtitle->linesCount() - 1);
@@ -108,13 +113,18 @@ LinesModel::setSubtitle(Subtitle *subtitle)
 
 			connect(m_subtitle, SIGNAL(linesInserted(int, int)), this, SLOT(onLinesInserted(int, int)));
 			connect(m_subtitle, SIGNAL(linesRemoved(int, int)), this, SLOT(onLinesRemoved(int, int)));
+			connect(m_subtitle, &Subtitle::lineRangesAboutToBeInserted, this, &LinesModel::onLineRangesAboutToBeChanged);
+			connect(m_subtitle, &Subtitle::lineRangesInserted, this, &LinesModel::onLineRangesChanged);
+			connect(m_subtitle, &Subtitle::lineRangesAboutToBeRemoved, this, &LinesModel::onLineRangesAboutToBeChanged);
+			connect(m_subtitle, &Subtitle::lineRangesRemoved, this, &LinesModel::onLineRangesChanged);
+			connect(m_subtitle, &Subtitle::linesAboutToBeReordered, this, &LinesModel::onLinesAboutToBeReordered);
+			connect(m_subtitle, &Subtitle::linesReordered, this, &LinesModel::onLinesReordered);
 
 			connect(m_subtitle, &Subtitle::lineAnchorChanged, this, &LinesModel::onLineChanged);
-			connect(m_subtitle, &Subtitle::lineErrorFlagsChanged, this, &LinesModel::onLineChanged);
-			connect(m_subtitle, &Subtitle::linePrimaryTextChanged, this, &LinesModel::onLineChanged);
-			connect(m_subtitle, &Subtitle::lineSecondaryTextChanged, this, &LinesModel::onLineChanged);
-			connect(m_subtitle, &Subtitle::lineShowTimeChanged, this, &LinesModel::onLineChanged);
-			connect(m_subtitle, &Subtitle::lineHideTimeChanged, this, &LinesModel::onLineChanged);
+			connect(m_subtitle, &Subtitle::linesErrorFlagsChanged, this, &LinesModel::onLinesChanged);
+			connect(m_subtitle, &Subtitle::linesPrimaryTextChanged, this, &LinesModel::onLinesChanged);
+			connect(m_subtitle, &Subtitle::linesSecondaryTextChanged, this, &LinesModel::onLinesChanged);
+			connect(m_subtitle, &Subtitle::linesTimesChanged, this, &LinesModel::onLinesChanged);
 		}
 	}
 }
@@ -340,19 +350,67 @@ LinesModel::onLinesRemoved(int firstIndex, int lastIndex)
 	endRemoveRows();
 }
 
+void
+LinesModel::onLineRangesAboutToBeChanged()
+{
+	// rows of several disjoint ranges change at once, views can't be told about them one range at a time
+	beginResetModel();
+}
+
+void
+LinesModel::onLineRangesChanged()
+{
+	endResetModel();
+}
+
+void
+LinesModel::onLinesAboutToBeReordered()
+{
+	emit layoutAboutToBeChanged();
+}
+
+void
+LinesModel::onLinesReordered(int firstIndex, int lastIndex, const QVector<int> &permutation)
+{
+	QVector<int> newRows(permutation.size());
+	for(int i = 0, n = permutation.size(); i < n; i++)
+		newRows[permutation.at(i)] = firstIndex + i;
+
+	const QModelIndexList indexes = persistentIndexList();
+	for(const QModelIndex &index : indexes) {
+		if(index.row() >= firstIndex && index.row() <= lastIndex)
+			changePersistentIndex(index, createIndex(newRows.at(index.row() - firstIndex), index.column()));
+	}
+
+	emit layoutChanged();
+}
+
 void
 LinesModel::onLineChanged(const SubtitleLine *line)
 {
-	int lineIndex = line->index();
+	const int lineIndex = line->index();
+	onLinesChanged(Range(lineIndex, lineIndex));
+}
+
+void
+LinesModel::onLinesChanged(const RangeList &ranges)
+{
+	if(ranges.isEmpty())
+		return;
+
+	const int firstIndex = ranges.firstIndex();
+	const int lastIndex = ranges.lastIndex();
 
 	if(m_minChangedLineIndex < 0) {
-		m_minChangedLineIndex = lineIndex;
-		m_maxChangedLineIndex = lineIndex;
+		m_minChangedLineIndex = firstIndex;
+		m_maxChangedLineIndex = lastIndex;
 		m_dataChangedTimer->start();
-	} else if(lineIndex < m_minChangedLineIndex)
-		m_minChangedLineIndex = lineIndex;
-	else if(lineIndex > m_maxChangedLineIndex)
-		m_maxChangedLineIndex = lineIndex;
+	} else {
+		if(firstIndex < m_minChangedLineIndex)
+			m_minChangedLineIndex = firstIndex;
+		if(lastIndex > m_maxChangedLineIndex)
+			m_maxChangedLineIndex = lastIndex;
+	}
 }
 
 void
@@ -69,8 +69,13 @@ public:
 private slots:
 	void onLinesInserted(int firstIndex, int lastIndex);
 	void onLinesRemoved(int firstIndex, int lastIndex);
+	void onLineRangesAboutToBeChanged();
+	void onLineRangesChanged();
+	void onLinesAboutToBeReordered();
+	void onLinesReordered(int firstIndex, int lastIndex, const QVector<int> &permutation);
 
 	void onLineChanged(const SubtitleLine *line);
+	void onLinesChanged(const RangeList &ranges);
 	void emitDataChanged();
 
 private:
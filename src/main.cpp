@@ -21,6 +21,7 @@
 #include "application.h"
 #include "mainwindow.h"
 #include "helpers/commondefs.h"
+#include "helpers/profiler.h"
 
 #include <KAboutData>
 #include <KLocalizedString>
@@ -100,6 +101,8 @@ main(int argc, char **argv)
 	parser.addVersionOption();
 	parser.addPositionalArgument("primary-url", i18n("Open location as primary subtitle"), "[primary-url]");
 	parser.addPositionalArgument("translation-url", i18n("Open location as translation subtitle"), "[translation-url]");
+	QCommandLineOption traceOption(QStringLiteral("trace"), i18n("Record a performance trace and write it to file on exit (Chrome trace format)"), QStringLiteral("file"));
+	parser.addOption(traceOption);
 
 	// do the command line parsing
 	parser.process(app);
@@ -107,6 +110,10 @@ main(int argc, char **argv)
 	// handle standard options
 	aboutData.processCommandLine(&parser);
 
+	const QString traceFile = parser.value(traceOption);
+	if(!traceFile.isEmpty())
+		SubtitleComposer::Profiler::setEnabled(true);
+
 	app.init();
 
 	app.mainWindow()->show();
@@ -118,5 +125,10 @@ main(int argc, char **argv)
 	if(args.length() > 1)
 		app.openSubtitleTr(System::urlFromPath(args[1]));
 
-	return app.exec();
+	const int ret = app.exec();
+
+	if(!traceFile.isEmpty())
+		SubtitleComposer::Profiler::exportTrace(traceFile);
+
+	return ret;
 }
@@ -22,7 +22,6 @@
 #include "application.h"
 #include "actions/useractionnames.h"
 #include "helpers/commondefs.h"
-#include "core/subtitleiterator.h"
 #include "videoplayer/playerbackend.h"
 #include "videoplayer/videoplayer.h"
 #include "widgets/layeredwidget.h"
@@ -515,6 +514,10 @@ PlayerWidget::setSubtitle(Subtitle *subtitle)
 	if(m_subtitle) {
 		disconnect(m_subtitle, SIGNAL(linesInserted(int, int)), this, SLOT(invalidateOverlayLine()));
 		disconnect(m_subtitle, SIGNAL(linesRemoved(int, int)), this, SLOT(invalidateOverlayLine()));
+		disconnect(m_subtitle, &Subtitle::lineRangesInserted, this, &PlayerWidget::invalidateOverlayLine);
+		disconnect(m_subtitle, &Subtitle::lineRangesRemoved, this, &PlayerWidget::invalidateOverlayLine);
+		disconnect(m_subtitle, &Subtitle::linesReordered, this, &PlayerWidget::invalidateOverlayLine);
+		disconnect(m_subtitle, &Subtitle::linesTimesChanged, this, &PlayerWidget::onLinesTimesChanged);
 
 		m_subtitle = 0;                 // has to be set to 0 for invalidateOverlayLine
 
@@ -527,6 +530,10 @@ PlayerWidget::setSubtitle(Subtitle *subtitle)
 	if(m_subtitle) {
 		connect(m_subtitle, SIGNAL(linesInserted(int, int)), this, SLOT(invalidateOverlayLine()));
 		connect(m_subtitle, SIGNAL(linesRemoved(int, int)), this, SLOT(invalidateOverlayLine()));
+		connect(m_subtitle, &Subtitle::lineRangesInserted, this, &PlayerWidget::invalidateOverlayLine);
+		connect(m_subtitle, &Subtitle::lineRangesRemoved, this, &PlayerWidget::invalidateOverlayLine);
+		connect(m_subtitle, &Subtitle::linesReordered, this, &PlayerWidget::invalidateOverlayLine);
+		connect(m_subtitle, &Subtitle::linesTimesChanged, this, &PlayerWidget::onLinesTimesChanged);
 	}
 }
 
@@ -591,17 +598,15 @@ PlayerWidget::updateOverlayLine(const Time &videoPosition)
 
 	if(seekedBackwards || m_lastSearchedLineToShowTime > videoPosition) {
 		// search the next line to show
-		for(SubtitleIterator it(*m_subtitle); it.current(); ++it) {
-			if(videoPosition <= it.current()->hideTime()) {
-				m_lastSearchedLineToShowTime = videoPosition;
+		SubtitleLine *line = m_subtitle->firstLineHiddenAfter(videoPosition);
+		if(line) {
+			m_lastSearchedLineToShowTime = videoPosition;
 
-				setOverlayLine(it.current());
+			setOverlayLine(line);
 
-				if(m_overlayLine->showTime() <= videoPosition && videoPosition <= m_overlayLine->hideTime()) {
-					const SString &text = m_showTranslation ? m_overlayLine->secondaryText() : m_overlayLine->primaryText();
-					m_textOverlay->setText(text.richString(SString::Verbose));
-				}
-				return;
+			if(m_overlayLine->showTime() <= videoPosition && videoPosition <= m_overlayLine->hideTime()) {
+				const SString &text = m_showTranslation ? m_overlayLine->secondaryText() : m_overlayLine->primaryText();
+				m_textOverlay->setText(text.richString(SString::Verbose));
 			}
 		}
 	}
@@ -623,17 +628,9 @@ PlayerWidget::updatePlayingLine(const Time &videoPosition)
 		return;
 	}
 
-	// iterate through all lines and find the playing line
-	SubtitleIterator it(*m_subtitle);
-	while(it.current()) {
-		if(videoPosition <= it.current()->hideTime() && videoPosition >= it.current()->showTime()) {
-			setPlayingLine(it.current());
-			return;
-		}
-		++it;
-	}
-
-	setPlayingLine(nullptr);
+	// find the playing line in subtitle's time index
+	const QList<SubtitleLine *> lines = m_subtitle->linesInTimeRange(videoPosition, videoPosition);
+	setPlayingLine(lines.isEmpty() ? nullptr : lines.first());
 }
 
 void
@@ -654,19 +651,18 @@ PlayerWidget::invalidateOverlayLine()
 }
 
 void
-PlayerWidget::setOverlayLine(SubtitleLine *line)
+PlayerWidget::onLinesTimesChanged(const RangeList &ranges)
 {
-	if(m_overlayLine) {
-		disconnect(m_overlayLine, SIGNAL(showTimeChanged(const Time &)), this, SLOT(invalidateOverlayLine()));
-		disconnect(m_overlayLine, SIGNAL(hideTimeChanged(const Time &)), this, SLOT(invalidateOverlayLine()));
-	}
+	if(m_overlayLine && ranges.contains(m_overlayLine->index()))
+		invalidateOverlayLine();
+}
 
+void
+PlayerWidget::setOverlayLine(SubtitleLine *line)
+{
 	m_overlayLine = line;
 
-	if(m_overlayLine) {
-		connect(m_overlayLine, SIGNAL(showTimeChanged(const Time &)), this, SLOT(invalidateOverlayLine()));
-		connect(m_overlayLine, SIGNAL(hideTimeChanged(const Time &)), this, SLOT(invalidateOverlayLine()));
-	} else
+	if(!m_overlayLine)
 		m_lastSearchedLineToShowTime = Time::MaxMseconds;
 }
 
@@ -93,6 +93,7 @@ private:
 
 private slots:
 	void invalidateOverlayLine();
+	void onLinesTimesChanged(const RangeList &ranges);
 
 	void onVolumeSliderValueChanged(int value);
 	void onSeekSliderValueChanged(int value);
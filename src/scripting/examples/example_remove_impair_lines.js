@@ -18,8 +18,7 @@
  ***************************************************************************/
 
 s = subtitle.instance();
-for ( var lineIndex = s.linesCount() - 1; lineIndex >= 0; --lineIndex )
-{
-	if ( lineIndex % 2 == 0 )
-		s.removeLine( lineIndex );
-}
+impairLines = ranges.newEmptyRangeList();
+for ( var lineIndex = 0; lineIndex < s.linesCount(); lineIndex += 2 )
+	impairLines.addIndex( lineIndex );
+s.removeLines( impairLines );
@@ -18,6 +18,7 @@
  ***************************************************************************/
 
 var s = subtitle.instance();
+var emptyLines = ranges.newEmptyRangeList();
 for(var i = s.linesCount() - 1; i >= 0; i--) {
 	var line = s.line(i),
 		text = line.richPrimaryText()
@@ -26,7 +27,8 @@ for(var i = s.linesCount() - 1; i >= 0; i--) {
 			.replace(/^(<.*>)?.*:\s*/, '$1')
 			.replace(/(^\s*|\s*$)/, '');
 	if(text.replace(/(<[^>]+>|\s)/, '') == '')
-		s.removeLine(i);
+		emptyLines.addIndex(i);
 	else
 		line.setRichPrimaryText(text);
 }
+s.removeLines(emptyLines);
@@ -19,13 +19,13 @@
 
 #include "streamprocessor.h"
 #include "helpers/languagecode.h"
+#include "helpers/profiler.h"
 
 #include <QApplication>
 #include <QDebug>
 #include <QThread>
 #include <QPixmap>
 #include <QImage>
-#include <QRegularExpression>
 
 #include <cinttypes>
 
@@ -406,6 +406,8 @@ StreamProcessor::processAudio()
 		}
 
 		if(pkt.stream_index == m_audioStreamCurrent || drainDecoder) {
+			PROFILE2("StreamProcessor decode audio packet");
+
 			ret = avcodec_send_packet(m_codecCtx, &pkt);
 			if(ret < 0) {
 				if(ret != AVERROR(EAGAIN)) {
@@ -460,6 +462,7 @@ StreamProcessor::processAudio()
 					if(!drainResampler) {
 						m_streamPos = timeFrameEnd;
 						emit streamProgress(m_streamPos, m_streamLen);
+						PROFILE_COUNTER("decoded audio ms", m_streamPos);
 					}
 
 					if(m_swResample) {
@@ -565,45 +568,10 @@ StreamProcessor::processText()
 										  "{\\c&H0000ff&}red {\\c&H00ff00&}green {\\c&Hff0000&}blue{\\r}\\n"
 										  "Another {\\b100}bold\\h{\\i1}bolditalic{\\b0\\i0} some{\\anidfsd} unspported tag";
 #endif
-					QString assChunk(assText);
-
-					assChunk
-							.replace(QStringLiteral("\\N"), QStringLiteral("\n"))
-							.replace(QStringLiteral("\\n"), QStringLiteral("\n"))
-							.replace(QStringLiteral("\\h"), QStringLiteral(" "));
-
-#define ANY_ASS_VAL "[^}\\\\]*"
-#define ANY_ASS_TAG "(?:\\\\" ANY_ASS_VAL ")*"
-
-					// replace rich text style tags
-					for(;;) {
-						const static QRegularExpression reStyle(QStringLiteral("\\{" ANY_ASS_TAG "\\\\([bius])(\\d+)" ANY_ASS_TAG "\\}"), QRegularExpression::CaseInsensitiveOption);
-						QRegularExpressionMatch match = reStyle.match(assChunk);
-						if(!match.hasMatch())
-							break;
-						QString repl("<%1%2>");
-						assChunk.insert(match.capturedEnd(0), repl
-									.arg(match.captured(2) == QStringLiteral("0") ? QStringLiteral("/") : QStringLiteral(""))
-									.arg(match.captured(1)));
-						assChunk.remove(match.capturedStart(1), match.capturedLength(2) + 1);
-					}
-
-					// replace text color tags
-					const static QRegularExpression reStyleColor(QStringLiteral("\\{" ANY_ASS_TAG "\\\\c&H([a-z0-9]{2})([a-z0-9]{2})([a-z0-9]{2})&" ANY_ASS_TAG "\\}"), QRegularExpression::CaseInsensitiveOption);
-					assChunk.replace(reStyleColor, QStringLiteral("<font color=\"#\\3\\2\\1\">"));
-
-					// replace reset tags
-					const static QRegularExpression reStyleReset(QStringLiteral("\\{" ANY_ASS_TAG "\\\\r" ANY_ASS_VAL ANY_ASS_TAG "\\}"), QRegularExpression::CaseInsensitiveOption);
-					assChunk.replace(reStyleReset, QStringLiteral("</font></b></i></u></s>"));
-
-					// remove unsupported/empty tags
-					const static QRegularExpression reUnsupported(QStringLiteral("\\{" ANY_ASS_TAG "\\}"));
-					assChunk.remove(reUnsupported);
-
-					// append chunk
+					// append chunk, override tags are kept for the receiver to parse
 					if(!text.isEmpty())
 						text.append(QChar('\n'));
-					text.append(assChunk);
+					text.append(QString::fromUtf8(assText));
 
 					break;
 				}
@@ -646,6 +614,8 @@ StreamProcessor::processText()
 /*virtual*/ void
 StreamProcessor::run()
 {
+	PROFILE();
+
 	if(m_audioReady)
 		processAudio();
 	else if(m_imageReady || m_textReady)
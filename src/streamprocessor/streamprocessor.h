@@ -62,6 +62,7 @@ public:
 
 signals:
 	void audioDataAvailable(const void *buffer, const qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 msecDuration);
+	// text of ASS events, override tags included
 	void textDataAvailable(const QString &text, const quint64 msecStart, const quint64 msecDuration);
 	void imageDataAvailable(const QImage &image, const quint64 msecStart, const quint64 msecDuration);
 	void streamProgress(quint64 msecPosition, quint64 msecLength);
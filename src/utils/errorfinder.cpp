@@ -137,6 +137,7 @@ ErrorFinder::find(const RangeList &selectionRanges, int currentIndex, bool findB
 	invalidate();
 
 	m_dialog->setFindBackwards(findBackwards);
+	m_dialog->setErrorCounts(m_subtitle);
 
 	if(m_dialog->exec() != QDialog::Accepted)
 		return;
@@ -154,10 +155,6 @@ ErrorFinder::find(const RangeList &selectionRanges, int currentIndex, bool findB
 	if(m_dialog->findFromCurrent())
 		m_iterator->toIndex(currentIndex < 0 ? 0 : currentIndex);
 
-	m_allSearchedIndex = m_iterator->index();
-
-	m_instancesFound = false;
-
 	advance(false);
 }
 
@@ -185,70 +182,60 @@ ErrorFinder::findPrevious()
 	return true;
 }
 
-void
-ErrorFinder::advance(bool advanceIteratorOnFirstStep)
+int
+ErrorFinder::findErrorLine(const RangeList &ranges, int fromIndex) const
 {
-	bool foundError = false;
-
-	do {
-		if(advanceIteratorOnFirstStep) {
-			if(m_findBackwards)
-				--(*m_iterator);
-			else
-				++(*m_iterator);
-
-			if(m_iterator->index() < 0) {
-				if(m_findBackwards)
-					m_iterator->toLast();
-				else
-					m_iterator->toFirst();
-
-				if(KMessageBox::warningContinueCancel(parentWidget(), m_findBackwards ? (m_selection ? i18n("Beginning of selection reached.\nContinue from the end?") : i18n("Beginning of subtitle reached.\nContinue from the end?")) : (m_selection ? i18n("End of selection reached.\nContinue from the beginning?") : i18n("End of subtitle reached.\nContinue from the beginning?")), i18n("Find Error")
-													  ) != KMessageBox::Continue)
-					break;
-			}
+	// the error index skips lines without errors, ranges without matches are skipped whole
+	if(m_findBackwards) {
+		for(RangeList::ConstIterator it = ranges.end(), begin = ranges.begin(); it != begin;) {
+			--it;
+			if((*it).start() > fromIndex)
+				continue;
+			const int index = m_subtitle->previousErrorLine(qMin(fromIndex, (*it).end()), m_targetErrorFlags);
+			if(index < 0 || index >= (*it).start())
+				return index;
+			fromIndex = index;
 		}
-
-		advanceIteratorOnFirstStep = true;
-		foundError = m_iterator->current()->errorFlags() & m_targetErrorFlags;
-
-		if(!foundError) {
-			// special case: we searched all lines and didn't found any matches
-			if(!m_instancesFound && (m_allSearchedIndex == m_iterator->index() || (m_findBackwards ? (m_allSearchedIndex == m_iterator->lastIndex() && m_iterator->index() == SubtitleIterator::BehindFirst) : (m_allSearchedIndex == m_iterator->firstIndex() && m_iterator->index() == SubtitleIterator::AfterLast))
-									 ))
-			{
-				KMessageBox::sorry(parentWidget(), i18n("No errors matching given criteria found!"), i18n("Find Error")
-								   );
-				invalidate();
-				break;
-			}
+	} else {
+		for(RangeList::ConstIterator it = ranges.begin(), end = ranges.end(); it != end; ++it) {
+			if((*it).end() < fromIndex)
+				continue;
+			const int index = m_subtitle->nextErrorLine(qMax(fromIndex, (*it).start()), m_targetErrorFlags);
+			if(index < 0 || index <= (*it).end())
+				return index;
+			fromIndex = index;
 		}
-	} while(!foundError);
-
-	if(foundError) {
-		m_instancesFound = true;
-		emit found(m_iterator->current());
 	}
+	return -1;
 }
 
 void
-ErrorFinder::onIteratorSynchronized(int firstIndex, int lastIndex, bool inserted)
+ErrorFinder::advance(bool advanceIteratorOnFirstStep)
 {
-	if(m_iterator->index() == SubtitleIterator::Invalid) {
-		invalidate();
-		return;
-	}
+	const RangeList ranges = m_iterator->ranges();
+
+	int fromIndex = m_iterator->index();
+	if(fromIndex < 0)
+		fromIndex = m_findBackwards ? ranges.lastIndex() : ranges.firstIndex();
+	else if(advanceIteratorOnFirstStep)
+		fromIndex += m_findBackwards ? -1 : 1;
+
+	int index = findErrorLine(ranges, fromIndex);
+	if(index < 0) {
+		const int wrapIndex = findErrorLine(ranges, m_findBackwards ? ranges.lastIndex() : ranges.firstIndex());
+		if(wrapIndex < 0) {
+			KMessageBox::sorry(parentWidget(), i18n("No errors matching given criteria found!"), i18n("Find Error"));
+			invalidate();
+			return;
+		}
 
-	int linesCount = lastIndex - firstIndex + 1;
-	if(inserted) {
-		if(m_allSearchedIndex >= firstIndex)
-			m_allSearchedIndex += linesCount;
-	} else {
-		if(m_allSearchedIndex > lastIndex)
-			m_allSearchedIndex -= linesCount;
-		else if(m_allSearchedIndex >= firstIndex && m_allSearchedIndex <= lastIndex) // was one of the removed lines
-			m_allSearchedIndex = m_iterator->index();
-	}
-}
+		if(KMessageBox::warningContinueCancel(parentWidget(), m_findBackwards ? (m_selection ? i18n("Beginning of selection reached.\nContinue from the end?") : i18n("Beginning of subtitle reached.\nContinue from the end?")) : (m_selection ? i18n("End of selection reached.\nContinue from the beginning?") : i18n("End of subtitle reached.\nContinue from the beginning?")), i18n("Find Error")
+											  ) != KMessageBox::Continue)
+			return;
 
+		index = wrapIndex;
+	}
 
+	m_iterator->toIndex(index);
+	emit found(m_iterator->current());
+}
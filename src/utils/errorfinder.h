@@ -51,11 +51,11 @@ signals:
 	void found(SubtitleLine *line);
 
 private:
+	int findErrorLine(const RangeList &ranges, int fromIndex) const;
 	void advance(bool advanceIteratorOnFirstStep);
 
 private slots:
 	void invalidate();
-	void onIteratorSynchronized(int firstIndex, int lastIndex, bool inserted);
 
 private:
 	Subtitle *m_subtitle;
@@ -66,8 +66,6 @@ private:
 	bool m_findBackwards;
 	bool m_selection;
 	SubtitleIterator *m_iterator;
-	bool m_instancesFound;
-	int m_allSearchedIndex;
 };
 }
 #endif
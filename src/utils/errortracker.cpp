@@ -22,6 +22,7 @@
 #include "errortracker.h"
 #include "application.h"
 #include "core/subtitleline.h"
+#include "core/subtitlelinesview.h"
 
 using namespace SubtitleComposer;
 
@@ -61,19 +62,17 @@ ErrorTracker::setSubtitle(Subtitle *subtitle)
 void
 ErrorTracker::connectSlots()
 {
-	connect(m_subtitle, SIGNAL(linePrimaryTextChanged(SubtitleLine *, const SString &)), this, SLOT(onLinePrimaryTextChanged(SubtitleLine *)));
-	connect(m_subtitle, SIGNAL(lineSecondaryTextChanged(SubtitleLine *, const SString &)), this, SLOT(onLineSecondaryTextChanged(SubtitleLine *)));
-	connect(m_subtitle, SIGNAL(lineShowTimeChanged(SubtitleLine *, const Time &)), this, SLOT(onLineTimesChanged(SubtitleLine *)));
-	connect(m_subtitle, SIGNAL(lineHideTimeChanged(SubtitleLine *, const Time &)), this, SLOT(onLineTimesChanged(SubtitleLine *)));
+	connect(m_subtitle, &Subtitle::linesPrimaryTextChanged, this, &ErrorTracker::onLinesPrimaryTextChanged);
+	connect(m_subtitle, &Subtitle::linesSecondaryTextChanged, this, &ErrorTracker::onLinesSecondaryTextChanged);
+	connect(m_subtitle, &Subtitle::linesTimesChanged, this, &ErrorTracker::onLinesTimesChanged);
 }
 
 void
 ErrorTracker::disconnectSlots()
 {
-	disconnect(m_subtitle, SIGNAL(linePrimaryTextChanged(SubtitleLine *, const SString &)), this, SLOT(onLinePrimaryTextChanged(SubtitleLine *)));
-	disconnect(m_subtitle, SIGNAL(lineSecondaryTextChanged(SubtitleLine *, const SString &)), this, SLOT(onLineSecondaryTextChanged(SubtitleLine *)));
-	disconnect(m_subtitle, SIGNAL(lineShowTimeChanged(SubtitleLine *, const Time &)), this, SLOT(onLineTimesChanged(SubtitleLine *)));
-	disconnect(m_subtitle, SIGNAL(lineHideTimeChanged(SubtitleLine *, const Time &)), this, SLOT(onLineTimesChanged(SubtitleLine *)));
+	disconnect(m_subtitle, &Subtitle::linesPrimaryTextChanged, this, &ErrorTracker::onLinesPrimaryTextChanged);
+	disconnect(m_subtitle, &Subtitle::linesSecondaryTextChanged, this, &ErrorTracker::onLinesSecondaryTextChanged);
+	disconnect(m_subtitle, &Subtitle::linesTimesChanged, this, &ErrorTracker::onLinesTimesChanged);
 }
 
 void
@@ -83,25 +82,32 @@ ErrorTracker::updateLineErrors(SubtitleLine *line, int errorFlags) const
 }
 
 void
-ErrorTracker::onLinePrimaryTextChanged(SubtitleLine *line)
+ErrorTracker::onLinesPrimaryTextChanged(const RangeList &ranges)
 {
-	updateLineErrors(line, line->errorFlags() & SubtitleLine::PrimaryOnlyErrors);
+	for(SubtitleLine *line : SubtitleLinesView(*m_subtitle, ranges))
+		updateLineErrors(line, line->errorFlags() & SubtitleLine::PrimaryOnlyErrors);
 }
 
 void
-ErrorTracker::onLineSecondaryTextChanged(SubtitleLine *line)
+ErrorTracker::onLinesSecondaryTextChanged(const RangeList &ranges)
 {
-	updateLineErrors(line, line->errorFlags() & SubtitleLine::SecondaryOnlyErrors);
+	for(SubtitleLine *line : SubtitleLinesView(*m_subtitle, ranges))
+		updateLineErrors(line, line->errorFlags() & SubtitleLine::SecondaryOnlyErrors);
 }
 
 void
-ErrorTracker::onLineTimesChanged(SubtitleLine *line)
+ErrorTracker::onLinesTimesChanged(const RangeList &ranges)
 {
-	updateLineErrors(line, line->errorFlags() & SubtitleLine::TimesErrors);
-
-	SubtitleLine *prevLine = line->prevLine();
-	if(prevLine)
-		updateLineErrors(prevLine, prevLine->errorFlags() & SubtitleLine::OverlapsWithNext);
+	const SubtitleLinesView lines(*m_subtitle, ranges);
+	for(SubtitleLinesView::Iterator it = lines.begin(), end = lines.end(); it != end; ++it) {
+		SubtitleLine *line = *it;
+		updateLineErrors(line, line->errorFlags() & SubtitleLine::TimesErrors);
+
+		// the previous line might now overlap, unless it was rechecked above
+		SubtitleLine *prevLine = line->prevLine();
+		if(prevLine && !ranges.contains(it.index() - 1))
+			updateLineErrors(prevLine, prevLine->errorFlags() & SubtitleLine::OverlapsWithNext);
+	}
 }
 
 void
@@ -46,9 +46,9 @@ private:
 	void updateLineErrors(SubtitleLine *line, int errorFlags) const;
 
 private slots:
-	void onLinePrimaryTextChanged(SubtitleLine *line);
-	void onLineSecondaryTextChanged(SubtitleLine *line);
-	void onLineTimesChanged(SubtitleLine *line);
+	void onLinesPrimaryTextChanged(const RangeList &ranges);
+	void onLinesSecondaryTextChanged(const RangeList &ranges);
+	void onLinesTimesChanged(const RangeList &ranges);
 
 	void onConfigChanged();
 
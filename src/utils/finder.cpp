@@ -93,15 +93,7 @@ Finder::invalidate()
 
 	m_feedingPrimary = false;
 
-	// NOTE a line shoudn't be deleted before being removed from the subtitle
-	// so there's no risk of being left with an invalid referece as this
-	// method is called when a line is removed from the subtitle and before
-	// anyone has a chance to delete the line.
-	if(m_dataLine) {
-		disconnect(m_dataLine, SIGNAL(primaryTextChanged(const SString &)), this, SLOT(onLinePrimaryTextChanged(const SString &)));
-		disconnect(m_dataLine, SIGNAL(secondaryTextChanged(const SString &)), this, SLOT(onLineSecondaryTextChanged(const SString &)));
-		m_dataLine = 0;
-	}
+	m_dataLine = 0;
 }
 
 QWidget *
@@ -113,8 +105,18 @@ Finder::parentWidget()
 void
 Finder::setSubtitle(Subtitle *subtitle)
 {
+	if(m_subtitle) {
+		disconnect(m_subtitle, &Subtitle::linesPrimaryTextChanged, this, &Finder::onLinesPrimaryTextChanged);
+		disconnect(m_subtitle, &Subtitle::linesSecondaryTextChanged, this, &Finder::onLinesSecondaryTextChanged);
+	}
+
 	m_subtitle = subtitle;
 
+	if(m_subtitle) {
+		connect(m_subtitle, &Subtitle::linesPrimaryTextChanged, this, &Finder::onLinesPrimaryTextChanged);
+		connect(m_subtitle, &Subtitle::linesSecondaryTextChanged, this, &Finder::onLinesSecondaryTextChanged);
+	}
+
 	invalidate();
 }
 
@@ -211,11 +213,6 @@ Finder::advance()
 
 	do {
 		if(m_find->needData()) {
-			if(m_dataLine) {
-				disconnect(m_dataLine, SIGNAL(primaryTextChanged(const SString &)), this, SLOT(onLinePrimaryTextChanged(const SString &)));
-				disconnect(m_dataLine, SIGNAL(secondaryTextChanged(const SString &)), this, SLOT(onLineSecondaryTextChanged(const SString &)));
-			}
-
 			m_dataLine = m_iterator->current();
 
 			if(m_dataLine) {
@@ -229,10 +226,6 @@ Finder::advance()
 					m_feedingPrimary = !m_feedingPrimary;   // we alternate the source of data
 					m_find->setData((m_feedingPrimary ? m_dataLine->primaryText() : m_dataLine->secondaryText()).string());
 				}
-
-				connect(m_dataLine, SIGNAL(primaryTextChanged(const SString &)), this, SLOT(onLinePrimaryTextChanged(const SString &)));
-
-				connect(m_dataLine, SIGNAL(secondaryTextChanged(const SString &)), this, SLOT(onLineSecondaryTextChanged(const SString &)));
 			}
 		}
 
@@ -279,17 +272,17 @@ Finder::onHighlight(const QString &, int matchingIndex, int matchedLength)
 }
 
 void
-Finder::onLinePrimaryTextChanged(const SString &text)
+Finder::onLinesPrimaryTextChanged(const RangeList &ranges)
 {
-	if(m_feedingPrimary)
-		m_find->setData(text.string());
+	if(m_dataLine && m_feedingPrimary && ranges.contains(m_dataLine->index()))
+		m_find->setData(m_dataLine->primaryText().string());
 }
 
 void
-Finder::onLineSecondaryTextChanged(const SString &text)
+Finder::onLinesSecondaryTextChanged(const RangeList &ranges)
 {
-	if(!m_feedingPrimary)
-		m_find->setData(text.string());
+	if(m_dataLine && !m_feedingPrimary && ranges.contains(m_dataLine->index()))
+		m_find->setData(m_dataLine->secondaryText().string());
 }
 
 void
@@ -58,8 +58,8 @@ signals:
 private slots:
 	void invalidate();
 
-	void onLinePrimaryTextChanged(const SString &text);
-	void onLineSecondaryTextChanged(const SString &text);
+	void onLinesPrimaryTextChanged(const RangeList &ranges);
+	void onLinesSecondaryTextChanged(const RangeList &ranges);
 
 	void onHighlight(const QString &text, int matchingIndex, int matchedLength);
 
@@ -24,6 +24,8 @@
 #include "actions/useraction.h"
 #include "actions/useractionnames.h"
 #include "lineswidget.h"
+#include "helpers/memoryusage.h"
+#include "helpers/profiler.h"
 
 #include <QRect>
 #include <QPainter>
@@ -158,6 +160,13 @@ WaveformWidget::WaveformWidget(QWidget *parent)
 	m_hoverScrollTimer.setInterval(50);
 	m_hoverScrollTimer.setSingleShot(false);
 	connect(&m_hoverScrollTimer, &QTimer::timeout, this, &WaveformWidget::onHoverScrollTimeout);
+
+	MemoryUsage::addReporter(this, [this](MemoryUsage::Report &report){
+		if(m_waveform)
+			report[QStringLiteral("waveform samples")] += qint64(m_waveformChannels) * m_waveformChannelSize * sizeof(SAMPLE_TYPE);
+		if(m_waveformZoomed)
+			report[QStringLiteral("waveform zoom")] += qint64(m_waveformChannels) * m_waveformZoomedSize * sizeof(ZoomData);
+	});
 }
 
 void
@@ -206,6 +215,7 @@ WaveformWidget::updateActions()
 
 WaveformWidget::~WaveformWidget()
 {
+	MemoryUsage::removeReporters(this);
 	clearAudioStream();
 }
 
@@ -277,6 +287,8 @@ WaveformWidget::onScrollBarValueChanged(int value)
 void
 WaveformWidget::updateZoomData()
 {
+	PROFILE();
+
 	int height = m_vertical ? m_waveformGraphics->height() : m_waveformGraphics->width();
 	if(!height)
 		return;
@@ -480,6 +492,8 @@ WaveformWidget::onStreamFinished()
 void
 WaveformWidget::onStreamData(const void *buffer, qint32 size, const WaveFormat *waveFormat, const qint64 msecStart, const qint64 /*msecDuration*/)
 {
+	PROFILE();
+
 	// make sure WaveformWidget::onStreamProgress() signal was processed since we're in different thread
 	while(!m_waveformDuration) {
 		QThread::yieldCurrentThread();
@@ -557,6 +571,7 @@ WaveformWidget::onStreamData(const void *buffer, qint32 size, const WaveFormat *
 		i++;
 	}
 	m_waveformDataOffset += size;
+	PROFILE_COUNTER("waveform samples", m_waveformDataOffset / BYTES_PER_SAMPLE / m_waveformChannels);
 }
 
 
@@ -568,18 +583,17 @@ WaveformWidget::updateVisibleLines()
 
 	m_visibleLinesDirty = false;
 
-	m_visibleLines.clear();
+	m_visibleLines = m_subtitle->linesInTimeRange(m_timeStart, m_timeEnd);
 
-	for(int i = 0, n = m_subtitle->count(); i < n; i++) {
-		SubtitleLine *sub = m_subtitle->at(i);
-		if(sub == m_draggedLine || (sub->showTime() <= m_timeEnd && m_timeStart <= sub->hideTime()))
-			m_visibleLines.push_back(sub);
-	}
+	if(m_draggedLine && !m_visibleLines.contains(m_draggedLine))
+		m_visibleLines.push_back(m_draggedLine);
 }
 
 void
 WaveformWidget::paintGraphics(QPainter &painter)
 {
+	PROFILE();
+
 	quint32 msWindowSize = windowSize();
 	int widgetHeight = m_waveformGraphics->height();
 	int widgetWidth = m_waveformGraphics->width();
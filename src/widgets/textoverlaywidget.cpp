@@ -26,7 +26,7 @@
 #include <QAbstractTextDocumentLayout>
 #include <QResizeEvent>
 
-#include "profiler.h"
+#include "helpers/profiler.h"
 #include <QDebug>
 
 TextOverlayWidget::TextOverlayWidget(QWidget *parent) :